@@ -43,6 +43,144 @@
 #define PARSE_ERROR 2
 #define CONTEXT_ERROR 3
 
+/****************************
+ * Adds a file's name and contents
+ * to a FNV-1a hash, false if the
+ * file can't be read
+ ****************************/
+static bool HashFile(const std::wstring &file_name, unsigned long long &hash)
+{
+  std::ifstream file(UnicodeToBytes(file_name).c_str(), std::ios_base::in | std::ios_base::binary);
+  if(!file.good()) {
+    return false;
+  }
+
+  const std::string name = UnicodeToBytes(file_name);
+  for(size_t i = 0; i <= name.size(); ++i) {
+    hash = (hash ^ (i < name.size() ? (unsigned char)name[i] : 0)) * 1099511628211ULL;
+  }
+
+  char buffer[8192];
+  while(file.read(buffer, sizeof(buffer)) || file.gcount() > 0) {
+    const std::streamsize read = file.gcount();
+    for(std::streamsize i = 0; i < read; ++i) {
+      hash = (hash ^ (unsigned char)buffer[i]) * 1099511628211ULL;
+    }
+  }
+
+  return true;
+}
+
+/****************************
+ * Splits a comma separated list
+ ****************************/
+static std::vector<std::wstring> SplitNames(const std::wstring &names)
+{
+  std::vector<std::wstring> values;
+
+  size_t offset = 0;
+  size_t index = names.find(L',');
+  while(index != std::wstring::npos) {
+    const std::wstring value = names.substr(offset, index - offset);
+    if(!value.empty()) {
+      values.push_back(value);
+    }
+    offset = index + 1;
+    index = names.find(L',', offset);
+  }
+
+  const std::wstring value = names.substr(offset);
+  if(!value.empty()) {
+    values.push_back(value);
+  }
+
+  return values;
+}
+
+/****************************
+ * Hashes the contents of all source
+ * files and linked libraries, empty
+ * if one can't be read
+ ****************************/
+static std::string GetBuildHash(const std::wstring &src_files, const std::wstring &sys_lib_path)
+{
+  unsigned long long hash = 14695981039346656037ULL;
+
+  const std::vector<std::wstring> src_names = SplitNames(src_files);
+  for(size_t i = 0; i < src_names.size(); ++i) {
+    if(!HashFile(src_names[i], hash)) {
+      return "";
+    }
+  }
+
+  const std::wstring lib_path = GetLibraryPath();
+  const std::vector<std::wstring> lib_names = SplitNames(sys_lib_path);
+  for(size_t i = 0; i < lib_names.size(); ++i) {
+    std::wstring lib_file = lib_path + lib_names[i];
+    if(!frontend::EndsWith(lib_file, L".obl")) {
+      lib_file += L".obl";
+    }
+
+    if(!HashFile(lib_file, hash)) {
+      return "";
+    }
+  }
+
+  std::stringstream stream;
+  stream << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return stream.str();
+}
+
+/****************************
+ * Checks if an incremental build can reuse the
+ * existing target. The whole target is reused when
+ * it was built with the same options from sources
+ * and libraries with the same contents, otherwise
+ * every source file is recompiled. Content hashes
+ * are used since file times may not change between
+ * quick edits.
+ ****************************/
+static bool IsTargetCurrent(const std::wstring &dest_file, const std::wstring &build_key, const std::string &build_hash)
+{
+  if(build_hash.empty()) {
+    return false;
+  }
+
+  std::ifstream target(UnicodeToBytes(dest_file).c_str(), std::ios_base::in | std::ios_base::binary);
+  if(!target.good()) {
+    return false;
+  }
+  target.close();
+
+  // compare build options
+  std::ifstream manifest(UnicodeToBytes(dest_file + L".inc").c_str());
+  if(!manifest.good()) {
+    return false;
+  }
+  std::string manifest_key;
+  std::getline(manifest, manifest_key);
+  std::string manifest_hash;
+  std::getline(manifest, manifest_hash);
+  manifest.close();
+
+  return manifest_key == UnicodeToBytes(build_key) && manifest_hash == build_hash;
+}
+
+/****************************
+ * Records the build options and
+ * input hash used for an incremental
+ * build
+ ****************************/
+static void WriteBuildManifest(const std::wstring &dest_file, const std::wstring &build_key, const std::string &build_hash)
+{
+  std::ofstream manifest(UnicodeToBytes(dest_file + L".inc").c_str());
+  if(manifest.good()) {
+    manifest << UnicodeToBytes(build_key) << std::endl;
+    manifest << build_hash << std::endl;
+    manifest.close();
+  }
+}
+
 /****************************
  * Starts the compilation process
  ****************************/
@@ -297,15 +435,38 @@ int OptionsCompile(std::map<const std::wstring, std::wstring>& arguments, std::l
     argument_options.remove(L"asm");
   }
 
+  // check for incremental flag
+  bool is_incremental = false;
+  result = arguments.find(L"incremental");
+  if(result != arguments.end()) {
+    is_incremental = !src_files.empty();
+    argument_options.remove(L"incremental");
+  }
+
   if(argument_options.size() != 0) {
     std::wcerr << usage << std::endl;
     return COMMAND_ERROR;
   }
 
+  // reuse target if nothing has changed
+  const std::wstring build_key = src_files + L"|" + sys_lib_path + L"|" + target + L"|" + optimize + 
+    (alt_syntax ? L"|alt" : L"") + (is_debug ? L"|debug" : L"") + (show_asm ? L"|asm" : L"");
+  // inputs are hashed before compiling so edits made during the build aren't recorded as built
+  const std::string build_hash = is_incremental ? GetBuildHash(src_files, sys_lib_path) : "";
+  if(is_incremental && IsTargetCurrent(dest_file, build_key, build_hash)) {
+    std::wcout << L"Target file is up to date: '" << dest_file << L"'." << std::endl;
+    return SUCCESS;
+  }
+
   std::vector<std::pair<std::wstring, std::wstring> > programs;
   programs.push_back(make_pair(L"blob://program.obs", program));
 
-  return Compile(src_files, optimize, dest_file, programs, sys_lib_path, target, alt_syntax, is_debug, show_asm);
+  const int status = Compile(src_files, optimize, dest_file, programs, sys_lib_path, target, alt_syntax, is_debug, show_asm);
+  if(is_incremental && status == SUCCESS && !build_hash.empty()) {
+    WriteBuildManifest(dest_file, build_key, build_hash);
+  }
+
+  return status;
 }
 
 #ifdef _WIN32
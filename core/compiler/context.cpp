@@ -1401,7 +1401,10 @@ void ContextAnalyzer::AnalyzeStatement(Statement* statement, const int depth)
   if(statement) {
    switch(statement->GetStatementType()) {
     case EMPTY_STMT:
+      break;
+
     case SYSTEM_STMT:
+      AnalyzeSystemStatement(static_cast<SystemStatement*>(statement), depth);
       break;
 
     case DECLARATION_STMT: {
@@ -1983,8 +1986,8 @@ void ContextAnalyzer::AnalyzeVariable(Variable* variable, SymbolEntry* entry, co
       }
       else {
         const std::wstring var_scope_name = current_method->GetName() + L':' + variable->GetName();
+        // copies live in the closure's memory, not the class's, and are numbered when the lambda is emitted
         SymbolEntry* copy_entry = TreeFactory::Instance()->MakeSymbolEntry(var_scope_name, capture_entry->GetType(), false, false);
-        symbol_table->GetSymbolTable(current_class->GetName())->AddEntry(copy_entry, true);
 
         variable->SetTypes(copy_entry->GetType());
         variable->SetEntry(copy_entry);
@@ -4294,6 +4297,29 @@ void ContextAnalyzer::AnalyzeCritical(CriticalSection* mutex, const int depth)
   }
 }
 
+/****************************
+ * Analyzes a system statement
+ ****************************/
+void ContextAnalyzer::AnalyzeSystemStatement(SystemStatement* statement, const int depth)
+{
+  // field atomics operate on a word sized instance variable
+  Variable* variable = statement->GetVariable();
+  if(variable) {
+    AnalyzeVariable(variable, depth + 1);
+    SymbolEntry* entry = variable->GetEntry();
+    if(entry) {
+      if(entry->IsLocal() || entry->IsStatic()) {
+        ProcessError(statement, L"Expected an instance variable");
+      }
+
+      Type* type = entry->GetType();
+      if(!type || variable->GetIndices() || (type->GetDimension() == 0 && type->GetType() != INT_TYPE && type->GetType() != CLASS_TYPE)) {
+        ProcessError(statement, L"Expected an Int or reference instance variable");
+      }
+    }
+  }
+}
+
 /****************************
  * Analyzes a 'for' statement
  ****************************/
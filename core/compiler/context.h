@@ -531,6 +531,7 @@ class ContextAnalyzer {
   void AnalyzeWhile(While* while_stmt, const int depth);
   void AnalyzeSelect(Select* select_stmt, const int depth);
   void AnalyzeCritical(CriticalSection* mutex, const int depth);
+  void AnalyzeSystemStatement(SystemStatement* statement, const int depth);
   void AnalyzeFor(For* for_stmt, const int depth);
   void AnalyzeReturn(Return* rtrn, const int depth);
   void AnalyzeLeaving(Leaving* leaving_stmt, const int depth);
@@ -445,6 +445,12 @@ void IntermediateInstruction::Write(bool is_debug, OutputStream& out_stream) {
     WriteDouble(operand4, out_stream);
     break;
 
+  case INC_LOCL_INT_VAR:
+  case LOAD_LOCL_INT_VARS:
+    WriteInt(operand, out_stream);
+    WriteInt(operand2, out_stream);
+    break;
+
   case LBL:
     WriteInt(operand, out_stream);
     break;
@@ -597,6 +603,18 @@ void IntermediateInstruction::Debug(size_t i) {
       << (operand2 == LOCL ? "true" : "false") << std::endl;
     break;
 
+  case INC_LOCL_INT_VAR:
+    GetLogger()  << i << L":\tINC_LOCL_INT_VAR: id=" << operand << L"; value=" << operand2 << std::endl;
+    break;
+
+  case LOAD_LOCL_INT_VARS:
+    GetLogger()  << i << L":\tLOAD_LOCL_INT_VARS: id=" << operand << L"; id2=" << operand2 << std::endl;
+    break;
+
+  case CHK_OBJ_INST:
+    GetLogger()  << i << L":\tCHK_OBJ_INST" << std::endl;
+    break;
+
   case COPY_FLOAT_VAR:
     GetLogger()  << i << L":\tCOPY_FLOAT_VAR: id=" << operand << L"; local="
       << (operand2 == LOCL ? "true" : "false") << std::endl;
@@ -225,6 +225,10 @@ namespace backend {
     void SetOperand(long o1) {
       operand = o1;
     }
+
+    void SetOperand2(long o2) {
+      operand2 = o2;
+    }
     
     void SetOperand3(long o3) {
       operand3 = o3;
@@ -584,6 +588,10 @@ namespace backend {
       return is_virtual;
     }
 
+    bool IsNative() {
+      return is_native;
+    }
+
     bool IsLibrary() {
       return is_lib;
     }
@@ -746,6 +754,26 @@ namespace backend {
       return name;
     }
 
+    int GetParentId() {
+      return pid;
+    }
+
+    const std::wstring &GetParentName() {
+      return parent_name;
+    }
+
+    std::vector<int> GetInterfaceIds() {
+      return interface_ids;
+    }
+
+    bool IsInterface() {
+      return is_interface;
+    }
+
+    bool IsVirtual() {
+      return is_virtual;
+    }
+
     bool IsLibrary() {
       return is_lib;
     }
@@ -754,6 +782,10 @@ namespace backend {
       return inst_space;
     }
 
+    IntermediateDeclarations* GetInstanceEntries() {
+      return inst_entries;
+    }
+
     void SetInstanceSpace(int s) {
       inst_space = s;
     }
@@ -915,6 +947,8 @@ namespace backend {
     std::vector<frontend::IntStringHolder*> int_strings;
     std::vector<frontend::FloatStringHolder*> float_strings;
     std::vector<std::wstring> bundle_names;
+    std::vector<std::wstring> devirtualized_calls;
+    std::vector<std::wstring> scalar_replacements;
     std::wstring aliases_str;
     int num_src_classes;
     int num_lib_classes;
@@ -1055,10 +1089,36 @@ namespace backend {
       return aliases_str;
     }
 
+    void AddDevirtualizedCall(const std::wstring &c) {
+      devirtualized_calls.push_back(c);
+    }
+
+    void AddScalarReplacement(const std::wstring &r) {
+      scalar_replacements.push_back(r);
+    }
+
     void Write(bool emit_lib, bool is_debug, OutputStream& out_stream, bool mute);
 
     void Debug() {
       GetLogger() << L"Program: enums=" << enums.size() << L", classes=" << classes.size() << L"; start_ids=" << class_id << L"," << method_id << std::endl;
+      // devirtualized calls
+      if(!devirtualized_calls.empty()) {
+        GetLogger() << L"=========================================================" << std::endl;
+        GetLogger() << L"Devirtualized calls: " << devirtualized_calls.size() << std::endl;
+        GetLogger() << L"=========================================================" << std::endl;
+        for(size_t i = 0; i < devirtualized_calls.size(); ++i) {
+          GetLogger() << L"  " << devirtualized_calls[i] << std::endl;
+        }
+      }
+      // scalar replaced allocations
+      if(!scalar_replacements.empty()) {
+        GetLogger() << L"=========================================================" << std::endl;
+        GetLogger() << L"Scalar replaced allocations: " << scalar_replacements.size() << std::endl;
+        GetLogger() << L"=========================================================" << std::endl;
+        for(size_t i = 0; i < scalar_replacements.size(); ++i) {
+          GetLogger() << L"  " << scalar_replacements[i] << std::endl;
+        }
+      }
       // enums
       for(size_t i = 0; i < enums.size(); ++i) {
         enums[i]->Debug();
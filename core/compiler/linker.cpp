@@ -101,6 +101,11 @@ void Linker::ResolveExternalMethodCalls()
     // all classes
     std::vector<LibraryClass*> classes = lib_iter->second->GetClasses();
     for(size_t i = 0; i < classes.size(); ++i) {
+      // only called classes are linked
+      if(!classes[i]->GetCalled()) {
+        continue;
+      }
+      
       // all methods
       std::map<const std::wstring, LibraryMethod*> methods = classes[i]->GetMethods();
       std::map<const std::wstring, LibraryMethod*>::iterator mthd_iter;
@@ -207,7 +212,7 @@ void Linker::ResolveExternalMethodCalls()
   }
 }
 
-std::unordered_map<std::wstring, LibraryAlias*> Linker::GetAllAliasesMap()
+std::unordered_map<std::wstring, LibraryAlias*> &Linker::GetAllAliasesMap()
 {
   if(all_aliases_map.empty()) {
     std::vector<LibraryAlias*> aliases = GetAllAliases();
@@ -244,7 +249,7 @@ std::vector<Library*> Linker::GetAllUsedLibraries()
   return used_libraries;
 }
 
-std::vector<LibraryAlias*> Linker::GetAllAliases()
+std::vector<LibraryAlias*> &Linker::GetAllAliases()
 {
   if(all_aliases.empty()) {
     std::map<const std::wstring, Library*>::iterator iter;
@@ -259,7 +264,7 @@ std::vector<LibraryAlias*> Linker::GetAllAliases()
   return all_aliases;
 }
 
-std::unordered_map<std::wstring, LibraryClass*> Linker::GetAllClassesMap()
+std::unordered_map<std::wstring, LibraryClass*> &Linker::GetAllClassesMap()
 {
   if(all_classes_map.empty()) {
     std::vector<LibraryClass*> klasses = GetAllClasses();
@@ -272,7 +277,7 @@ std::unordered_map<std::wstring, LibraryClass*> Linker::GetAllClassesMap()
   return all_classes_map;
 }
 
-std::vector<LibraryClass*> Linker::GetAllClasses()
+std::vector<LibraryClass*> &Linker::GetAllClasses()
 {
   if(all_classes.empty()) {
     std::map<const std::wstring, Library*>::iterator iter;
@@ -287,7 +292,7 @@ std::vector<LibraryClass*> Linker::GetAllClasses()
   return all_classes;
 }
 
-std::unordered_map<std::wstring, LibraryEnum*> Linker::GetAllEnumsMap()
+std::unordered_map<std::wstring, LibraryEnum*> &Linker::GetAllEnumsMap()
 {
   if(all_enums_map.empty()) {
     std::vector<LibraryEnum*> enums = GetAllEnums();
@@ -300,7 +305,7 @@ std::unordered_map<std::wstring, LibraryEnum*> Linker::GetAllEnumsMap()
   return all_enums_map;
 }
 
-std::vector<LibraryEnum*> Linker::GetAllEnums()
+std::vector<LibraryEnum*> &Linker::GetAllEnums()
 {
   if(all_enums.empty()) {
     std::map<const std::wstring, Library*>::iterator iter;
@@ -315,36 +320,36 @@ std::vector<LibraryEnum*> Linker::GetAllEnums()
   return all_enums;
 }
 
-LibraryAlias* Linker::SearchAliasLibraries(const std::wstring& name, std::vector<std::wstring> uses)
+LibraryAlias* Linker::SearchAliasLibraries(const std::wstring& name, const std::vector<std::wstring> &uses)
 {
-  std::unordered_map<std::wstring, LibraryAlias*> alias_map = GetAllAliasesMap();
-  LibraryAlias* alias = alias_map[name];
-  if(alias) {
-    return alias;
+  const std::unordered_map<std::wstring, LibraryAlias*> &alias_map = GetAllAliasesMap();
+  std::unordered_map<std::wstring, LibraryAlias*>::const_iterator result = alias_map.find(name);
+  if(result != alias_map.end()) {
+    return result->second;
   }
 
   for(size_t i = 0; i < uses.size(); ++i) {
-    alias = alias_map[uses[i] + L"." + name];
-    if(alias) {
-      return alias;
+    result = alias_map.find(uses[i] + L"." + name);
+    if(result != alias_map.end()) {
+      return result->second;
     }
   }
 
   return nullptr;
 }
 
-LibraryClass* Linker::SearchClassLibraries(const std::wstring& name, std::vector<std::wstring> uses)
+LibraryClass* Linker::SearchClassLibraries(const std::wstring& name, const std::vector<std::wstring> &uses)
 {
-  std::unordered_map<std::wstring, LibraryClass*> klass_map = GetAllClassesMap();
-  LibraryClass* klass = klass_map[name];
-  if(klass) {
-    return klass;
+  const std::unordered_map<std::wstring, LibraryClass*> &klass_map = GetAllClassesMap();
+  std::unordered_map<std::wstring, LibraryClass*>::const_iterator result = klass_map.find(name);
+  if(result != klass_map.end()) {
+    return result->second;
   }
 
   for(size_t i = 0; i < uses.size(); ++i) {
-    klass = klass_map[uses[i] + L"." + name];
-    if(klass) {
-      return klass;
+    result = klass_map.find(uses[i] + L"." + name);
+    if(result != klass_map.end()) {
+      return result->second;
     }
   }
 
@@ -363,18 +368,18 @@ bool Linker::HasBundleName(const std::wstring& name)
   return false;
 }
 
-LibraryEnum* Linker::SearchEnumLibraries(const std::wstring& name, std::vector<std::wstring> uses)
+LibraryEnum* Linker::SearchEnumLibraries(const std::wstring& name, const std::vector<std::wstring> &uses)
 {
-  std::unordered_map<std::wstring, LibraryEnum*> enum_map = GetAllEnumsMap();
-  LibraryEnum* eenum = enum_map[name];
-  if(eenum) {
-    return eenum;
+  const std::unordered_map<std::wstring, LibraryEnum*> &enum_map = GetAllEnumsMap();
+  std::unordered_map<std::wstring, LibraryEnum*>::const_iterator result = enum_map.find(name);
+  if(result != enum_map.end()) {
+    return result->second;
   }
 
   for(size_t i = 0; i < uses.size(); ++i) {
-    eenum = enum_map[uses[i] + L"." + name];
-    if(eenum) {
-      return eenum;
+    result = enum_map.find(uses[i] + L"." + name);
+    if(result != enum_map.end()) {
+      return result->second;
     }
   }
 
@@ -917,14 +922,214 @@ void Library::LoadMethods(LibraryClass* cls, bool is_debug)
 
     LibraryMethod* mthd = new LibraryMethod(id, name, rtrn_name, type, is_virtual, has_and_or,
                                             is_native, is_static, is_lambda, params, mem_size, cls, entries);
-    // load statements
-    LoadStatements(mthd, is_debug);
+    // statements are loaded on demand, only called classes are linked
+    mthd->SetStatementsBuffer(buffer);
+    SkipStatements(is_debug);
 
     // add method
     cls->AddMethod(mthd);
   }
 }
 
+/****************************
+ * Loads a method's statements on demand
+ ****************************/
+void Library::LoadMethodStatements(LibraryMethod* method, char* stmts_buffer)
+{
+  char* cur_buffer = buffer;
+  buffer = stmts_buffer;
+  LoadStatements(method, method->GetLibraryClass()->IsDebug());
+  buffer = cur_buffer;
+}
+
+/****************************
+ * Skips over statements without 
+ * creating instructions
+ ****************************/
+void Library::SkipStatements(bool is_debug)
+{
+  const unsigned long num_instrs = ReadUnsigned();
+  for(unsigned long i = 0; i < num_instrs; ++i) {
+    if(is_debug) {
+      ReadDummyInt();
+    }
+
+    const int type = ReadByte();
+    switch(type) {
+    case LOAD_INT_LIT:
+      ReadInt64();
+      break;
+
+    case LOAD_FLOAT_LIT:
+      ReadDouble();
+      break;
+
+    case LOAD_CHAR_LIT:
+      ReadDummyString();
+      break;
+
+    case NEW_INT_ARY:
+    case NEW_FLOAT_ARY:
+    case NEW_BYTE_ARY:
+    case NEW_CHAR_ARY:
+    case NEW_OBJ_INST:
+    case NEW_FUNC_INST:
+    case LBL:
+    case OBJ_INST_CAST:
+    case OBJ_TYPE_OF:
+    case TRAP:
+    case TRAP_RTRN:
+      ReadDummyInt();
+      break;
+
+    case LOAD_INT_VAR:
+    case LOAD_FUNC_VAR:
+    case LOAD_FLOAT_VAR:
+    case STOR_INT_VAR:
+    case STOR_FUNC_VAR:
+    case STOR_FLOAT_VAR:
+    case COPY_INT_VAR:
+    case COPY_FLOAT_VAR:
+    case JMP:
+    case DYN_MTHD_CALL:
+    case LOAD_BYTE_ARY_ELM:
+    case LOAD_CHAR_ARY_ELM:
+    case LOAD_INT_ARY_ELM:
+    case LOAD_FLOAT_ARY_ELM:
+    case STOR_BYTE_ARY_ELM:
+    case STOR_CHAR_ARY_ELM:
+    case STOR_INT_ARY_ELM:
+    case STOR_FLOAT_ARY_ELM:
+      ReadDummyInt();
+      ReadDummyInt();
+      break;
+
+    case MTHD_CALL:
+    case ASYNC_MTHD_CALL:
+      ReadDummyInt();
+      ReadDummyInt();
+      ReadDummyInt();
+      break;
+
+    case LIB_OBJ_INST_CAST:
+    case LIB_NEW_OBJ_INST:
+    case LIB_OBJ_TYPE_OF:
+      ReadDummyString();
+      break;
+
+    case LIB_MTHD_CALL:
+      ReadDummyInt();
+      ReadDummyString();
+      ReadDummyString();
+      break;
+
+    case LIB_FUNC_DEF:
+      ReadDummyString();
+      ReadDummyString();
+      break;
+
+    // no operands
+    case SHL_INT:
+    case SHR_INT:
+    case RTRN:
+    case SWAP_INT:
+    case POP_INT:
+    case POP_FLOAT:
+    case AND_INT:
+    case OR_INT:
+    case ADD_INT:
+    case FLOR_FLOAT:
+    case CPY_BYTE_ARY:
+    case LOAD_ARY_SIZE:
+    case CPY_CHAR_ARY:
+    case CPY_INT_ARY:
+    case CPY_FLOAT_ARY:
+    case ZERO_BYTE_ARY:
+    case ZERO_CHAR_ARY:
+    case ZERO_INT_ARY:
+    case ZERO_FLOAT_ARY:
+    case CEIL_FLOAT:
+    case TRUNC_FLOAT:
+    case SIN_FLOAT:
+    case COS_FLOAT:
+    case TAN_FLOAT:
+    case ASIN_FLOAT:
+    case ACOS_FLOAT:
+    case ATAN_FLOAT:
+    case LOG2_FLOAT:
+    case CBRT_FLOAT:
+    case ATAN2_FLOAT:
+    case ACOSH_FLOAT:
+    case ASINH_FLOAT:
+    case ATANH_FLOAT:
+    case COSH_FLOAT:
+    case SINH_FLOAT:
+    case TANH_FLOAT:
+    case MOD_FLOAT:
+    case ROUND_FLOAT:
+    case EXP_FLOAT:
+    case LOG_FLOAT:
+    case LOG10_FLOAT:
+    case POW_FLOAT:
+    case SQRT_FLOAT:
+    case GAMMA_FLOAT:
+    case NAN_INT:
+    case INF_INT:
+    case NEG_INF_INT:
+    case NAN_FLOAT:
+    case INF_FLOAT:
+    case NEG_INF_FLOAT:
+    case RAND_FLOAT:
+    case F2I:
+    case I2F:
+    case S2I:
+    case S2F:
+    case I2S:
+    case F2S:
+    case LOAD_CLS_MEM:
+    case LOAD_INST_MEM:
+    case SUB_INT:
+    case MUL_INT:
+    case DIV_INT:
+    case MOD_INT:
+    case BIT_AND_INT:
+    case BIT_OR_INT:
+    case BIT_NOT_INT:
+    case BIT_XOR_INT:
+    case EQL_INT:
+    case NEQL_INT:
+    case LES_INT:
+    case GTR_INT:
+    case LES_EQL_INT:
+    case GTR_EQL_INT:
+    case ADD_FLOAT:
+    case SUB_FLOAT:
+    case MUL_FLOAT:
+    case DIV_FLOAT:
+    case EQL_FLOAT:
+    case NEQL_FLOAT:
+    case LES_EQL_FLOAT:
+    case GTR_EQL_FLOAT:
+    case LES_FLOAT:
+    case GTR_FLOAT:
+    case EXT_LIB_LOAD:
+    case EXT_LIB_UNLOAD:
+    case EXT_LIB_FUNC_CALL:
+    case THREAD_JOIN:
+    case THREAD_SLEEP:
+    case THREAD_MUTEX:
+    case CRITICAL_START:
+    case CRITICAL_END:
+      break;
+
+    // operands would be read out of step, stop rather than misread the rest of the library
+    default:
+      std::wcerr << L"Error: Unable to skip unknown library instruction: " << type << std::endl;
+      exit(1);
+    }
+  }
+}
+
 /****************************
  * Reads statements
  ****************************/
@@ -1615,6 +1820,17 @@ void Library::LoadStatements(LibraryMethod* method, bool is_debug)
 /******************************
  * LibraryMethod class
  ****************************/
+std::vector<LibraryInstr*> &LibraryMethod::GetInstructions()
+{
+  if(stmts_buffer) {
+    char* tmp = stmts_buffer;
+    stmts_buffer = nullptr;
+    lib_cls->GetLibrary()->LoadMethodStatements(this, tmp);
+  }
+
+  return instrs;
+}
+
 void LibraryMethod::ParseDeclarations()
 {
   const std::wstring method_name = name;
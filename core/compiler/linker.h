@@ -195,6 +195,7 @@ class LibraryMethod {
   std::wstring rtrn_name;
   frontend::Type* rtrn_type;
   std::vector<LibraryInstr*> instrs;
+  char* stmts_buffer;
   LibraryClass* lib_cls;
   frontend::MethodType type;
   bool is_native;
@@ -243,6 +244,7 @@ class LibraryMethod {
     lib_cls = c;
     entries = e;
     rtrn_type = nullptr;
+    stmts_buffer = nullptr;
 
     ParseDeclarations();
     ParseReturn();
@@ -332,13 +334,16 @@ class LibraryMethod {
     instrs = is;
   }
 
+  // marks the start of the method's statements, which are read on demand
+  void SetStatementsBuffer(char* b) {
+    stmts_buffer = b;
+  }
+
   frontend::Type* GetReturn() {
     return rtrn_type;
   }
 
-  std::vector<LibraryInstr*> GetInstructions() {
-    return instrs;
-  }
+  std::vector<LibraryInstr*> &GetInstructions();
 };
 
 /****************************
@@ -518,6 +523,10 @@ class LibraryClass {
     return was_called;
   }
 
+  Library* GetLibrary() {
+    return library;
+  }
+
   bool IsDebug() {
     return is_debug;
   }
@@ -857,6 +866,7 @@ class Library {
   void LoadClasses();
   void LoadMethods(LibraryClass* cls, bool is_debug);
   void LoadStatements(LibraryMethod* mthd, bool is_debug);
+  void SkipStatements(bool is_debug);
 
  public:
   Library(const std::wstring &p) {
@@ -996,6 +1006,7 @@ class Library {
   }
 
   void Load();
+  void LoadMethodStatements(LibraryMethod* mthd, char* stmts_buffer);
 };
 
 /********************************
@@ -1073,39 +1084,40 @@ class Linker {
   std::vector<Library*> GetAllUsedLibraries();
 
   // returns all aliases including duplicates
-  std::unordered_map<std::wstring, LibraryAlias*> GetAllAliasesMap();
+  std::unordered_map<std::wstring, LibraryAlias*> &GetAllAliasesMap();
 
   // returns all aliases including duplicates
-  std::vector<LibraryAlias*> GetAllAliases();
+  std::vector<LibraryAlias*> &GetAllAliases();
 
   // returns all classes including duplicates
-  std::unordered_map<std::wstring, LibraryClass*> GetAllClassesMap();
+  std::unordered_map<std::wstring, LibraryClass*> &GetAllClassesMap();
 
   // returns all classes including duplicates
-  std::vector<LibraryClass*> GetAllClasses();
+  std::vector<LibraryClass*> &GetAllClasses();
 
   // returns all enums including duplicates
-  std::unordered_map<std::wstring, LibraryEnum*> GetAllEnumsMap();
+  std::unordered_map<std::wstring, LibraryEnum*> &GetAllEnumsMap();
 
   // returns all enums including duplicates
-  std::vector<LibraryEnum*> GetAllEnums();
+  std::vector<LibraryEnum*> &GetAllEnums();
 
   LibraryClass* SearchClassLibraries(const std::wstring &name) {
-    std::unordered_map<std::wstring, LibraryClass*> klass_map = GetAllClassesMap();
-    return klass_map[name];
+    const std::unordered_map<std::wstring, LibraryClass*> &klass_map = GetAllClassesMap();
+    std::unordered_map<std::wstring, LibraryClass*>::const_iterator result = klass_map.find(name);
+    return result != klass_map.end() ? result->second : nullptr;
   }
 
   // check to see if bundle name exists
   bool HasBundleName(const std::wstring &name);
 
   // finds the first alias match; note multiple matches may exist
-  LibraryAlias* SearchAliasLibraries(const std::wstring& name, std::vector<std::wstring> uses);
+  LibraryAlias* SearchAliasLibraries(const std::wstring& name, const std::vector<std::wstring> &uses);
 
   // finds the first class match; note multiple matches may exist
-  LibraryClass* SearchClassLibraries(const std::wstring& name, std::vector<std::wstring> uses);
+  LibraryClass* SearchClassLibraries(const std::wstring& name, const std::vector<std::wstring> &uses);
 
   // finds the first enum match; note multiple matches may exist
-  LibraryEnum* SearchEnumLibraries(const std::wstring& name, std::vector<std::wstring> uses);
+  LibraryEnum* SearchEnumLibraries(const std::wstring& name, const std::vector<std::wstring> &uses);
 
   void Load();
 };
@@ -140,6 +140,25 @@ void ItermediateOptimizer::Optimize()
 
   // classes...
   std::vector<IntermediateClass*> klasses = program->GetClasses();
+
+  // devirtualize calls before inlining
+  if(!is_lib && optimization_level > 1) {
+    BuildClassHierarchy();
+    for(size_t i = 0; i < klasses.size(); ++i) {
+      std::vector<IntermediateMethod*> methods = klasses[i]->GetMethods();
+      for(size_t j = 0; j < methods.size(); ++j) {
+        current_method = methods[j];
+#ifdef _DEBUG
+        GetLogger() << L"Devirtualizing method: name='" << current_method->GetName() << "'" << std::endl;
+#endif
+        std::vector<IntermediateBlock*> blocks = current_method->GetBlocks();
+        for(size_t k = 0; k < blocks.size(); ++k) {
+          Devirtualize(blocks[k]);
+        }
+      }
+    }
+  }
+
   for(size_t i = 0; i < klasses.size(); ++i) {
     // methods...
     std::vector<IntermediateMethod*> methods = klasses[i]->GetMethods();
@@ -178,6 +197,154 @@ void ItermediateOptimizer::Optimize()
   }
 }
 
+/****************************
+ * Builds a class hierarchy for
+ * all linked classes
+ ****************************/
+void ItermediateOptimizer::BuildClassHierarchy()
+{
+  std::vector<IntermediateClass*> klasses = program->GetClasses();
+  for(size_t i = 0; i < klasses.size(); ++i) {
+    IntermediateClass* klass = klasses[i];
+    cha_classes[klass->GetId()] = klass;
+
+    // direct subtypes
+    const int pid = klass->GetParentId();
+    if(pid > -1) {
+      cha_subtypes[pid].push_back(klass);
+    }
+
+    const std::vector<int> interface_ids = klass->GetInterfaceIds();
+    for(size_t j = 0; j < interface_ids.size(); ++j) {
+      cha_subtypes[interface_ids[j]].push_back(klass);
+    }
+
+    // methods by name
+    std::vector<IntermediateMethod*> methods = klass->GetMethods();
+    for(size_t j = 0; j < methods.size(); ++j) {
+      cha_methods[methods[j]->GetName()] = methods[j];
+    }
+  }
+}
+
+/****************************
+ * Collects all concrete classes
+ * that extend or implement a type
+ ****************************/
+void ItermediateOptimizer::GetConcreteSubtypes(IntermediateClass* klass, std::set<IntermediateClass*> &visited, std::vector<IntermediateClass*> &concretes)
+{
+  if(visited.find(klass) != visited.end()) {
+    return;
+  }
+  visited.insert(klass);
+
+  if(!klass->IsInterface() && !klass->IsVirtual()) {
+    concretes.push_back(klass);
+  }
+
+  std::map<int, std::vector<IntermediateClass*> >::iterator result = cha_subtypes.find(klass->GetId());
+  if(result != cha_subtypes.end()) {
+    std::vector<IntermediateClass*> subtypes = result->second;
+    for(size_t i = 0; i < subtypes.size(); ++i) {
+      GetConcreteSubtypes(subtypes[i], visited, concretes);
+    }
+  }
+}
+
+/****************************
+ * Resolves a virtual method to its
+ * implementation, if only one exists
+ ****************************/
+IntermediateMethod* ItermediateOptimizer::ResolveVirtualCall(IntermediateMethod* virtual_mthd)
+{
+  std::map<IntermediateMethod*, IntermediateMethod*>::iterator cached = cha_targets.find(virtual_mthd);
+  if(cached != cha_targets.end()) {
+    return cached->second;
+  }
+
+  IntermediateMethod* target = nullptr;
+
+  const std::wstring virtual_name = virtual_mthd->GetName();
+  const size_t offset = virtual_name.find(L':');
+  if(offset != std::wstring::npos) {
+    const std::wstring method_ending = virtual_name.substr(offset);
+
+    std::set<IntermediateClass*> visited;
+    std::vector<IntermediateClass*> concretes;
+    GetConcreteSubtypes(virtual_mthd->GetClass(), visited, concretes);
+
+    // same lookup as the runtime binding, every concrete class must agree
+    bool is_valid = !concretes.empty();
+    for(size_t i = 0; is_valid && i < concretes.size(); ++i) {
+      IntermediateMethod* concrete_mthd = nullptr;
+      IntermediateClass* klass = concretes[i];
+      while(klass && !concrete_mthd) {
+        std::map<std::wstring, IntermediateMethod*>::iterator found = cha_methods.find(klass->GetName() + method_ending);
+        if(found != cha_methods.end()) {
+          concrete_mthd = found->second;
+        }
+        else {
+          std::map<int, IntermediateClass*>::iterator parent = cha_classes.find(klass->GetParentId());
+          klass = parent != cha_classes.end() ? parent->second : nullptr;
+        }
+      }
+
+      if(!concrete_mthd || concrete_mthd->IsVirtual() || (target && target != concrete_mthd)) {
+        is_valid = false;
+      }
+      else {
+        target = concrete_mthd;
+      }
+    }
+
+    if(!is_valid) {
+      target = nullptr;
+    }
+  }
+
+  cha_targets[virtual_mthd] = target;
+  return target;
+}
+
+/****************************
+ * Rewrites virtual calls with a
+ * single implementation into
+ * direct calls, guarded by a
+ * Nil receiver check
+ ****************************/
+void ItermediateOptimizer::Devirtualize(IntermediateBlock* inputs)
+{
+  bool is_changed = false;
+  std::vector<IntermediateInstruction*> outputs;
+  std::vector<IntermediateInstruction*> input_instrs = inputs->GetInstructions();
+  for(size_t i = 0; i < input_instrs.size(); ++i) {
+    IntermediateInstruction* instr = input_instrs[i];
+    if(instr->GetType() == MTHD_CALL) {
+      IntermediateMethod* mthd_called = program->GetClass(instr->GetOperand())->GetMethod(instr->GetOperand2());
+      if(mthd_called->IsVirtual()) {
+        IntermediateMethod* target_mthd = ResolveVirtualCall(mthd_called);
+        if(target_mthd) {
+#ifdef _DEBUG
+          GetLogger() << L"  Devirtualized: '" << mthd_called->GetName() << L"' to '" << target_mthd->GetName() << L"'" << std::endl;
+#endif
+          // a Nil receiver must still fail, the direct call and the inlined body wouldn't
+          outputs.push_back(IntermediateFactory::Instance()->MakeInstruction(instr->GetStatement(), cur_line_num, CHK_OBJ_INST));
+          instr->SetOperand(target_mthd->GetClass()->GetId());
+          instr->SetOperand2(target_mthd->GetId());
+          instr->SetOperand3(target_mthd->IsNative());
+          program->AddDevirtualizedCall(current_method->GetName() + L": '" + mthd_called->GetName() + L"' -> '" + target_mthd->GetName() + L"'");
+          is_changed = true;
+        }
+      }
+    }
+    outputs.push_back(instr);
+  }
+
+  if(is_changed) {
+    inputs->AddInstructions(outputs);
+  }
+}
+
 std::vector<IntermediateBlock*> ItermediateOptimizer::InlineMethod(std::vector<IntermediateBlock*> inputs)
 {
   if(optimization_level > 2) {
@@ -329,6 +496,12 @@ std::vector<IntermediateBlock*> ItermediateOptimizer::OptimizeMethod(std::vector
 
   std::vector<IntermediateBlock*> strength_reduced_blocks;
   if(optimization_level > 1) {
+    // scalar replacement
+#ifdef _DEBUG
+    GetLogger() << L"  Scalar replacement..." << std::endl;
+#endif
+    folded_float_blocks = ScalarReplacement(folded_float_blocks);
+
     // reduce strength
 #ifdef _DEBUG
     GetLogger() << L"  Strength reduction..." << std::endl;
@@ -348,18 +521,32 @@ std::vector<IntermediateBlock*> ItermediateOptimizer::OptimizeMethod(std::vector
 
   std::vector<IntermediateBlock*> instruction_replaced_blocks;
   if(optimization_level > 2) {
-    // instruction replacement
+    // loop optimization
 #ifdef _DEBUG
-    GetLogger() << L"  Instruction replacement..." << std::endl;
+    GetLogger() << L"  Loop optimization..." << std::endl;
 #endif
+    std::vector<IntermediateBlock*> loop_blocks;
     while(!strength_reduced_blocks.empty()) {
       IntermediateBlock* tmp = strength_reduced_blocks.front();
-      instruction_replaced_blocks.push_back(InstructionReplacement(tmp));
+      loop_blocks.push_back(LoopOptimization(tmp));
       // delete old block
       strength_reduced_blocks.erase(strength_reduced_blocks.begin());
       delete tmp;
       tmp = nullptr;
     }
+
+    // instruction replacement
+#ifdef _DEBUG
+    GetLogger() << L"  Instruction replacement..." << std::endl;
+#endif
+    while(!loop_blocks.empty()) {
+      IntermediateBlock* tmp = loop_blocks.front();
+      instruction_replaced_blocks.push_back(InstructionReplacement(tmp));
+      // delete old block
+      loop_blocks.erase(loop_blocks.begin());
+      delete tmp;
+      tmp = nullptr;
+    }
   } 
   else {
     return strength_reduced_blocks;
@@ -530,7 +717,8 @@ IntermediateBlock* ItermediateOptimizer::InstructionReplacement(IntermediateBloc
   size_t i = 0;
   std::vector<IntermediateInstruction*> input_instrs = inputs->GetInstructions();
   while(i < input_instrs.size() && (input_instrs[i]->GetType() == STOR_INT_VAR ||
-                                    input_instrs[i]->GetType() == STOR_FLOAT_VAR)) {
+                                    input_instrs[i]->GetType() == STOR_FLOAT_VAR ||
+                                    input_instrs[i]->GetType() == STOR_FUNC_VAR)) {
     outputs->AddInstruction(input_instrs[i++]);
   }
 
@@ -574,6 +762,59 @@ IntermediateBlock* ItermediateOptimizer::InstructionReplacement(IntermediateBloc
     working_stack.pop_back();
   }
 
+  // fuse superinstructions
+  IntermediateBlock* fused = FuseInstructions(outputs);
+  delete outputs;
+  outputs = nullptr;
+
+  return fused;
+}
+
+/********************************
+ * Replaces frequently executed instruction 
+ * sequences with single superinstructions. The
+ * sequences are the most frequent opcode n-grams
+ * printed by a VM built with '_PROFILE', see
+ * 'vm/make/Makefile.amd64.prof'.
+ ********************************/
+IntermediateBlock* ItermediateOptimizer::FuseInstructions(IntermediateBlock* inputs)
+{
+  IntermediateBlock* outputs = new IntermediateBlock;
+
+  std::vector<IntermediateInstruction*> input_instrs = inputs->GetInstructions();
+  for(size_t i = 0; i < input_instrs.size(); ++i) {
+    IntermediateInstruction* instr = input_instrs[i];
+
+    // 'LOAD_INT_LIT c; LOAD_INT_VAR v; ADD_INT|SUB_INT; STOR_INT_VAR v' -> 'INC_LOCL_INT_VAR v, c'
+    if(i + 3 < input_instrs.size() && instr->GetType() == LOAD_INT_LIT &&
+       instr->GetOperand7() > -INT32_MAX && instr->GetOperand7() <= INT32_MAX) {
+      IntermediateInstruction* load_instr = input_instrs[i + 1];
+      IntermediateInstruction* calc_instr = input_instrs[i + 2];
+      IntermediateInstruction* stor_instr = input_instrs[i + 3];
+      if(load_instr->GetType() == LOAD_INT_VAR && load_instr->GetOperand2() == LOCL &&
+         (calc_instr->GetType() == ADD_INT || calc_instr->GetType() == SUB_INT) &&
+         stor_instr->GetType() == STOR_INT_VAR && stor_instr->GetOperand2() == LOCL &&
+         load_instr->GetOperand() == stor_instr->GetOperand()) {
+        const long value = calc_instr->GetType() == ADD_INT ? (long)instr->GetOperand7() : -(long)instr->GetOperand7();
+        outputs->AddInstruction(IntermediateFactory::Instance()->MakeInstruction(cur_line_num, INC_LOCL_INT_VAR, load_instr->GetOperand(), value));
+        i += 3;
+        continue;
+      }
+    }
+
+    // 'LOAD_INT_VAR v; LOAD_INT_VAR v2' -> 'LOAD_LOCL_INT_VARS v, v2'
+    if(i + 1 < input_instrs.size() && instr->GetType() == LOAD_INT_VAR && instr->GetOperand2() == LOCL) {
+      IntermediateInstruction* next_instr = input_instrs[i + 1];
+      if(next_instr->GetType() == LOAD_INT_VAR && next_instr->GetOperand2() == LOCL) {
+        outputs->AddInstruction(IntermediateFactory::Instance()->MakeInstruction(cur_line_num, LOAD_LOCL_INT_VARS, instr->GetOperand(), next_instr->GetOperand()));
+        ++i;
+        continue;
+      }
+    }
+
+    outputs->AddInstruction(instr);
+  }
+
   return outputs;
 }
 
@@ -673,6 +914,9 @@ bool ItermediateOptimizer::CanInlineMethod(IntermediateMethod* mthd_called, std:
     case instructions::LOAD_FLOAT_VAR:
     case instructions::STOR_FLOAT_VAR:
     case instructions::COPY_FLOAT_VAR:
+    case instructions::LOAD_FUNC_VAR:
+    case instructions::STOR_FUNC_VAR:
+    case instructions::COPY_FUNC_VAR:
       // if the method/function is in another class it must only have local references
       if(mthd_called_instr->GetOperand2() != LOCL) {
         return false;
@@ -809,6 +1053,375 @@ int ItermediateOptimizer::CanInlineSetterGetter(IntermediateMethod* mthd_called)
   return -1;
 }
 
+/****************************
+ * Replaces objects that never
+ * escape a method with locals
+ ****************************/
+std::vector<IntermediateBlock*> ItermediateOptimizer::ScalarReplacement(std::vector<IntermediateBlock*> inputs)
+{
+  // find local objects that are only used for field access
+  std::map<long, long> candidate_classes;
+  std::map<long, std::set<IntermediateMethod*> > candidate_ctors;
+  for(size_t i = 0; i < inputs.size(); ++i) {
+    std::vector<IntermediateInstruction*> input_instrs = inputs[i]->GetInstructions();
+    for(size_t j = 0; j < input_instrs.size(); ++j) {
+      IntermediateInstruction* instr = input_instrs[j];
+      if(instr->GetOperand2() != LOCL) {
+        continue;
+      }
+
+      switch(instr->GetType()) {
+      case STOR_INT_VAR:
+        // allocation: NEW_OBJ_INST, MTHD_CALL (constructor), STOR_INT_VAR
+        if(j > 1 && input_instrs[j - 1]->GetType() == MTHD_CALL && input_instrs[j - 2]->GetType() == NEW_OBJ_INST &&
+           input_instrs[j - 1]->GetOperand() == input_instrs[j - 2]->GetOperand()) {
+          const long cls_id = input_instrs[j - 1]->GetOperand();
+          std::map<long, long>::iterator result = candidate_classes.find(instr->GetOperand());
+          if(result == candidate_classes.end()) {
+            candidate_classes[instr->GetOperand()] = cls_id;
+          }
+          else if(result->second != cls_id) {
+            result->second = -1;
+          }
+          candidate_ctors[instr->GetOperand()].insert(program->GetClass(cls_id)->GetMethod(input_instrs[j - 1]->GetOperand2()));
+        }
+        else {
+          candidate_classes[instr->GetOperand()] = -1;
+        }
+        break;
+
+      case LOAD_INT_VAR:
+        // field access: LOAD_INT_VAR, LOAD/STOR/COPY_*_VAR (instance)
+        if(j + 1 < input_instrs.size() && input_instrs[j + 1]->GetOperand2() == INST) {
+          switch(input_instrs[j + 1]->GetType()) {
+          case LOAD_INT_VAR:
+          case LOAD_FLOAT_VAR:
+          case STOR_INT_VAR:
+          case STOR_FLOAT_VAR:
+          case COPY_INT_VAR:
+          case COPY_FLOAT_VAR:
+            break;
+
+          default:
+            candidate_classes[instr->GetOperand()] = -1;
+            break;
+          }
+        }
+        else {
+          candidate_classes[instr->GetOperand()] = -1;
+        }
+        break;
+
+      case COPY_INT_VAR:
+      case LOAD_FLOAT_VAR:
+      case STOR_FLOAT_VAR:
+      case COPY_FLOAT_VAR:
+        candidate_classes[instr->GetOperand()] = -1;
+        break;
+
+      case LOAD_FUNC_VAR:
+      case STOR_FUNC_VAR:
+      case COPY_FUNC_VAR:
+        candidate_classes[instr->GetOperand()] = -1;
+        candidate_classes[instr->GetOperand() + 1] = -1;
+        break;
+
+      default:
+        break;
+      }
+    }
+  }
+
+  // assign locals to the fields of replaced objects
+  std::map<long, std::map<long, long> > replaced_fields;
+  std::map<long, std::map<IntermediateMethod*, long> > replaced_ctors;
+  for(std::map<long, long>::iterator iter = candidate_classes.begin(); iter != candidate_classes.end(); ++iter) {
+    if(iter->second < 0) {
+      continue;
+    }
+
+    bool can_replace = true;
+    std::set<IntermediateMethod*> ctors = candidate_ctors[iter->first];
+    for(std::set<IntermediateMethod*>::iterator ctor_iter = ctors.begin(); can_replace && ctor_iter != ctors.end(); ++ctor_iter) {
+      std::set<long> stored_fields;
+      can_replace = CanScalarReplace(*ctor_iter, stored_fields);
+    }
+
+    if(can_replace) {
+      std::vector<IntermediateDeclaration*> field_dclrs = program->GetClass(iter->second)->GetInstanceEntries()->GetParameters();
+      for(size_t i = 0; i < field_dclrs.size(); ++i) {
+        replaced_fields[iter->first][(long)i] = AddLocal(field_dclrs[i]->GetType());
+      }
+
+      for(std::set<IntermediateMethod*>::iterator ctor_iter = ctors.begin(); ctor_iter != ctors.end(); ++ctor_iter) {
+        std::vector<IntermediateDeclaration*> ctor_dclrs = (*ctor_iter)->GetEntries()->GetParameters();
+        long ctor_offset = -1;
+        for(size_t i = 0; i < ctor_dclrs.size(); ++i) {
+          const long local_id = AddLocal(ctor_dclrs[i]->GetType());
+          if(ctor_offset < 0) {
+            ctor_offset = local_id;
+          }
+        }
+        replaced_ctors[iter->first][*ctor_iter] = ctor_offset;
+      }
+
+      program->AddScalarReplacement(current_method->GetName() + L": '" + program->GetClass(iter->second)->GetName() + L"'");
+    }
+  }
+
+  if(replaced_fields.empty()) {
+    return inputs;
+  }
+
+  // rewrite allocations and field access
+  std::vector<IntermediateBlock*> outputs;
+  while(!inputs.empty()) {
+    IntermediateBlock* tmp = inputs.front();
+    IntermediateBlock* output = new IntermediateBlock;
+
+    std::vector<IntermediateInstruction*> input_instrs = tmp->GetInstructions();
+    for(size_t i = 0; i < input_instrs.size(); ++i) {
+      IntermediateInstruction* instr = input_instrs[i];
+      if(instr->GetType() == NEW_OBJ_INST && i + 2 < input_instrs.size() && input_instrs[i + 2]->GetType() == STOR_INT_VAR &&
+         input_instrs[i + 2]->GetOperand2() == LOCL && replaced_fields.find(input_instrs[i + 2]->GetOperand()) != replaced_fields.end()) {
+        const long var_id = input_instrs[i + 2]->GetOperand();
+        IntermediateMethod* ctor_called = program->GetClass(input_instrs[i + 1]->GetOperand())->GetMethod(input_instrs[i + 1]->GetOperand2());
+        ScalarReplaceAllocation(ctor_called, replaced_fields[var_id], replaced_ctors[var_id], output);
+        i += 2;
+      }
+      else if(instr->GetType() == LOAD_INT_VAR && instr->GetOperand2() == LOCL && 
+              replaced_fields.find(instr->GetOperand()) != replaced_fields.end()) {
+        IntermediateInstruction* field_instr = input_instrs[++i];
+        output->AddInstruction(IntermediateFactory::Instance()->MakeInstruction(cur_line_num, field_instr->GetType(), 
+                                                                               replaced_fields[instr->GetOperand()][field_instr->GetOperand()], LOCL));
+      }
+      else {
+        output->AddInstruction(instr);
+      }
+    }
+    outputs.push_back(output);
+
+    // delete old block
+    inputs.erase(inputs.begin());
+    delete tmp;
+    tmp = nullptr;
+  }
+
+  return outputs;
+}
+
+bool ItermediateOptimizer::CanScalarReplace(IntermediateMethod* ctor_called, std::set<long> &stored_fields)
+{
+  // class must only extend 'System.Base' and have a small number of scalar fields
+  IntermediateClass* klass = ctor_called->GetClass();
+  if(ctor_called == current_method || klass->IsVirtual() || klass->GetParentName() != L"System.Base") {
+    return false;
+  }
+
+  std::vector<IntermediateDeclaration*> field_dclrs = klass->GetInstanceEntries()->GetParameters();
+  if(field_dclrs.size() > SCALAR_REPLACE_MAX_FIELDS) {
+    return false;
+  }
+
+  for(size_t i = 0; i < field_dclrs.size(); ++i) {
+    if(field_dclrs[i]->GetType() == FUNC_PARM) {
+      return false;
+    }
+  }
+
+  std::vector<IntermediateDeclaration*> ctor_dclrs = ctor_called->GetEntries()->GetParameters();
+  for(size_t i = 0; i < ctor_dclrs.size(); ++i) {
+    if(ctor_dclrs[i]->GetType() == FUNC_PARM) {
+      return false;
+    }
+  }
+
+  // constructor must be straight-line code that only updates fields
+  std::vector<IntermediateBlock*> ctor_blocks = ctor_called->GetBlocks();
+  if(ctor_called->HasAndOr() || ctor_blocks.size() != 1) {
+    return false;
+  }
+
+  std::vector<IntermediateInstruction*> ctor_instrs = ctor_blocks[0]->GetInstructions();
+  const size_t ctor_size = ctor_instrs.size();
+  if(ctor_size < 2 || ctor_instrs[ctor_size - 1]->GetType() != RTRN || ctor_instrs[ctor_size - 2]->GetType() != LOAD_INST_MEM) {
+    return false;
+  }
+
+  std::set<long> loaded_fields;
+  for(size_t i = 0; i < ctor_size - 2; ++i) {
+    IntermediateInstruction* instr = ctor_instrs[i];
+    switch(instr->GetType()) {
+    case LOAD_INST_MEM: {
+      IntermediateInstruction* next_instr = ctor_instrs[i + 1];
+      switch(next_instr->GetType()) {
+      case LOAD_INT_VAR:
+      case LOAD_FLOAT_VAR:
+        if(next_instr->GetOperand2() != INST) {
+          return false;
+        }
+        loaded_fields.insert(next_instr->GetOperand());
+        break;
+
+      case STOR_INT_VAR:
+      case STOR_FLOAT_VAR:
+      case COPY_INT_VAR:
+      case COPY_FLOAT_VAR:
+        if(next_instr->GetOperand2() != INST) {
+          return false;
+        }
+        if(loaded_fields.find(next_instr->GetOperand()) == loaded_fields.end()) {
+          stored_fields.insert(next_instr->GetOperand());
+        }
+        break;
+
+      case MTHD_CALL:
+        // parent constructor
+        if(i + 2 >= ctor_size - 2 || ctor_instrs[i + 2]->GetType() != POP_INT ||
+           program->GetClass(next_instr->GetOperand())->GetMethod(next_instr->GetOperand2())->GetName() != L"System.Base:New:") {
+          return false;
+        }
+        ++i;
+        break;
+
+      default:
+        return false;
+      }
+      ++i;
+    }
+      break;
+
+    case LOAD_INT_VAR:
+    case LOAD_FLOAT_VAR:
+    case STOR_INT_VAR:
+    case STOR_FLOAT_VAR:
+    case COPY_INT_VAR:
+    case COPY_FLOAT_VAR:
+      if(instr->GetOperand2() == INST) {
+        return false;
+      }
+      break;
+
+    case LOAD_INT_LIT:
+    case LOAD_CHAR_LIT:
+    case LOAD_FLOAT_LIT:
+    case EQL_INT:
+    case NEQL_INT:
+    case LES_INT:
+    case GTR_INT:
+    case LES_EQL_INT:
+    case GTR_EQL_INT:
+    case EQL_FLOAT:
+    case NEQL_FLOAT:
+    case LES_FLOAT:
+    case GTR_FLOAT:
+    case LES_EQL_FLOAT:
+    case GTR_EQL_FLOAT:
+    case ADD_INT:
+    case SUB_INT:
+    case MUL_INT:
+    case BIT_AND_INT:
+    case BIT_OR_INT:
+    case BIT_XOR_INT:
+    case BIT_NOT_INT:
+    case SHL_INT:
+    case SHR_INT:
+    case ADD_FLOAT:
+    case SUB_FLOAT:
+    case MUL_FLOAT:
+    case DIV_FLOAT:
+    case I2F:
+    case F2I:
+    case POP_INT:
+    case POP_FLOAT:
+      break;
+
+    default:
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void ItermediateOptimizer::ScalarReplaceAllocation(IntermediateMethod* ctor_called, std::map<long, long> &field_locals, 
+                                                   std::map<IntermediateMethod*, long> &ctor_locals, IntermediateBlock* outputs)
+{
+  std::set<long> stored_fields;
+  CanScalarReplace(ctor_called, stored_fields);
+
+  // clear fields that are not set by the constructor
+  std::vector<IntermediateDeclaration*> field_dclrs = ctor_called->GetClass()->GetInstanceEntries()->GetParameters();
+  for(size_t i = 0; i < field_dclrs.size(); ++i) {
+    if(stored_fields.find((long)i) == stored_fields.end()) {
+      if(field_dclrs[i]->GetType() == FLOAT_PARM) {
+        outputs->AddInstruction(IntermediateFactory::Instance()->MakeInstruction(cur_line_num, LOAD_FLOAT_LIT, (FLOAT_VALUE)0.0));
+        outputs->AddInstruction(IntermediateFactory::Instance()->MakeInstruction(cur_line_num, STOR_FLOAT_VAR, field_locals[(long)i], LOCL));
+      }
+      else {
+        outputs->AddInstruction(IntermediateFactory::Instance()->MakeIntLitInstruction(cur_line_num, 0));
+        outputs->AddInstruction(IntermediateFactory::Instance()->MakeInstruction(cur_line_num, STOR_INT_VAR, field_locals[(long)i], LOCL));
+      }
+    }
+  }
+
+  // inline constructor body
+  const long local_offset = ctor_locals[ctor_called];
+  std::vector<IntermediateInstruction*> ctor_instrs = ctor_called->GetBlocks()[0]->GetInstructions();
+  for(size_t i = 0; i < ctor_instrs.size() - 2; ++i) {
+    IntermediateInstruction* instr = ctor_instrs[i];
+    switch(instr->GetType()) {
+    case LOAD_INST_MEM: {
+      IntermediateInstruction* next_instr = ctor_instrs[++i];
+      if(next_instr->GetType() == MTHD_CALL) {
+        // skip parent constructor
+        ++i;
+      }
+      else {
+        outputs->AddInstruction(IntermediateFactory::Instance()->MakeInstruction(cur_line_num, next_instr->GetType(), 
+                                                                                field_locals[next_instr->GetOperand()], LOCL));
+      }
+    }
+      break;
+
+    case LOAD_INT_VAR:
+    case LOAD_FLOAT_VAR:
+    case STOR_INT_VAR:
+    case STOR_FLOAT_VAR:
+    case COPY_INT_VAR:
+    case COPY_FLOAT_VAR:
+      if(instr->GetOperand2() == LOCL) {
+        outputs->AddInstruction(IntermediateFactory::Instance()->MakeInstruction(cur_line_num, instr->GetType(), 
+                                                                                instr->GetOperand() + local_offset, LOCL));
+      }
+      else {
+        outputs->AddInstruction(instr);
+      }
+      break;
+
+    default:
+      outputs->AddInstruction(instr);
+      break;
+    }
+  }
+}
+
+long ItermediateOptimizer::AddLocal(ParamType type)
+{
+  IntermediateDeclarations* entries = current_method->GetEntries();
+  
+  long local_id = current_method->HasAndOr() ? 1 : 0;
+  std::vector<IntermediateDeclaration*> dclrs = entries->GetParameters();
+  for(size_t i = 0; i < dclrs.size(); ++i) {
+    local_id += dclrs[i]->GetType() == FUNC_PARM ? 2 : 1;
+  }
+
+  entries->AddParameter(new IntermediateDeclaration(L"", type));
+  current_method->SetSpace(current_method->GetSpace() + sizeof(INT64_VALUE));
+
+  return local_id;
+}
+
 IntermediateBlock* ItermediateOptimizer::StrengthReduction(IntermediateBlock* inputs)
 {
   IntermediateBlock* outputs = new IntermediateBlock;
@@ -1003,6 +1616,427 @@ void ItermediateOptimizer::AddBackReduction(IntermediateInstruction* instr, Inte
   outputs->AddInstruction(instr);
 }
 
+/********************************
+ * Optimizes loops, innermost first. 
+ * Array sizes used by loop conditions 
+ * are hoisted, derived induction variables 
+ * are strength reduced and small loop 
+ * bodies are unrolled.
+ ********************************/
+IntermediateBlock* ItermediateOptimizer::LoopOptimization(IntermediateBlock* inputs)
+{
+  std::vector<IntermediateInstruction*> instrs = ReplaceArraySizeCalls(inputs->GetInstructions());
+
+  std::set<long> visited_loops;
+  size_t header_pos = 0; size_t back_pos = 0;
+  while(FindLoop(instrs, visited_loops, header_pos, back_pos)) {
+    visited_loops.insert(instrs[header_pos]->GetOperand());
+
+    std::vector<IntermediateInstruction*> preheader_instrs;
+    std::vector<IntermediateInstruction*> loop_instrs(instrs.begin() + header_pos, instrs.begin() + back_pos + 1);
+    HoistArraySize(loop_instrs, preheader_instrs);
+    ReduceInductionVariables(loop_instrs, preheader_instrs);
+    if(back_pos + 1 < instrs.size()) {
+      UnrollLoop(loop_instrs, instrs, instrs[back_pos + 1]);
+    }
+
+    // splice optimized loop back into method
+    std::vector<IntermediateInstruction*> output_instrs(instrs.begin(), instrs.begin() + header_pos);
+    output_instrs.insert(output_instrs.end(), preheader_instrs.begin(), preheader_instrs.end());
+    output_instrs.insert(output_instrs.end(), loop_instrs.begin(), loop_instrs.end());
+    output_instrs.insert(output_instrs.end(), instrs.begin() + back_pos + 1, instrs.end());
+    instrs = output_instrs;
+  }
+
+  IntermediateBlock* outputs = new IntermediateBlock;
+  for(size_t i = 0; i < instrs.size(); ++i) {
+    outputs->AddInstruction(instrs[i]);
+  }
+
+  return outputs;
+}
+
+/********************************
+ * Replaces calls to array 'Size()' 
+ * functions with 'LOAD_ARY_SIZE'
+ ********************************/
+std::vector<IntermediateInstruction*> ItermediateOptimizer::ReplaceArraySizeCalls(std::vector<IntermediateInstruction*> input_instrs)
+{
+  std::vector<IntermediateInstruction*> output_instrs;
+
+  for(size_t i = 0; i < input_instrs.size(); ++i) {
+    IntermediateInstruction* instr = input_instrs[i];
+    if(i + 1 < input_instrs.size() && instr->GetType() == LOAD_INST_MEM && input_instrs[i + 1]->GetType() == MTHD_CALL) {
+      IntermediateInstruction* call_instr = input_instrs[i + 1];
+      IntermediateMethod* mthd_called = program->GetClass(call_instr->GetOperand())->GetMethod(call_instr->GetOperand2());
+      if(IsArraySizeFunction(mthd_called)) {
+        output_instrs.push_back(IntermediateFactory::Instance()->MakeInstruction(cur_line_num, LOAD_ARY_SIZE));
+        ++i;
+        continue;
+      }
+    }
+    output_instrs.push_back(instr);
+  }
+
+  return output_instrs;
+}
+
+/********************************
+ * Checks for a function that only 
+ * returns the size of its array parameter
+ ********************************/
+bool ItermediateOptimizer::IsArraySizeFunction(IntermediateMethod* mthd_called)
+{
+  // blocks of the current method are being replaced
+  if(!mthd_called || mthd_called == current_method || mthd_called->IsVirtual() || mthd_called->GetBlocks().empty()) {
+    return false;
+  }
+
+  std::vector<IntermediateInstruction*> mthd_called_instrs = mthd_called->GetBlocks()[0]->GetInstructions();
+  return mthd_called_instrs.size() == 4 && 
+    mthd_called_instrs[0]->GetType() == STOR_INT_VAR && mthd_called_instrs[0]->GetOperand() == 0 && mthd_called_instrs[0]->GetOperand2() == LOCL &&
+    mthd_called_instrs[1]->GetType() == LOAD_INT_VAR && mthd_called_instrs[1]->GetOperand() == 0 && mthd_called_instrs[1]->GetOperand2() == LOCL &&
+    mthd_called_instrs[2]->GetType() == LOAD_ARY_SIZE && mthd_called_instrs[3]->GetType() == RTRN;
+}
+
+/********************************
+ * Finds the next loop that has not been 
+ * visited. A loop starts with a label, ends 
+ * with an unconditional backward jump to 
+ * that label and has no entries other than 
+ * its header.
+ ********************************/
+bool ItermediateOptimizer::FindLoop(std::vector<IntermediateInstruction*> &instrs, std::set<long> &visited_loops, size_t &header_pos, size_t &back_pos)
+{
+  std::map<long, size_t> lbl_positions;
+  for(size_t i = 0; i < instrs.size(); ++i) {
+    if(instrs[i]->GetType() == LBL) {
+      lbl_positions[instrs[i]->GetOperand()] = i;
+    }
+  }
+
+  // jump source and target positions
+  std::vector<std::pair<size_t, size_t> > jmp_positions;
+  for(size_t i = 0; i < instrs.size(); ++i) {
+    if(instrs[i]->GetType() == JMP) {
+      std::map<long, size_t>::iterator target = lbl_positions.find(instrs[i]->GetOperand());
+      if(target != lbl_positions.end()) {
+        jmp_positions.push_back(std::pair<size_t, size_t>(i, target->second));
+      }
+    }
+  }
+
+  for(size_t i = 0; i < instrs.size(); ++i) {
+    IntermediateInstruction* instr = instrs[i];
+    if(instr->GetType() != JMP || instr->GetOperand2() != -1 || visited_loops.find(instr->GetOperand()) != visited_loops.end()) {
+      continue;
+    }
+
+    std::map<long, size_t>::iterator result = lbl_positions.find(instr->GetOperand());
+    if(result == lbl_positions.end() || result->second > i) {
+      continue;
+    }
+
+    // jumps outside of the loop may not target labels inside of it
+    bool is_loop = true;
+    for(size_t j = 0; is_loop && j < jmp_positions.size(); ++j) {
+      const size_t jmp_pos = jmp_positions[j].first;
+      const size_t lbl_pos = jmp_positions[j].second;
+      if((jmp_pos < result->second || jmp_pos > i) && lbl_pos >= result->second && lbl_pos <= i) {
+        is_loop = false;
+      }
+    }
+
+    if(is_loop) {
+      header_pos = result->second;
+      back_pos = i;
+      return true;
+    }
+    visited_loops.insert(instr->GetOperand());
+  }
+
+  return false;
+}
+
+/********************************
+ * Checks if a local variable is 
+ * written within a sequence of instructions
+ ********************************/
+bool ItermediateOptimizer::IsLocalWritten(std::vector<IntermediateInstruction*> &instrs, long id)
+{
+  for(size_t i = 0; i < instrs.size(); ++i) {
+    IntermediateInstruction* instr = instrs[i];
+    switch(instr->GetType()) {
+    case STOR_INT_VAR:
+    case STOR_FLOAT_VAR:
+    case COPY_INT_VAR:
+    case COPY_FLOAT_VAR:
+      if(instr->GetOperand2() == LOCL && instr->GetOperand() == id) {
+        return true;
+      }
+      break;
+
+    case STOR_FUNC_VAR:
+    case COPY_FUNC_VAR:
+      if(instr->GetOperand2() == LOCL && (instr->GetOperand() == id || instr->GetOperand() + 1 == id)) {
+        return true;
+      }
+      break;
+
+    case INC_LOCL_INT_VAR:
+      if(instr->GetOperand() == id) {
+        return true;
+      }
+      break;
+
+    default:
+      break;
+    }
+  }
+
+  return false;
+}
+
+/********************************
+ * Moves the array size check of a loop 
+ * condition in front of the loop, if 
+ * the array is not changed by the loop
+ ********************************/
+void ItermediateOptimizer::HoistArraySize(std::vector<IntermediateInstruction*> &loop_instrs, std::vector<IntermediateInstruction*> &preheader_instrs)
+{
+  if(loop_instrs.size() < 4 || loop_instrs[1]->GetType() != LOAD_INT_VAR || loop_instrs[1]->GetOperand2() != LOCL ||
+     loop_instrs[2]->GetType() != LOAD_ARY_SIZE) {
+    return;
+  }
+
+  const long ary_id = loop_instrs[1]->GetOperand();
+  if(IsLocalWritten(loop_instrs, ary_id)) {
+    return;
+  }
+
+  const long size_id = AddLocal(INT_PARM);
+  preheader_instrs.push_back(loop_instrs[1]);
+  preheader_instrs.push_back(loop_instrs[2]);
+  preheader_instrs.push_back(IntermediateFactory::Instance()->MakeInstruction(cur_line_num, STOR_INT_VAR, size_id, LOCL));
+
+  loop_instrs[1] = IntermediateFactory::Instance()->MakeInstruction(cur_line_num, LOAD_INT_VAR, size_id, LOCL);
+  loop_instrs.erase(loop_instrs.begin() + 2);
+}
+
+/********************************
+ * Replaces multiplications of basic induction 
+ * variables by constants (i.e. 'i * c' and 'i << c') 
+ * with derived induction variables that are 
+ * updated along with the basic variable.
+ ********************************/
+void ItermediateOptimizer::ReduceInductionVariables(std::vector<IntermediateInstruction*> &loop_instrs, std::vector<IntermediateInstruction*> &preheader_instrs)
+{
+  // find basic induction variables, only updated by 'i += k' or 'i -= k'
+  std::map<long, bool> basic_vars;
+  for(size_t i = 0; i < loop_instrs.size(); ++i) {
+    IntermediateInstruction* instr = loop_instrs[i];
+    if(instr->GetType() == STOR_INT_VAR && instr->GetOperand2() == LOCL) {
+      const bool is_step = i > 2 && loop_instrs[i - 3]->GetType() == LOAD_INT_LIT &&
+        loop_instrs[i - 3]->GetOperand7() >= -INT32_MAX && loop_instrs[i - 3]->GetOperand7() <= INT32_MAX &&
+        loop_instrs[i - 2]->GetType() == LOAD_INT_VAR && loop_instrs[i - 2]->GetOperand2() == LOCL &&
+        loop_instrs[i - 2]->GetOperand() == instr->GetOperand() &&
+        (loop_instrs[i - 1]->GetType() == ADD_INT || loop_instrs[i - 1]->GetType() == SUB_INT);
+
+      std::map<long, bool>::iterator result = basic_vars.find(instr->GetOperand());
+      if(result == basic_vars.end()) {
+        basic_vars[instr->GetOperand()] = is_step;
+      }
+      else {
+        result->second = result->second && is_step;
+      }
+    }
+  }
+
+  std::map<long, bool>::iterator iter = basic_vars.begin();
+  while(iter != basic_vars.end()) {
+    if(!iter->second) {
+      iter = basic_vars.erase(iter);
+      continue;
+    }
+
+    // no other writes allowed
+    bool is_written = false;
+    for(size_t i = 0; !is_written && i < loop_instrs.size(); ++i) {
+      IntermediateInstruction* instr = loop_instrs[i];
+      if(instr->GetType() != STOR_INT_VAR) {
+        std::vector<IntermediateInstruction*> check_instrs(1, instr);
+        is_written = IsLocalWritten(check_instrs, iter->first);
+      }
+    }
+    if(is_written) {
+      iter = basic_vars.erase(iter);
+    }
+    else {
+      ++iter;
+    }
+  }
+
+  if(basic_vars.empty()) {
+    return;
+  }
+
+  // find multiplications by constants
+  std::map<std::pair<long, INT64_VALUE>, long> derived_vars;
+  std::vector<IntermediateInstruction*> output_instrs;
+  for(size_t i = 0; i < loop_instrs.size(); ++i) {
+    IntermediateInstruction* instr = loop_instrs[i];
+    if(i + 2 < loop_instrs.size()) {
+      IntermediateInstruction* lit_instr = nullptr;
+      IntermediateInstruction* var_instr = nullptr;
+      IntermediateInstruction* calc_instr = loop_instrs[i + 2];
+      if(instr->GetType() == LOAD_INT_LIT) {
+        lit_instr = instr;
+        var_instr = loop_instrs[i + 1];
+      }
+      else if(calc_instr->GetType() == MUL_INT) {
+        var_instr = instr;
+        lit_instr = loop_instrs[i + 1];
+      }
+
+      if(lit_instr && lit_instr->GetType() == LOAD_INT_LIT && var_instr->GetType() == LOAD_INT_VAR && 
+         var_instr->GetOperand2() == LOCL && basic_vars.find(var_instr->GetOperand()) != basic_vars.end()) {
+        INT64_VALUE factor = 0;
+        if(calc_instr->GetType() == MUL_INT) {
+          factor = lit_instr->GetOperand7();
+        }
+        else if(calc_instr->GetType() == SHL_INT && lit_instr == instr && lit_instr->GetOperand7() > 0 && lit_instr->GetOperand7() < 31) {
+          factor = (INT64_VALUE)1 << lit_instr->GetOperand7();
+        }
+
+        const std::pair<long, INT64_VALUE> key(var_instr->GetOperand(), factor);
+        std::map<std::pair<long, INT64_VALUE>, long>::iterator result = derived_vars.find(key);
+        if(factor > 1 && factor <= INT32_MAX && (result != derived_vars.end() || derived_vars.size() < LOOP_DERIVED_VARS_MAX)) {
+          long derived_id;
+          if(result == derived_vars.end()) {
+            derived_id = AddLocal(INT_PARM);
+            derived_vars[key] = derived_id;
+
+            // initialize in front of the loop
+            preheader_instrs.push_back(IntermediateFactory::Instance()->MakeIntLitInstruction(cur_line_num, factor));
+            preheader_instrs.push_back(IntermediateFactory::Instance()->MakeInstruction(cur_line_num, LOAD_INT_VAR, key.first, LOCL));
+            preheader_instrs.push_back(IntermediateFactory::Instance()->MakeInstruction(cur_line_num, MUL_INT));
+            preheader_instrs.push_back(IntermediateFactory::Instance()->MakeInstruction(cur_line_num, STOR_INT_VAR, derived_id, LOCL));
+          }
+          else {
+            derived_id = result->second;
+          }
+
+          output_instrs.push_back(IntermediateFactory::Instance()->MakeInstruction(cur_line_num, LOAD_INT_VAR, derived_id, LOCL));
+          i += 2;
+          continue;
+        }
+      }
+    }
+    output_instrs.push_back(instr);
+  }
+
+  if(derived_vars.empty()) {
+    return;
+  }
+
+  // update derived variables along with their basic variables
+  loop_instrs.clear();
+  for(size_t i = 0; i < output_instrs.size(); ++i) {
+    IntermediateInstruction* instr = output_instrs[i];
+    loop_instrs.push_back(instr);
+
+    if(instr->GetType() == STOR_INT_VAR && instr->GetOperand2() == LOCL && basic_vars.find(instr->GetOperand()) != basic_vars.end()) {
+      const INT64_VALUE step = output_instrs[i - 1]->GetType() == ADD_INT ? output_instrs[i - 3]->GetOperand7() : -output_instrs[i - 3]->GetOperand7();
+      for(std::map<std::pair<long, INT64_VALUE>, long>::iterator iter = derived_vars.begin(); iter != derived_vars.end(); ++iter) {
+        if(iter->first.first == instr->GetOperand()) {
+          loop_instrs.push_back(IntermediateFactory::Instance()->MakeIntLitInstruction(cur_line_num, step * iter->first.second));
+          loop_instrs.push_back(IntermediateFactory::Instance()->MakeInstruction(cur_line_num, LOAD_INT_VAR, iter->second, LOCL));
+          loop_instrs.push_back(IntermediateFactory::Instance()->MakeInstruction(cur_line_num, ADD_INT));
+          loop_instrs.push_back(IntermediateFactory::Instance()->MakeInstruction(cur_line_num, STOR_INT_VAR, iter->second, LOCL));
+        }
+      }
+    }
+  }
+}
+
+/********************************
+ * Unrolls loops with small, straight-line 
+ * bodies by repeating the loop condition 
+ * and body LOOP_UNROLL_FACTOR times
+ ********************************/
+void ItermediateOptimizer::UnrollLoop(std::vector<IntermediateInstruction*> &loop_instrs, std::vector<IntermediateInstruction*> &method_instrs, 
+                                      IntermediateInstruction* exit_instr)
+{
+  // find exit jump
+  size_t exit_pos = 1;
+  while(exit_pos < loop_instrs.size() && loop_instrs[exit_pos]->GetType() != JMP && loop_instrs[exit_pos]->GetType() != LBL) {
+    ++exit_pos;
+  }
+
+  const size_t back_pos = loop_instrs.size() - 1;
+  if(exit_pos >= back_pos || loop_instrs[exit_pos]->GetType() != JMP || loop_instrs[exit_pos]->GetOperand2() == -1 ||
+     exit_instr->GetType() != LBL || exit_instr->GetOperand() != loop_instrs[exit_pos]->GetOperand() || 
+     back_pos - 1 > LOOP_UNROLL_MAX_INSTRS) {
+    return;
+  }
+
+  // labels within the body must be unused
+  std::set<long> jmp_lbls;
+  for(size_t i = 0; i < method_instrs.size(); ++i) {
+    if(method_instrs[i]->GetType() == JMP) {
+      jmp_lbls.insert(method_instrs[i]->GetOperand());
+    }
+  }
+
+  for(size_t i = 1; i < back_pos; ++i) {
+    switch(loop_instrs[i]->GetType()) {
+    case LBL:
+      if(jmp_lbls.find(loop_instrs[i]->GetOperand()) != jmp_lbls.end()) {
+        return;
+      }
+      break;
+
+    case JMP:
+      if(i != exit_pos) {
+        return;
+      }
+      break;
+
+      // keep calls out of unrolled bodies
+    case MTHD_CALL:
+    case DYN_MTHD_CALL:
+    case ASYNC_MTHD_CALL:
+    case EXT_LIB_FUNC_CALL:
+    case TRAP:
+    case TRAP_RTRN:
+    case RTRN:
+    case THREAD_JOIN:
+    case THREAD_SLEEP:
+    case THREAD_MUTEX:
+    case CRITICAL_START:
+    case CRITICAL_END:
+      return;
+
+    default:
+      break;
+    }
+  }
+
+  std::vector<IntermediateInstruction*> unrolled_instrs;
+  for(size_t i = 1; i < back_pos; ++i) {
+    if(loop_instrs[i]->GetType() != LBL) {
+      unrolled_instrs.push_back(loop_instrs[i]);
+    }
+  }
+
+  IntermediateInstruction* back_instr = loop_instrs[back_pos];
+  loop_instrs.pop_back();
+  for(int i = 1; i < LOOP_UNROLL_FACTOR; ++i) {
+    loop_instrs.insert(loop_instrs.end(), unrolled_instrs.begin(), unrolled_instrs.end());
+  }
+  loop_instrs.push_back(back_instr);
+}
+
 IntermediateBlock* ItermediateOptimizer::InlineMethod(IntermediateBlock* inputs)
 {
   std::set<IntermediateMethod*> inlined_mthds;
@@ -1036,7 +2070,7 @@ IntermediateBlock* ItermediateOptimizer::InlineMethod(IntermediateBlock* inputs)
         int local_instr_offset = 1;
         std::vector<IntermediateDeclaration*> current_dclrs = current_entries->GetParameters();
         for(size_t j = 0; j < current_dclrs.size(); ++j) {
-          local_instr_offset++;
+          local_instr_offset += current_dclrs[j]->GetType() == FUNC_PARM ? 2 : 1;
         }
 
         if(current_method->HasAndOr() || mthd_called->HasAndOr()) {
@@ -1074,6 +2108,9 @@ IntermediateBlock* ItermediateOptimizer::InlineMethod(IntermediateBlock* inputs)
           case LOAD_FLOAT_VAR:
           case STOR_FLOAT_VAR:
           case COPY_FLOAT_VAR:
+          case LOAD_FUNC_VAR:
+          case STOR_FUNC_VAR:
+          case COPY_FUNC_VAR:
             if(mthd_called_instr->GetOperand2() == LOCL) {
               outputs->AddInstruction(IntermediateFactory::Instance()->MakeInstruction(cur_line_num, mthd_called_instr->GetType(),
                 mthd_called_instr->GetOperand() + local_instr_offset, LOCL));
@@ -1088,6 +2125,16 @@ IntermediateBlock* ItermediateOptimizer::InlineMethod(IntermediateBlock* inputs)
             }
             break;
 
+          case INC_LOCL_INT_VAR:
+            outputs->AddInstruction(IntermediateFactory::Instance()->MakeInstruction(cur_line_num, INC_LOCL_INT_VAR,
+              mthd_called_instr->GetOperand() + local_instr_offset, mthd_called_instr->GetOperand2()));
+            break;
+
+          case LOAD_LOCL_INT_VARS:
+            outputs->AddInstruction(IntermediateFactory::Instance()->MakeInstruction(cur_line_num, LOAD_LOCL_INT_VARS,
+              mthd_called_instr->GetOperand() + local_instr_offset, mthd_called_instr->GetOperand2() + local_instr_offset));
+            break;
+
           case LOAD_INST_MEM:
             outputs->AddInstruction(IntermediateFactory::Instance()->MakeInstruction(cur_line_num, LOAD_INT_VAR, local_instr_offset - 1, LOCL));
             break;
@@ -1241,10 +2288,10 @@ std::pair<size_t, size_t> ItermediateOptimizer::DeadStoreEdit(size_t start_pos,
   size_t end_pos = start_pos;
   IntermediateInstruction* dead_store_instr = input_instrs[start_pos];
 
+  // walk back to the statement's first instruction, which may be the block's first
   bool done = false;
-  for(std::vector<IntermediateInstruction*>::iterator start_iter = input_instrs.begin() + start_pos - 1;
-      !done && start_iter != input_instrs.begin(); --start_iter) {
-    if((*start_iter)->GetStatement() == dead_store_instr->GetStatement()) {
+  for(size_t i = start_pos; !done && i > 0; --i) {
+    if(input_instrs[i - 1]->GetStatement() == dead_store_instr->GetStatement()) {
       --end_pos;
     }
     else {
@@ -39,6 +39,10 @@ using namespace backend;
 
 #define LOCL_INLINE_MEM_MAX 128
 #define JUMP_OFF_INC 257
+#define SCALAR_REPLACE_MAX_FIELDS 8
+#define LOOP_UNROLL_FACTOR 2
+#define LOOP_UNROLL_MAX_INSTRS 24
+#define LOOP_DERIVED_VARS_MAX 4
 
 /****************************
  * Performs optimizations on
@@ -46,13 +50,17 @@ using namespace backend;
  *
  * Order of optimizations:
  * 0.0 - clean up jumps and other unneeded instructions (always happens)
+ * 0.1 - devirtualization via class hierarchy analysis (level 2+)
  * 1.1 - setter and getter inlining
  * 1.2 - advanced method inlining 
  * 1.3 - constant propagation
  * 1.4 - dead store removal
  * 1.5 - constant folding
- * 2.1 - strength reduction
- * 3.1 - replace store+load with copy
+ * 2.1 - scalar replacement of non-escaping objects
+ * 2.2 - strength reduction
+ * 3.1 - loop optimization: array size hoisting, induction variable strength reduction and unrolling
+ * 3.2 - replace store+load with copy
+ * 3.3 - fuse common instruction sequences into superinstructions
  ****************************/
 
 union PropValue {
@@ -70,11 +78,22 @@ class ItermediateOptimizer {
   int cur_line_num;
   bool is_lib;
   int jump_offset;
+  // class hierarchy analysis
+  std::map<int, IntermediateClass*> cha_classes;
+  std::map<int, std::vector<IntermediateClass*> > cha_subtypes;
+  std::map<std::wstring, IntermediateMethod*> cha_methods;
+  std::map<IntermediateMethod*, IntermediateMethod*> cha_targets;
   
   std::vector<IntermediateBlock*> OptimizeMethod(std::vector<IntermediateBlock*> input);
   std::vector<IntermediateBlock*> InlineMethod(std::vector<IntermediateBlock*> inputs);
   std::vector<IntermediateBlock*> JumpToLocation(std::vector<IntermediateBlock*> inputs);
   
+  // devirtualization
+  void BuildClassHierarchy();
+  void Devirtualize(IntermediateBlock* inputs);
+  IntermediateMethod* ResolveVirtualCall(IntermediateMethod* virtual_mthd);
+  void GetConcreteSubtypes(IntermediateClass* klass, std::set<IntermediateClass*> &visited, std::vector<IntermediateClass*> &concretes);
+
   // inline setters/getters
   IntermediateBlock* InlineSettersGetters(IntermediateBlock* inputs);
 
@@ -105,6 +124,12 @@ class ItermediateOptimizer {
   IntermediateBlock* FoldFloatConstants(IntermediateBlock* input);
   void CalculateFloatFold(IntermediateInstruction* instr, std::deque<IntermediateInstruction*> &calc_stack, IntermediateBlock* outputs);
   
+  // scalar replacement
+  std::vector<IntermediateBlock*> ScalarReplacement(std::vector<IntermediateBlock*> inputs);
+  bool CanScalarReplace(IntermediateMethod* ctor_called, std::set<long> &stored_fields);
+  void ScalarReplaceAllocation(IntermediateMethod* ctor_called, std::map<long, long> &field_locals, std::map<IntermediateMethod*, long> &ctor_locals, IntermediateBlock* outputs);
+  long AddLocal(ParamType type);
+
   // strength reduction
   IntermediateBlock* StrengthReduction(IntermediateBlock* inputs);
   void CalculateReduction(IntermediateInstruction* instr, std::deque<IntermediateInstruction*> &calc_stack, IntermediateBlock* outputs);
@@ -114,10 +139,21 @@ class ItermediateOptimizer {
 
   void AddBackReduction(IntermediateInstruction* instr, IntermediateInstruction* top_instr, 
                         std::deque<IntermediateInstruction*> &calc_stack, IntermediateBlock* outputs);
+
+  // loop optimization
+  IntermediateBlock* LoopOptimization(IntermediateBlock* inputs);
+  std::vector<IntermediateInstruction*> ReplaceArraySizeCalls(std::vector<IntermediateInstruction*> input_instrs);
+  bool IsArraySizeFunction(IntermediateMethod* mthd_called);
+  bool FindLoop(std::vector<IntermediateInstruction*> &instrs, std::set<long> &visited_loops, size_t &header_pos, size_t &back_pos);
+  bool IsLocalWritten(std::vector<IntermediateInstruction*> &instrs, long id);
+  void HoistArraySize(std::vector<IntermediateInstruction*> &loop_instrs, std::vector<IntermediateInstruction*> &preheader_instrs);
+  void ReduceInductionVariables(std::vector<IntermediateInstruction*> &loop_instrs, std::vector<IntermediateInstruction*> &preheader_instrs);
+  void UnrollLoop(std::vector<IntermediateInstruction*> &loop_instrs, std::vector<IntermediateInstruction*> &method_instrs, IntermediateInstruction* exit_instr);
   
   // instruction replacement
   IntermediateBlock* InstructionReplacement(IntermediateBlock* inputs);
   void ReplacementInstruction(IntermediateInstruction* instr, std::deque<IntermediateInstruction*> &calc_stack, IntermediateBlock* outputs);
+  IntermediateBlock* FuseInstructions(IntermediateBlock* inputs);
 
   bool CanInlineMethod(IntermediateMethod* mthd_called, std::set<IntermediateMethod*> &inlined_mthds, std::set<int> &lbl_jmp_offsets);
   
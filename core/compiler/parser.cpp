@@ -2121,6 +2121,12 @@ Statement* Parser::ParseStatement(int depth, bool semi_colon)
       NextToken();
       break;
 
+    case TIMER_TICKS:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::TIMER_TICKS);
+      NextToken();
+      break;
+
     case FLOR_FLOAT:
       statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
                                                                instructions::FLOR_FLOAT);
@@ -2535,6 +2541,12 @@ Statement* Parser::ParseStatement(int depth, bool semi_colon)
       NextToken();
       break;
 
+    case STRING_COMPARE:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::STRING_COMPARE);
+      NextToken();
+      break;
+
     case LOAD_CLS_BY_INST:
       statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
                                                                instructions::LOAD_CLS_BY_INST);
@@ -3009,6 +3021,12 @@ Statement* Parser::ParseStatement(int depth, bool semi_colon)
       NextToken();
       break;
 
+    case SOCK_TCP_FLUSH:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::SOCK_TCP_FLUSH);
+      NextToken();
+      break;
+
     case SOCK_TCP_IN_BYTE:
       statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
                                                                instructions::SOCK_TCP_IN_BYTE);
@@ -3093,6 +3111,346 @@ Statement* Parser::ParseStatement(int depth, bool semi_colon)
       NextToken();
       break;
 
+    case SOCK_TCP_SSL_FLUSH:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::SOCK_TCP_SSL_FLUSH);
+      NextToken();
+      break;
+
+    case SOCK_TCP_SET_BLOCKING:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::SOCK_TCP_SET_BLOCKING);
+      NextToken();
+      break;
+
+    case SOCK_POLL_CREATE:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::SOCK_POLL_CREATE);
+      NextToken();
+      break;
+
+    case SOCK_POLL_ADD:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::SOCK_POLL_ADD);
+      NextToken();
+      break;
+
+    case SOCK_POLL_REMOVE:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::SOCK_POLL_REMOVE);
+      NextToken();
+      break;
+
+    case SOCK_POLL_WAIT:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::SOCK_POLL_WAIT);
+      NextToken();
+      break;
+
+    case SOCK_POLL_CLOSE:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::SOCK_POLL_CLOSE);
+      NextToken();
+      break;
+
+    case EXECUTOR_SUBMIT:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::EXECUTOR_SUBMIT);
+      NextToken();
+      break;
+
+    case EXECUTOR_SIZE:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::EXECUTOR_SIZE);
+      NextToken();
+      break;
+
+    case EXECUTOR_WAIT:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::EXECUTOR_WAIT);
+      NextToken();
+      break;
+
+    case EXECUTOR_NOTIFY:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::EXECUTOR_NOTIFY);
+      NextToken();
+      break;
+
+    case ATOMIC_LOAD: {
+      SystemStatement* system_stmt = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                                                  instructions::ATOMIC_LOAD);
+      system_stmt->SetVariable(ParseSystemVariable(depth + 1));
+      statement = system_stmt;
+    }
+      break;
+
+    case ATOMIC_STORE: {
+      SystemStatement* system_stmt = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                                                  instructions::ATOMIC_STORE);
+      system_stmt->SetVariable(ParseSystemVariable(depth + 1));
+      statement = system_stmt;
+    }
+      break;
+
+    case ATOMIC_ADD: {
+      SystemStatement* system_stmt = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                                                  instructions::ATOMIC_ADD);
+      system_stmt->SetVariable(ParseSystemVariable(depth + 1));
+      statement = system_stmt;
+    }
+      break;
+
+    case ATOMIC_SWAP: {
+      SystemStatement* system_stmt = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                                                  instructions::ATOMIC_SWAP);
+      system_stmt->SetVariable(ParseSystemVariable(depth + 1));
+      statement = system_stmt;
+    }
+      break;
+
+    case ATOMIC_CAS: {
+      SystemStatement* system_stmt = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                                                  instructions::ATOMIC_CAS);
+      system_stmt->SetVariable(ParseSystemVariable(depth + 1));
+      statement = system_stmt;
+    }
+      break;
+
+    case ATOMIC_ARY_LOAD:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::ATOMIC_ARY_LOAD);
+      NextToken();
+      break;
+
+    case ATOMIC_ARY_STORE:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::ATOMIC_ARY_STORE);
+      NextToken();
+      break;
+
+    case ATOMIC_ARY_ADD:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::ATOMIC_ARY_ADD);
+      NextToken();
+      break;
+
+    case ATOMIC_ARY_SWAP:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::ATOMIC_ARY_SWAP);
+      NextToken();
+      break;
+
+    case ATOMIC_ARY_CAS:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::ATOMIC_ARY_CAS);
+      NextToken();
+      break;
+
+    case COND_VAR_INIT:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::COND_VAR_INIT);
+      NextToken();
+      break;
+
+    case COND_VAR_WAIT:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::COND_VAR_WAIT);
+      NextToken();
+      break;
+
+    case COND_VAR_SIGNAL:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::COND_VAR_SIGNAL);
+      NextToken();
+      break;
+
+    case COND_VAR_BROADCAST:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::COND_VAR_BROADCAST);
+      NextToken();
+      break;
+
+    case SEMAPHORE_INIT:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::SEMAPHORE_INIT);
+      NextToken();
+      break;
+
+    case SEMAPHORE_ACQUIRE:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::SEMAPHORE_ACQUIRE);
+      NextToken();
+      break;
+
+    case SEMAPHORE_TRY_ACQUIRE:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::SEMAPHORE_TRY_ACQUIRE);
+      NextToken();
+      break;
+
+    case SEMAPHORE_RELEASE:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::SEMAPHORE_RELEASE);
+      NextToken();
+      break;
+
+    case RW_LOCK_INIT:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::RW_LOCK_INIT);
+      NextToken();
+      break;
+
+    case RW_LOCK_READ:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::RW_LOCK_READ);
+      NextToken();
+      break;
+
+    case RW_UNLOCK_READ:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::RW_UNLOCK_READ);
+      NextToken();
+      break;
+
+    case RW_LOCK_WRITE:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::RW_LOCK_WRITE);
+      NextToken();
+      break;
+
+    case RW_UNLOCK_WRITE:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::RW_UNLOCK_WRITE);
+      NextToken();
+      break;
+
+    case PARALLEL_SORT_INT:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::PARALLEL_SORT_INT);
+      NextToken();
+      break;
+
+    case PARALLEL_SORT_FLOAT:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::PARALLEL_SORT_FLOAT);
+      NextToken();
+      break;
+
+    case PARALLEL_SCAN_INT:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::PARALLEL_SCAN_INT);
+      NextToken();
+      break;
+
+    case PARALLEL_SCAN_FLOAT:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::PARALLEL_SCAN_FLOAT);
+      NextToken();
+      break;
+
+    case MAPPED_FILE_OPEN:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::MAPPED_FILE_OPEN);
+      NextToken();
+      break;
+
+    case MAPPED_FILE_CLOSE:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::MAPPED_FILE_CLOSE);
+      NextToken();
+      break;
+
+    case MAPPED_FILE_IN_BYTE:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::MAPPED_FILE_IN_BYTE);
+      NextToken();
+      break;
+
+    case MAPPED_FILE_IN_BYTE_ARY:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::MAPPED_FILE_IN_BYTE_ARY);
+      NextToken();
+      break;
+
+    case MAPPED_FILE_FIND_BYTE:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::MAPPED_FILE_FIND_BYTE);
+      NextToken();
+      break;
+
+    case MAPPED_FILE_IN_LINE:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::MAPPED_FILE_IN_LINE);
+      NextToken();
+      break;
+
+    case MAPPED_FILE_IN_STRING:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::MAPPED_FILE_IN_STRING);
+      NextToken();
+      break;
+
+    case JSON_TAPE_INDEX:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::JSON_TAPE_INDEX);
+      NextToken();
+      break;
+
+    case BYTES_TO_STRING:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::BYTES_TO_STRING);
+      NextToken();
+      break;
+
+    case REGEX_EXECUTE:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::REGEX_EXECUTE);
+      NextToken();
+      break;
+
+    case CSV_INDEX:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::CSV_INDEX);
+      NextToken();
+      break;
+
+    case CSV_INTS:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::CSV_INTS);
+      NextToken();
+      break;
+
+    case CSV_FLOATS:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::CSV_FLOATS);
+      NextToken();
+      break;
+
+    case XML_INDEX:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::XML_INDEX);
+      NextToken();
+      break;
+
+    case XML_DECODE:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::XML_DECODE);
+      NextToken();
+      break;
+
+    case STRING_UTF8_ENCODE:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::STRING_UTF8_ENCODE);
+      NextToken();
+      break;
+
+    case SOCK_TCP_SET_DEADLINE:
+      statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
+                                                               instructions::SOCK_TCP_SET_DEADLINE);
+      NextToken();
+      break;
+
     case SOCK_TCP_SSL_IN_BYTE:
       statement = TreeFactory::Instance()->MakeSystemStatement(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(),
                                                                instructions::SOCK_TCP_SSL_IN_BYTE);
@@ -5063,6 +5421,39 @@ CriticalSection* Parser::ParseCritical(int depth)
   return TreeFactory::Instance()->MakeCriticalSection(file_name, line_num, line_pos, GetLineNumber(), GetLinePosition(), variable, statements);
 }
 
+/****************************
+ * Parses the instance variable
+ * named by a system statement
+ ****************************/
+Variable* Parser::ParseSystemVariable(int depth)
+{
+#ifdef _DEBUG
+  Debug(L"System Variable", depth);
+#endif
+
+  NextToken();
+  if(!Match(TOKEN_OPEN_PAREN)) {
+    ProcessError(L"Expected '('", TOKEN_OPEN_PAREN);
+  }
+  NextToken();
+
+  if(!Match(TOKEN_IDENT)) {
+    ProcessError(TOKEN_IDENT);
+  }
+  const std::wstring ident = scanner->GetToken()->GetIdentifier();
+  IdentifierContext ident_context(ident, GetLineNumber(), GetLinePosition());
+
+  Variable* variable = ParseVariable(ident_context, depth + 1);
+
+  NextToken();
+  if(!Match(TOKEN_CLOSED_PAREN)) {
+    ProcessError(L"Expected ')'", TOKEN_CLOSED_PAREN);
+  }
+  NextToken();
+
+  return variable;
+}
+
 /****************************
  * Parses an 'each' statement
  ****************************/
@@ -195,6 +195,7 @@ class Parser {
   For* ParseFor(int depth);
   For* ParseEach(int depth);
   CriticalSection* ParseCritical(int depth);
+  Variable* ParseSystemVariable(int depth);
   For* ParseEach(bool reverse, int depth);
   Return* ParseReturn(int depth);
   Leaving* ParseLeaving(int depth);
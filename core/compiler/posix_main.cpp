@@ -60,6 +60,7 @@ int main(int argc, char* argv[])
   usage += L"  -alt:    [optional] use alternative C like syntax\n";
   usage += L"  -debug:  [optional] compile with debug symbols\n";
   usage += L"  -strict: [input] exclude default system libraries and specify them manually\n";
+  usage += L"  -incremental: [optional] reuse the target if no source, library or option changed since the last build, any change recompiles every source\n";
   usage += L"\nExample: \"obc hello.obs\"\n\nVersion: ";
   usage += VERSION_STRING;
   
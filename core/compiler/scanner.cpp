@@ -199,6 +199,7 @@ void Scanner::LoadKeywords()
   ident_map[L"NEG_INF_FLOAT"] = NEG_INF_FLOAT;
   ident_map[L"LOAD_CLS_INST_ID"] = LOAD_CLS_INST_ID;
   ident_map[L"STRING_HASH_ID"] = STRING_HASH_ID;
+  ident_map[L"STRING_COMPARE"] = STRING_COMPARE;
   ident_map[L"LOAD_CLS_BY_INST"] = LOAD_CLS_BY_INST;
   ident_map[L"LOAD_NEW_OBJ_INST"] = LOAD_NEW_OBJ_INST;
   ident_map[L"LOAD_INST_UID"] = LOAD_INST_UID;
@@ -334,6 +335,7 @@ void Scanner::LoadKeywords()
   ident_map[L"TIMER_START"] = TIMER_START;
   ident_map[L"TIMER_END"] =  TIMER_END;
   ident_map[L"TIMER_ELAPSED"] =  TIMER_ELAPSED;
+  ident_map[L"TIMER_TICKS"] = TIMER_TICKS;
   ident_map[L"SOCK_TCP_CONNECT"] = SOCK_TCP_CONNECT;
   ident_map[L"SOCK_TCP_IS_CONNECTED"] = SOCK_TCP_IS_CONNECTED;
   ident_map[L"SOCK_TCP_BIND"] = SOCK_TCP_BIND;
@@ -354,6 +356,7 @@ void Scanner::LoadKeywords()
   ident_map[L"SOCK_TCP_OUT_BYTE"] = SOCK_TCP_OUT_BYTE;
   ident_map[L"SOCK_TCP_OUT_BYTE_ARY"] = SOCK_TCP_OUT_BYTE_ARY;
   ident_map[L"SOCK_TCP_OUT_CHAR_ARY"] = SOCK_TCP_OUT_CHAR_ARY;
+  ident_map[L"SOCK_TCP_FLUSH"] = SOCK_TCP_FLUSH;
   ident_map[L"SOCK_TCP_HOST_NAME"] = SOCK_TCP_HOST_NAME;
   ident_map[L"SOCK_TCP_RESOLVE_NAME"] = SOCK_TCP_RESOLVE_NAME;
   ident_map[L"SOCK_TCP_SSL_CONNECT"] = SOCK_TCP_SSL_CONNECT;
@@ -368,6 +371,61 @@ void Scanner::LoadKeywords()
   ident_map[L"SOCK_TCP_SSL_OUT_BYTE"] = SOCK_TCP_SSL_OUT_BYTE;
   ident_map[L"SOCK_TCP_SSL_OUT_BYTE_ARY"] = SOCK_TCP_SSL_OUT_BYTE_ARY;
   ident_map[L"SOCK_TCP_SSL_OUT_CHAR_ARY"] = SOCK_TCP_SSL_OUT_CHAR_ARY;
+  ident_map[L"SOCK_TCP_SSL_FLUSH"] = SOCK_TCP_SSL_FLUSH;
+  ident_map[L"SOCK_TCP_SET_BLOCKING"] = SOCK_TCP_SET_BLOCKING;
+  ident_map[L"SOCK_POLL_CREATE"] = SOCK_POLL_CREATE;
+  ident_map[L"SOCK_POLL_ADD"] = SOCK_POLL_ADD;
+  ident_map[L"SOCK_POLL_REMOVE"] = SOCK_POLL_REMOVE;
+  ident_map[L"SOCK_POLL_WAIT"] = SOCK_POLL_WAIT;
+  ident_map[L"SOCK_POLL_CLOSE"] = SOCK_POLL_CLOSE;
+  ident_map[L"EXECUTOR_SUBMIT"] = EXECUTOR_SUBMIT;
+  ident_map[L"EXECUTOR_SIZE"] = EXECUTOR_SIZE;
+  ident_map[L"EXECUTOR_WAIT"] = EXECUTOR_WAIT;
+  ident_map[L"EXECUTOR_NOTIFY"] = EXECUTOR_NOTIFY;
+  ident_map[L"ATOMIC_LOAD"] = ATOMIC_LOAD;
+  ident_map[L"ATOMIC_STORE"] = ATOMIC_STORE;
+  ident_map[L"ATOMIC_ADD"] = ATOMIC_ADD;
+  ident_map[L"ATOMIC_SWAP"] = ATOMIC_SWAP;
+  ident_map[L"ATOMIC_CAS"] = ATOMIC_CAS;
+  ident_map[L"ATOMIC_ARY_LOAD"] = ATOMIC_ARY_LOAD;
+  ident_map[L"ATOMIC_ARY_STORE"] = ATOMIC_ARY_STORE;
+  ident_map[L"ATOMIC_ARY_ADD"] = ATOMIC_ARY_ADD;
+  ident_map[L"ATOMIC_ARY_SWAP"] = ATOMIC_ARY_SWAP;
+  ident_map[L"ATOMIC_ARY_CAS"] = ATOMIC_ARY_CAS;
+  ident_map[L"COND_VAR_INIT"] = COND_VAR_INIT;
+  ident_map[L"COND_VAR_WAIT"] = COND_VAR_WAIT;
+  ident_map[L"COND_VAR_SIGNAL"] = COND_VAR_SIGNAL;
+  ident_map[L"COND_VAR_BROADCAST"] = COND_VAR_BROADCAST;
+  ident_map[L"SEMAPHORE_INIT"] = SEMAPHORE_INIT;
+  ident_map[L"SEMAPHORE_ACQUIRE"] = SEMAPHORE_ACQUIRE;
+  ident_map[L"SEMAPHORE_TRY_ACQUIRE"] = SEMAPHORE_TRY_ACQUIRE;
+  ident_map[L"SEMAPHORE_RELEASE"] = SEMAPHORE_RELEASE;
+  ident_map[L"RW_LOCK_INIT"] = RW_LOCK_INIT;
+  ident_map[L"RW_LOCK_READ"] = RW_LOCK_READ;
+  ident_map[L"RW_UNLOCK_READ"] = RW_UNLOCK_READ;
+  ident_map[L"RW_LOCK_WRITE"] = RW_LOCK_WRITE;
+  ident_map[L"RW_UNLOCK_WRITE"] = RW_UNLOCK_WRITE;
+  ident_map[L"PARALLEL_SORT_INT"] = PARALLEL_SORT_INT;
+  ident_map[L"PARALLEL_SORT_FLOAT"] = PARALLEL_SORT_FLOAT;
+  ident_map[L"PARALLEL_SCAN_INT"] = PARALLEL_SCAN_INT;
+  ident_map[L"PARALLEL_SCAN_FLOAT"] = PARALLEL_SCAN_FLOAT;
+  ident_map[L"MAPPED_FILE_OPEN"] = MAPPED_FILE_OPEN;
+  ident_map[L"MAPPED_FILE_CLOSE"] = MAPPED_FILE_CLOSE;
+  ident_map[L"MAPPED_FILE_IN_BYTE"] = MAPPED_FILE_IN_BYTE;
+  ident_map[L"MAPPED_FILE_IN_BYTE_ARY"] = MAPPED_FILE_IN_BYTE_ARY;
+  ident_map[L"MAPPED_FILE_FIND_BYTE"] = MAPPED_FILE_FIND_BYTE;
+  ident_map[L"MAPPED_FILE_IN_LINE"] = MAPPED_FILE_IN_LINE;
+  ident_map[L"MAPPED_FILE_IN_STRING"] = MAPPED_FILE_IN_STRING;
+  ident_map[L"JSON_TAPE_INDEX"] = JSON_TAPE_INDEX;
+  ident_map[L"BYTES_TO_STRING"] = BYTES_TO_STRING;
+  ident_map[L"REGEX_EXECUTE"] = REGEX_EXECUTE;
+  ident_map[L"CSV_INDEX"] = CSV_INDEX;
+  ident_map[L"CSV_INTS"] = CSV_INTS;
+  ident_map[L"CSV_FLOATS"] = CSV_FLOATS;
+  ident_map[L"XML_INDEX"] = XML_INDEX;
+  ident_map[L"XML_DECODE"] = XML_DECODE;
+  ident_map[L"STRING_UTF8_ENCODE"] = STRING_UTF8_ENCODE;
+  ident_map[L"SOCK_TCP_SET_DEADLINE"] = SOCK_TCP_SET_DEADLINE;
   ident_map[L"SERL_INT"] = SERL_INT;
   ident_map[L"SERL_FLOAT"] = SERL_FLOAT;
   ident_map[L"SERL_OBJ_INST"] = SERL_OBJ_INST;
@@ -499,6 +557,7 @@ void Scanner::CheckIdentifier(int index)
     case RAND_FLOAT:
     case LOAD_CLS_INST_ID:
     case STRING_HASH_ID:
+    case STRING_COMPARE:
     case LOAD_CLS_BY_INST:
     case LOAD_NEW_OBJ_INST:
     case LOAD_INST_UID:
@@ -629,6 +688,7 @@ void Scanner::CheckIdentifier(int index)
     case TIMER_START:
     case TIMER_END:
     case TIMER_ELAPSED:
+    case TIMER_TICKS:
     case SOCK_TCP_CONNECT:
     case SOCK_TCP_BIND:
     case SOCK_TCP_SSL_LISTEN:
@@ -649,6 +709,7 @@ void Scanner::CheckIdentifier(int index)
     case SOCK_TCP_OUT_BYTE:
     case SOCK_TCP_OUT_BYTE_ARY:
     case SOCK_TCP_OUT_CHAR_ARY:
+    case SOCK_TCP_FLUSH:
     case SOCK_TCP_HOST_NAME:
     case SOCK_TCP_RESOLVE_NAME:
     case SOCK_TCP_SSL_CONNECT:
@@ -663,6 +724,61 @@ void Scanner::CheckIdentifier(int index)
     case SOCK_TCP_SSL_OUT_BYTE:
     case SOCK_TCP_SSL_OUT_BYTE_ARY:
     case SOCK_TCP_SSL_OUT_CHAR_ARY:
+    case SOCK_TCP_SSL_FLUSH:
+    case SOCK_TCP_SET_BLOCKING:
+    case SOCK_POLL_CREATE:
+    case SOCK_POLL_ADD:
+    case SOCK_POLL_REMOVE:
+    case SOCK_POLL_WAIT:
+    case SOCK_POLL_CLOSE:
+    case EXECUTOR_SUBMIT:
+    case EXECUTOR_SIZE:
+    case EXECUTOR_WAIT:
+    case EXECUTOR_NOTIFY:
+    case ATOMIC_LOAD:
+    case ATOMIC_STORE:
+    case ATOMIC_ADD:
+    case ATOMIC_SWAP:
+    case ATOMIC_CAS:
+    case ATOMIC_ARY_LOAD:
+    case ATOMIC_ARY_STORE:
+    case ATOMIC_ARY_ADD:
+    case ATOMIC_ARY_SWAP:
+    case ATOMIC_ARY_CAS:
+    case COND_VAR_INIT:
+    case COND_VAR_WAIT:
+    case COND_VAR_SIGNAL:
+    case COND_VAR_BROADCAST:
+    case SEMAPHORE_INIT:
+    case SEMAPHORE_ACQUIRE:
+    case SEMAPHORE_TRY_ACQUIRE:
+    case SEMAPHORE_RELEASE:
+    case RW_LOCK_INIT:
+    case RW_LOCK_READ:
+    case RW_UNLOCK_READ:
+    case RW_LOCK_WRITE:
+    case RW_UNLOCK_WRITE:
+    case PARALLEL_SORT_INT:
+    case PARALLEL_SORT_FLOAT:
+    case PARALLEL_SCAN_INT:
+    case PARALLEL_SCAN_FLOAT:
+    case MAPPED_FILE_OPEN:
+    case MAPPED_FILE_CLOSE:
+    case MAPPED_FILE_IN_BYTE:
+    case MAPPED_FILE_IN_BYTE_ARY:
+    case MAPPED_FILE_FIND_BYTE:
+    case MAPPED_FILE_IN_LINE:
+    case MAPPED_FILE_IN_STRING:
+    case JSON_TAPE_INDEX:
+    case BYTES_TO_STRING:
+    case REGEX_EXECUTE:
+    case CSV_INDEX:
+    case CSV_INTS:
+    case CSV_FLOATS:
+    case XML_INDEX:
+    case XML_DECODE:
+    case STRING_UTF8_ENCODE:
+    case SOCK_TCP_SET_DEADLINE:
     case SERL_INT:
     case SERL_FLOAT:
     case SERL_OBJ_INST:
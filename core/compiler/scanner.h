@@ -199,6 +199,7 @@ enum ScannerTokenType {
   RAND_FLOAT,
   LOAD_CLS_INST_ID,
   STRING_HASH_ID,
+  STRING_COMPARE,
   LOAD_CLS_BY_INST,
   LOAD_NEW_OBJ_INST,
   LOAD_INST_UID,
@@ -333,6 +334,7 @@ enum ScannerTokenType {
   SOCK_TCP_OUT_BYTE_ARY,
   SOCK_TCP_OUT_CHAR_ARY,
   SOCK_TCP_OUT_STRING,
+  SOCK_TCP_FLUSH,
   SOCK_TCP_HOST_NAME,
   SOCK_TCP_RESOLVE_NAME,
   // secure socket operations
@@ -350,6 +352,63 @@ enum ScannerTokenType {
   SOCK_TCP_SSL_OUT_BYTE_ARY,
   SOCK_TCP_SSL_OUT_CHAR_ARY,
   SOCK_TCP_SSL_OUT_STRING,
+  SOCK_TCP_SSL_FLUSH,
+  // socket polling
+  SOCK_TCP_SET_BLOCKING,
+  SOCK_POLL_CREATE,
+  SOCK_POLL_ADD,
+  SOCK_POLL_REMOVE,
+  SOCK_POLL_WAIT,
+  SOCK_POLL_CLOSE,
+  // task executor
+  EXECUTOR_SUBMIT,
+  EXECUTOR_SIZE,
+  EXECUTOR_WAIT,
+  EXECUTOR_NOTIFY,
+  ATOMIC_LOAD,
+  ATOMIC_STORE,
+  ATOMIC_ADD,
+  ATOMIC_SWAP,
+  ATOMIC_CAS,
+  ATOMIC_ARY_LOAD,
+  ATOMIC_ARY_STORE,
+  ATOMIC_ARY_ADD,
+  ATOMIC_ARY_SWAP,
+  ATOMIC_ARY_CAS,
+  COND_VAR_INIT,
+  COND_VAR_WAIT,
+  COND_VAR_SIGNAL,
+  COND_VAR_BROADCAST,
+  SEMAPHORE_INIT,
+  SEMAPHORE_ACQUIRE,
+  SEMAPHORE_TRY_ACQUIRE,
+  SEMAPHORE_RELEASE,
+  RW_LOCK_INIT,
+  RW_LOCK_READ,
+  RW_UNLOCK_READ,
+  RW_LOCK_WRITE,
+  RW_UNLOCK_WRITE,
+  PARALLEL_SORT_INT,
+  PARALLEL_SORT_FLOAT,
+  PARALLEL_SCAN_INT,
+  PARALLEL_SCAN_FLOAT,
+  MAPPED_FILE_OPEN,
+  MAPPED_FILE_CLOSE,
+  MAPPED_FILE_IN_BYTE,
+  MAPPED_FILE_IN_BYTE_ARY,
+  MAPPED_FILE_FIND_BYTE,
+  MAPPED_FILE_IN_LINE,
+  MAPPED_FILE_IN_STRING,
+  JSON_TAPE_INDEX,
+  BYTES_TO_STRING,
+  REGEX_EXECUTE,
+  CSV_INDEX,
+  CSV_INTS,
+  CSV_FLOATS,
+  XML_INDEX,
+  XML_DECODE,
+  STRING_UTF8_ENCODE,
+  SOCK_TCP_SET_DEADLINE,
   // serialization
   SERL_CHAR,
   SERL_INT,
@@ -402,6 +461,7 @@ enum ScannerTokenType {
   TIMER_START,
   TIMER_END,
   TIMER_ELAPSED,
+  TIMER_TICKS,
   // platform
   GET_PLTFRM,
   GET_VERSION,
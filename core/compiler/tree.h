@@ -1792,10 +1792,12 @@ namespace frontend {
   class SystemStatement : public Statement {
     friend class TreeFactory;
     int id;
+    Variable* variable;
 
     SystemStatement(const std::wstring& file_name, const int line_num, const int line_pos, 
                     const int end_line_num, const int end_line_pos, int i) : Statement(file_name, line_num, line_pos, end_line_num, end_line_pos) {
       id = i;
+      variable = nullptr;
     }
 
     ~SystemStatement() {
@@ -1809,6 +1811,15 @@ namespace frontend {
     int GetId() {
       return id;
     }
+
+    // instance variable operated on by field atomics
+    Variable* GetVariable() {
+      return variable;
+    }
+
+    void SetVariable(Variable* v) {
+      variable = v;
+    }
   };
 
   /****************************
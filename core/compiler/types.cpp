@@ -125,6 +125,8 @@ std::vector<frontend::Type*> TypeParser::ParseParameters(const std::wstring& par
     // set generics
     if(index < param_str.size() && param_str[index] == L'<') {
       type->SetGenerics(ParseGenerics(index, param_str));
+      // skip closing '>', dimensions follow generics
+      index++;
     }
 
     // set dimension
@@ -164,6 +166,7 @@ std::vector<frontend::Type*> TypeParser::ParseGenerics(size_t &index, const std:
 
     if(index < generic_str.size() && generic_str[index] == L'<') {
       type->SetGenerics(ParseGenerics(index, generic_str));
+      index++;
     }
     generic_types.push_back(type);
   } 
@@ -250,6 +253,7 @@ frontend::Type* TypeParser::ParseType(const std::wstring& type_name)
   // set generics
   if(index < type_name.size() && type_name[index] == L'<') {
     type->SetGenerics(ParseGenerics(index, type_name));
+    index++;
   }
 
   // set dimension
@@ -190,7 +190,12 @@ namespace instructions {
     LIB_OBJ_INST_CAST,
     LIB_FUNC_DEF,
     // system directives
-    END_STMTS
+    END_STMTS,
+    // superinstructions, emitted by the optimizer
+    INC_LOCL_INT_VAR,
+    LOAD_LOCL_INT_VARS,
+    // receiver check for devirtualized calls, emitted by the optimizer
+    CHK_OBJ_INST
   };
 
   // memory reference context, used for
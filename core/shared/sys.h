@@ -36,8 +36,18 @@
 #include <stdint.h>
 #include <fcntl.h>
 #include <io.h>
-#elif defined(_ARM64)
-#include <codecvt>
+#endif
+
+// vector extensions for the UTF-8 codec
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define UTF8_AVX2
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define UTF8_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define UTF8_NEON
 #endif
 
 #include <math.h>
@@ -47,6 +57,7 @@
 #include <fstream>
 #include <string>
 #include <vector>
+#include <algorithm>
 #include <map>
 
 #include "logger.h"
@@ -113,157 +124,399 @@ static size_t HashString(const wchar_t* char_ary) {
 
 
 /**
- * Converts UTF-8 bytes a 
- * Unicode string 
+ * Decodes the next UTF-8 sequence, each invalid or 
+ * truncated sequence (maximal subpart) becomes one U+FFFD
  */
-static bool BytesToUnicode(const std::string &in, std::wstring &out) {    
-#ifdef _WIN32
-  // allocate space
-  const int wsize = MultiByteToWideChar(CP_UTF8, 0, in.c_str(), -1, nullptr, 0);
-  if(wsize == 0) {
-    return false;
+static uint32_t Utf8Next(const unsigned char* in, size_t size, size_t &pos) {
+  const uint32_t lead = in[pos++];
+  if(lead < 0x80) {
+    return lead;
   }
-  wchar_t* buffer = new wchar_t[wsize];
 
-  // convert
-  const int check = MultiByteToWideChar(CP_UTF8, 0, in.c_str(), -1, buffer, wsize);
-  if(check == 0) {
-    delete[] buffer;
-    buffer = nullptr;
-    return false;
+  // the second byte range rules out overlong forms, surrogates and values past U+10FFFF
+  size_t count;
+  uint32_t code;
+  unsigned char low = 0x80;
+  unsigned char high = 0xbf;
+  if(lead >= 0xc2 && lead <= 0xdf) {
+    count = 1; code = lead & 0x1f;
   }
-  
-  // create string
-  out.append(buffer, static_cast<std::basic_string<wchar_t, std::char_traits<wchar_t>, std::allocator<wchar_t>>::size_type>(wsize) - 1);
-
-  // clean up
-  delete[] buffer;
-  buffer = nullptr;  
-#else
-  // allocate space
-  size_t size = mbstowcs(nullptr, in.c_str(), in.size());
-  if(size == (size_t)-1) {
-    return false;
+  else if(lead >= 0xe0 && lead <= 0xef) {
+    count = 2; code = lead & 0x0f;
+    if(lead == 0xe0) {
+      low = 0xa0;
+    }
+    else if(lead == 0xed) {
+      high = 0x9f;
+    }
+  }
+  else if(lead >= 0xf0 && lead <= 0xf4) {
+    count = 3; code = lead & 0x07;
+    if(lead == 0xf0) {
+      low = 0x90;
+    }
+    else if(lead == 0xf4) {
+      high = 0x8f;
+    }
+  }
+  else {
+    return 0xfffd;
   }
-  wchar_t* buffer = new wchar_t[size + 1];
 
-  // convert
-  size_t check = mbstowcs(buffer, in.c_str(), in.size());
-  if(check == (size_t)-1) {
-    delete[] buffer;
-    buffer = nullptr;
-    return false;
+  for(size_t i = 0; i < count; ++i, ++pos) {
+    if(pos >= size || in[pos] < low || in[pos] > high) {
+      return 0xfffd;
+    }
+    code = (code << 6) | (in[pos] & 0x3f);
+    low = 0x80;
+    high = 0xbf;
   }
-  buffer[size] = L'\0';
 
-  // create string
-  out.append(buffer, size);
+  return code;
+}
 
-  // clean up
-  delete[] buffer;
-  buffer = nullptr;
+/**
+ * True if the 8 bytes at 'in' are all ASCII
+ */
+static inline bool Utf8IsAscii(const unsigned char* in) {
+  uint64_t word;
+  memcpy(&word, in, sizeof(word));
+  return !(word & 0x8080808080808080ULL);
+}
+
+/**
+ * Number of leading ASCII bytes
+ */
+static size_t Utf8AsciiRun(const unsigned char* in, size_t size) {
+  size_t pos = 0;
+#if defined(UTF8_AVX2)
+  for(; pos + 32 <= size; pos += 32) {
+    if(_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i*)(in + pos)))) {
+      break;
+    }
+  }
+#elif defined(UTF8_SSE2)
+  for(; pos + 16 <= size; pos += 16) {
+    if(_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(in + pos)))) {
+      break;
+    }
+  }
+#elif defined(UTF8_NEON)
+  for(; pos + 16 <= size; pos += 16) {
+    if(vmaxvq_u8(vld1q_u8(in + pos)) & 0x80) {
+      break;
+    }
+  }
 #endif
+  for(; pos + 8 <= size && Utf8IsAscii(in + pos); pos += 8);
+  for(; pos < size && in[pos] < 0x80; ++pos);
 
-  return true;
+  return pos;
 }
 
-static std::wstring BytesToUnicode(const std::string &in) {
-  std::wstring out;
-  if(BytesToUnicode(in, out)) {
-    return out;
+/**
+ * Widens leading ASCII bytes into 'out', returns
+ * the number of characters written
+ */
+static size_t Utf8WidenAscii(const unsigned char* in, size_t size, wchar_t* out) {
+  size_t pos = 0;
+#if defined(UTF8_AVX2)
+  for(; pos + 32 <= size; pos += 32) {
+    const __m256i block = _mm256_loadu_si256((const __m256i*)(in + pos));
+    if(_mm256_movemask_epi8(block)) {
+      break;
+    }
+
+    if(sizeof(wchar_t) == 2) {
+      _mm256_storeu_si256((__m256i*)(out + pos), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(block)));
+      _mm256_storeu_si256((__m256i*)(out + pos + 16), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(block, 1)));
+    }
+    else {
+      for(size_t i = 0; i < 32; i += 8) {
+        const __m128i bytes = _mm_loadl_epi64((const __m128i*)(in + pos + i));
+        _mm256_storeu_si256((__m256i*)(out + pos + i), _mm256_cvtepu8_epi32(bytes));
+      }
+    }
   }
+#elif defined(UTF8_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  for(; pos + 16 <= size; pos += 16) {
+    const __m128i block = _mm_loadu_si128((const __m128i*)(in + pos));
+    if(_mm_movemask_epi8(block)) {
+      break;
+    }
 
-  return L"";
+    const __m128i low = _mm_unpacklo_epi8(block, zero);
+    const __m128i high = _mm_unpackhi_epi8(block, zero);
+    if(sizeof(wchar_t) == 2) {
+      _mm_storeu_si128((__m128i*)(out + pos), low);
+      _mm_storeu_si128((__m128i*)(out + pos + 8), high);
+    }
+    else {
+      _mm_storeu_si128((__m128i*)(out + pos), _mm_unpacklo_epi16(low, zero));
+      _mm_storeu_si128((__m128i*)(out + pos + 4), _mm_unpackhi_epi16(low, zero));
+      _mm_storeu_si128((__m128i*)(out + pos + 8), _mm_unpacklo_epi16(high, zero));
+      _mm_storeu_si128((__m128i*)(out + pos + 12), _mm_unpackhi_epi16(high, zero));
+    }
+  }
+#elif defined(UTF8_NEON)
+  for(; pos + 16 <= size; pos += 16) {
+    const uint8x16_t block = vld1q_u8(in + pos);
+    if(vmaxvq_u8(block) & 0x80) {
+      break;
+    }
+
+    const uint16x8_t low = vmovl_u8(vget_low_u8(block));
+    const uint16x8_t high = vmovl_high_u8(block);
+    if(sizeof(wchar_t) == 2) {
+      vst1q_u16((uint16_t*)(out + pos), low);
+      vst1q_u16((uint16_t*)(out + pos + 8), high);
+    }
+    else {
+      vst1q_u32((uint32_t*)(out + pos), vmovl_u16(vget_low_u16(low)));
+      vst1q_u32((uint32_t*)(out + pos + 4), vmovl_high_u16(low));
+      vst1q_u32((uint32_t*)(out + pos + 8), vmovl_u16(vget_low_u16(high)));
+      vst1q_u32((uint32_t*)(out + pos + 12), vmovl_high_u16(high));
+    }
+  }
+#endif
+  for(; pos < size && in[pos] < 0x80; ++pos) {
+    out[pos] = in[pos];
+  }
+
+  return pos;
 }
 
 /**
- * Converts UTF-8 bytes to a Unicode character
+ * Narrows leading ASCII characters into 'out', returns
+ * the number of bytes written
  */
-static bool BytesToCharacter(const std::string &in, wchar_t &out) {
-  std::wstring buffer;
-  if(!BytesToUnicode(in, buffer)) {
-    return false;
+static size_t Utf8NarrowAscii(const wchar_t* in, size_t size, char* out) {
+  size_t pos = 0;
+#if defined(UTF8_AVX2) || defined(UTF8_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  if(sizeof(wchar_t) == 2) {
+    const __m128i mask = _mm_set1_epi16((short)0xff80);
+    for(; pos + 8 <= size; pos += 8) {
+      const __m128i block = _mm_loadu_si128((const __m128i*)(in + pos));
+      if(_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(block, mask), zero)) != 0xffff) {
+        break;
+      }
+      _mm_storel_epi64((__m128i*)(out + pos), _mm_packus_epi16(block, block));
+    }
   }
-  
-  if(buffer.size() != 1) {
-#if defined(_ARM64) && defined(_OSX)
-    std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t> cvt;
-    buffer = cvt.from_bytes(in);
-    if(buffer.size() != 1) {
-      return false;
+  else {
+    const __m128i mask = _mm_set1_epi32((int)0xffffff80);
+    for(; pos + 8 <= size; pos += 8) {
+      const __m128i low = _mm_loadu_si128((const __m128i*)(in + pos));
+      const __m128i high = _mm_loadu_si128((const __m128i*)(in + pos + 4));
+      if(_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(_mm_or_si128(low, high), mask), zero)) != 0xffff) {
+        break;
+      }
+      const __m128i words = _mm_packs_epi32(low, high);
+      _mm_storel_epi64((__m128i*)(out + pos), _mm_packus_epi16(words, words));
     }
-    
-    out = buffer[0];
-    return true;
-#else
-    return false;
+  }
+#elif defined(UTF8_NEON)
+  if(sizeof(wchar_t) == 2) {
+    for(; pos + 8 <= size; pos += 8) {
+      const uint16x8_t block = vld1q_u16((const uint16_t*)(in + pos));
+      if(vmaxvq_u16(block) >= 0x80) {
+        break;
+      }
+      vst1_u8((uint8_t*)(out + pos), vmovn_u16(block));
+    }
+  }
+  else {
+    for(; pos + 8 <= size; pos += 8) {
+      const uint32x4_t low = vld1q_u32((const uint32_t*)(in + pos));
+      const uint32x4_t high = vld1q_u32((const uint32_t*)(in + pos + 4));
+      if(vmaxvq_u32(vorrq_u32(low, high)) >= 0x80) {
+        break;
+      }
+      vst1_u8((uint8_t*)(out + pos), vmovn_u16(vcombine_u16(vmovn_u32(low), vmovn_u32(high))));
+    }
+  }
 #endif
+  for(; pos < size && (uint32_t)in[pos] < 0x80; ++pos) {
+    out[pos] = (char)in[pos];
   }
-  
-  out = buffer[0];  
-  return true;
+
+  return pos;
 }
 
 /**
- * Converts a Unicode character to UTF-8 bytes
+ * Number of characters UTF-8 bytes decode to
  */
-static bool UnicodeToBytes(const std::wstring &in, std::string &out) {
-#ifdef _WIN32
-  // allocate space
-  const int size = WideCharToMultiByte(CP_UTF8, 0, in.c_str(), -1, nullptr, 0, nullptr, nullptr);
-  if(size == 0) {
-    return false;
+static size_t Utf8Length(const char* bytes, size_t size) {
+  const unsigned char* in = (const unsigned char*)bytes;
+  size_t length = 0;
+  size_t pos = 0;
+  while(pos < size) {
+    const size_t run = Utf8AsciiRun(in + pos, size - pos);
+    pos += run;
+    length += run;
+
+    if(pos < size) {
+      const uint32_t code = Utf8Next(in, size, pos);
+      length += sizeof(wchar_t) == 2 && code > 0xffff ? 2 : 1;
+    }
   }
-  char* buffer = new char[size];
-  
-  // convert string
-  const int check = WideCharToMultiByte(CP_UTF8, 0, in.c_str(), -1, buffer, size, nullptr, nullptr);
-  if(check == 0) {
-    delete[] buffer;
-    buffer = nullptr;
-    return false;
+
+  return length;
+}
+
+/**
+ * Decodes UTF-8 bytes into at most 'capacity' characters,
+ * returns the number of characters written
+ */
+static size_t Utf8Decode(const char* bytes, size_t size, wchar_t* out, size_t capacity) {
+  const unsigned char* in = (const unsigned char*)bytes;
+  size_t length = 0;
+  size_t pos = 0;
+  while(pos < size && length < capacity) {
+    const size_t run = Utf8WidenAscii(in + pos, std::min(size - pos, capacity - length), out + length);
+    pos += run;
+    length += run;
+
+    if(pos < size && length < capacity) {
+      size_t next = pos;
+      const uint32_t code = Utf8Next(in, size, next);
+      if(sizeof(wchar_t) == 2 && code > 0xffff) {
+        if(length + 2 > capacity) {
+          break;
+        }
+        out[length++] = (wchar_t)(0xd800 + ((code - 0x10000) >> 10));
+        out[length++] = (wchar_t)(0xdc00 + ((code - 0x10000) & 0x3ff));
+      }
+      else {
+        out[length++] = (wchar_t)code;
+      }
+      pos = next;
+    }
   }
-  
-  // append output
-  out.append(buffer, static_cast<std::basic_string<char, std::char_traits<char>, std::allocator<char>>::size_type>(size) - 1);
 
-  // clean up
-  delete[] buffer;
-  buffer = nullptr;
-#else
-  // convert string
-  size_t size = wcstombs(nullptr, in.c_str(), in.size());
-  if(size == (size_t)-1) {
-    return false;
+  return length;
+}
+
+static size_t Utf8Decode(const char* bytes, size_t size, wchar_t* out) {
+  return Utf8Decode(bytes, size, out, (size_t)-1);
+}
+
+/**
+ * Next code point of a wide string, UTF-16 surrogate
+ * pairs are joined and lone surrogates become U+FFFD
+ */
+static inline uint32_t Utf8NextWide(const wchar_t* in, size_t size, size_t &pos) {
+  const uint32_t code = (uint32_t)in[pos++];
+  if(code >= 0xd800 && code <= 0xdfff) {
+    if(sizeof(wchar_t) == 2 && code <= 0xdbff && pos < size) {
+      const uint32_t low = (uint32_t)in[pos];
+      if(low >= 0xdc00 && low <= 0xdfff) {
+        ++pos;
+        return 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+      }
+    }
+    return 0xfffd;
   }
-  char* buffer = new char[size + 1];
-  
-  size_t check = wcstombs(buffer, in.c_str(), size);
-  if(check == (size_t)-1) {
-    delete[] buffer;
-    buffer = nullptr;
+
+  return code > 0x10ffff ? 0xfffd : code;
+}
+
+/**
+ * Number of bytes a wide string encodes to
+ */
+static size_t Utf8EncodedLength(const wchar_t* in, size_t size) {
+  size_t length = 0;
+  size_t pos = 0;
+  while(pos < size) {
+    const uint32_t code = Utf8NextWide(in, size, pos);
+    length += code < 0x80 ? 1 : code < 0x800 ? 2 : code < 0x10000 ? 3 : 4;
+  }
+
+  return length;
+}
+
+/**
+ * Encodes a wide string into a buffer sized with
+ * 'Utf8EncodedLength', returns the number of bytes written
+ */
+static size_t Utf8Encode(const wchar_t* in, size_t size, char* bytes) {
+  unsigned char* out = (unsigned char*)bytes;
+  size_t length = 0;
+  size_t pos = 0;
+  while(pos < size) {
+    const size_t run = Utf8NarrowAscii(in + pos, size - pos, (char*)out + length);
+    pos += run;
+    length += run;
+
+    if(pos < size) {
+      const uint32_t code = Utf8NextWide(in, size, pos);
+      if(code < 0x800) {
+        out[length++] = (unsigned char)(0xc0 | (code >> 6));
+      }
+      else if(code < 0x10000) {
+        out[length++] = (unsigned char)(0xe0 | (code >> 12));
+        out[length++] = (unsigned char)(0x80 | ((code >> 6) & 0x3f));
+      }
+      else {
+        out[length++] = (unsigned char)(0xf0 | (code >> 18));
+        out[length++] = (unsigned char)(0x80 | ((code >> 12) & 0x3f));
+        out[length++] = (unsigned char)(0x80 | ((code >> 6) & 0x3f));
+      }
+      out[length++] = (unsigned char)(0x80 | (code & 0x3f));
+    }
+  }
+
+  return length;
+}
+
+/**
+ * Converts UTF-8 bytes a
+ * Unicode string
+ */
+static bool BytesToUnicode(const std::string &in, std::wstring &out) {
+  const size_t offset = out.size();
+  out.resize(offset + Utf8Length(in.c_str(), in.size()));
+  Utf8Decode(in.c_str(), in.size(), &out[offset]);
+
+  return true;
+}
+
+static std::wstring BytesToUnicode(const std::string &in) {
+  std::wstring out;
+  BytesToUnicode(in, out);
+  return out;
+}
+
+/**
+ * Converts UTF-8 bytes to a Unicode character
+ */
+static bool BytesToCharacter(const std::string &in, wchar_t &out) {
+  std::wstring buffer;
+  if(!BytesToUnicode(in, buffer) || buffer.size() != 1) {
     return false;
   }
-  buffer[size] = '\0';
-  
-  // create string      
-  out.append(buffer, size);
 
-  // clean up
-  delete[] buffer;
-  buffer = nullptr;
-#endif
-  
+  out = buffer[0];
+  return true;
+}
+
+/**
+ * Converts a Unicode character to UTF-8 bytes
+ */
+static bool UnicodeToBytes(const std::wstring &in, std::string &out) {
+  const size_t offset = out.size();
+  out.resize(offset + Utf8EncodedLength(in.c_str(), in.size()));
+  Utf8Encode(in.c_str(), in.size(), &out[offset]);
+
   return true;
 }
 
 static std::string UnicodeToBytes(const std::wstring &in) {
   std::string out;
-  if(UnicodeToBytes(in, out)) {
-    return out;
-  }
-
-  return "";
+  UnicodeToBytes(in, out);
+  return out;
 }
 
 /**
@@ -795,31 +1048,11 @@ static wchar_t* LoadFileBuffer(const std::wstring &filename, size_t& buffer_size
   }
 
   // convert Unicode
-#ifdef _WIN32
-  const int wsize = MultiByteToWideChar(CP_UTF8, 0, buffer, -1, nullptr, 0);
-  if(wsize == 0) {
-    return nullptr;;
-  }
-  wchar_t* wbuffer = new wchar_t[wsize];
-  const int check = MultiByteToWideChar(CP_UTF8, 0, buffer, -1, wbuffer, wsize);
-  if(check == 0) {
-    return nullptr;;
-  }
-#else
-  size_t wsize = mbstowcs(nullptr, buffer, buffer_size);
-  if(wsize == (size_t)-1) {
-    free(buffer);
-    return nullptr;;
-  }
+  const size_t wsize = Utf8Length(buffer, buffer_size);
   wchar_t* wbuffer = new wchar_t[wsize + 1];
-  size_t check = mbstowcs(wbuffer, buffer, buffer_size);
-  if(check == (size_t)-1) {
-    free(buffer);
-    delete[] wbuffer;
-    return nullptr;;
-  }
+  Utf8Decode(buffer, buffer_size, wbuffer);
   wbuffer[wsize] = L'\0';
-#endif
+  buffer_size = wsize;
 
   free(buffer);
   return wbuffer;
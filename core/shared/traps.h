@@ -230,6 +230,70 @@ namespace instructions {
     SYS_CMD,
     SYS_CMD_OUT,
     ASSERT_TRUE,
+    // socket buffering
+    SOCK_TCP_FLUSH,
+    SOCK_TCP_SSL_FLUSH,
+    // socket polling
+    SOCK_TCP_SET_BLOCKING,
+    SOCK_POLL_CREATE,
+    SOCK_POLL_ADD,
+    SOCK_POLL_REMOVE,
+    SOCK_POLL_WAIT,
+    SOCK_POLL_CLOSE,
+    // task executor
+    EXECUTOR_SUBMIT,
+    EXECUTOR_SIZE,
+    EXECUTOR_WAIT,
+    EXECUTOR_NOTIFY,
+    // atomics
+    ATOMIC_LOAD,
+    ATOMIC_STORE,
+    ATOMIC_ADD,
+    ATOMIC_SWAP,
+    ATOMIC_CAS,
+    ATOMIC_ARY_LOAD,
+    ATOMIC_ARY_STORE,
+    ATOMIC_ARY_ADD,
+    ATOMIC_ARY_SWAP,
+    ATOMIC_ARY_CAS,
+    // conditions, semaphores and reader-writer locks
+    COND_VAR_INIT,
+    COND_VAR_WAIT,
+    COND_VAR_SIGNAL,
+    COND_VAR_BROADCAST,
+    SEMAPHORE_INIT,
+    SEMAPHORE_ACQUIRE,
+    SEMAPHORE_TRY_ACQUIRE,
+    SEMAPHORE_RELEASE,
+    RW_LOCK_INIT,
+    RW_LOCK_READ,
+    RW_UNLOCK_READ,
+    RW_LOCK_WRITE,
+    RW_UNLOCK_WRITE,
+    // parallel array operations
+    PARALLEL_SORT_INT,
+    PARALLEL_SORT_FLOAT,
+    PARALLEL_SCAN_INT,
+    PARALLEL_SCAN_FLOAT,
+    MAPPED_FILE_OPEN,
+    MAPPED_FILE_CLOSE,
+    MAPPED_FILE_IN_BYTE,
+    MAPPED_FILE_IN_BYTE_ARY,
+    MAPPED_FILE_FIND_BYTE,
+    MAPPED_FILE_IN_LINE,
+    MAPPED_FILE_IN_STRING,
+    STRING_COMPARE,
+    TIMER_TICKS,
+    JSON_TAPE_INDEX,
+    BYTES_TO_STRING,
+    REGEX_EXECUTE,
+    CSV_INDEX,
+    CSV_INTS,
+    CSV_FLOATS,
+    XML_INDEX,
+    XML_DECODE,
+    STRING_UTF8_ENCODE,
+    SOCK_TCP_SET_DEADLINE,
     // end
     EXIT
   };
@@ -422,6 +422,24 @@ void JitAmd64::ProcessInstructions() {
 #endif
       ProcessCopy(instr);
       break;
+
+      // superinstructions
+    case INC_LOCL_INT_VAR:
+#ifdef _DEBUG_JIT
+      std::wcout << L"INC_LOCL_INT_VAR: id=" << instr->GetOperand() << L"; value=" << instr->GetOperand2()
+            << L"; regs=" << aval_regs.size() << L"," << aux_regs.size() << std::endl;
+#endif
+      add_imm_mem(instr->GetOperand2(), instr->GetOperand3(), RBP);
+      break;
+
+    case LOAD_LOCL_INT_VARS:
+#ifdef _DEBUG_JIT
+      std::wcout << L"LOAD_LOCL_INT_VARS: id=" << instr->GetOperand() << L"; id2=" << instr->GetOperand2()
+            << L"; regs=" << aval_regs.size() << L"," << aux_regs.size() << std::endl;
+#endif
+      working_stack.push_front(new RegInstr(MEM_INT, local_offsets[instr->GetOperand()]));
+      working_stack.push_front(new RegInstr(MEM_INT, local_offsets[instr->GetOperand2()]));
+      break;
       
       // mathematical
     case AND_INT:
@@ -869,6 +887,15 @@ void JitAmd64::ProcessInstructions() {
     }
       break;
 
+    case CHK_OBJ_INST: {
+#ifdef _DEBUG_JIT
+      std::wcout << L"CHK_OBJ_INST: regs=" << aval_regs.size() << L"," << aux_regs.size() << std::endl;
+#endif
+      ProcessStackCallback(CHK_OBJ_INST, instr, instr_index, 1);
+      ProcessReturnParameters(INT_TYPE);
+    }
+      break;
+
     case LOAD_ARY_SIZE: {
 #ifdef _DEBUG_JIT
       std::wcout << L"LOAD_ARY_SIZE: regs=" << aval_regs.size() << L"," << aux_regs.size() << std::endl;
@@ -1035,6 +1062,11 @@ void JitAmd64::ProcessJump(StackInstr* instr) {
     std::wcout << L"JMP: id=" << instr->GetOperand() << L", regs=" << aval_regs.size() 
           << L"," << aux_regs.size() << std::endl;
 #endif
+    // loops are safepoints
+    if(instr->GetOperand() < instr_index) {
+      ProcessSafepoint(instr);
+    }
+    
     if(instr->GetOperand2() < 0) {
       AddMachineCode(0xe9);
     }
@@ -1613,6 +1645,29 @@ void JitAmd64::ProcessCopy(StackInstr* instr) {
   }
 }
 
+void JitAmd64::ProcessSafepoint(StackInstr* instr) {
+  // test the collection flag
+  RegisterHolder* flag_holder = GetRegister();
+  move_imm_reg((size_t)MemoryManager::GetCollectingFlag(), flag_holder->GetRegister());
+  move_mem8_reg(0, flag_holder->GetRegister(), flag_holder->GetRegister());
+  cmp_imm_reg(0, flag_holder->GetRegister());
+  ReleaseRegister(flag_holder);
+
+#ifdef _DEBUG_JIT
+  std::wcout << L"  " << (++instr_count) << L": [je <skip>]" << std::endl;
+#endif
+  AddMachineCode(0x0f);
+  AddMachineCode(0x84);
+  const long skip_index = code_index;
+  AddImm(0);
+
+  // wait for the collection in the VM, live registers are saved by the callback
+  ProcessStackCallback(JMP, instr, instr_index, 0);
+
+  const long skip_offset = code_index - skip_index - 4;
+  memcpy(&code[skip_index], &skip_offset, 4);
+}
+
 void JitAmd64::ProcessStackCallback(long instr_id, StackInstr* instr, long &instr_index, long params) {
   long non_params;
   if(params < 0) {
@@ -2933,6 +2988,15 @@ RegisterHolder* JitAmd64::call_xfunc2(double(*func_ptr)(double, double), RegInst
 
 void JitAmd64::math_imm_reg(int64_t imm, Register reg, InstructionType type)
 {
+  // immediate operands are sign-extended 32-bit values, wider literals go through a register
+  if((imm < INT32_MIN || imm > INT32_MAX) && type != SHL_INT && type != SHR_INT) {
+    RegisterHolder* imm_holder = GetRegister();
+    move_imm_reg(imm, imm_holder->GetRegister());
+    math_reg_reg(imm_holder->GetRegister(), reg, type);
+    ReleaseRegister(imm_holder);
+    return;
+  }
+
   switch(type) {
   case AND_INT:
     and_imm_reg(imm, reg);
@@ -4002,12 +4066,12 @@ void JitAmd64::shl_mem_reg(long offset, Register src, Register dest)
 void JitAmd64::shr_imm_reg(int64_t value, Register dest) {
   AddMachineCode(B(dest));
   AddMachineCode(0xc1);
-  unsigned char code = 0xe8;
+  unsigned char code = 0xf8;
   RegisterEncode3(code, 5, dest);
   AddMachineCode(code);
   AddMachineCode((unsigned char)value);
 #ifdef _DEBUG_JIT
-  std::wcout << L"  " << (++instr_count) << L": [shrq $" << value << L", %" 
+  std::wcout << L"  " << (++instr_count) << L": [sarq $" << value << L", %" 
         << GetRegisterName(dest) << L"]" << std::endl;
 #endif
 }
@@ -4033,11 +4097,11 @@ void JitAmd64::shr_reg_reg(Register src, Register dest)
   AddMachineCode(0xd3);
   unsigned char code = 0xc0;
   // write value
-  RegisterEncode3(code, 2, RBP);
+  RegisterEncode3(code, 2, RDI);
   RegisterEncode3(code, 5, dest);
   AddMachineCode(code);
 #ifdef _DEBUG_JIT
-  std::wcout << L"  " << (++instr_count) << L": [shrq %" << GetRegisterName(RCX) 
+  std::wcout << L"  " << (++instr_count) << L": [sarq %" << GetRegisterName(RCX) 
         << L", %" << GetRegisterName(dest) << L"]" << std::endl;
 #endif
   
@@ -4930,9 +4994,15 @@ void JitAmd64::ProcessIndices()
     case LOAD_FLOAT_VAR:
     case STOR_FLOAT_VAR:
     case COPY_FLOAT_VAR:
+    case INC_LOCL_INT_VAR:
       values.insert(std::pair<long, StackInstr*>(instr->GetOperand(), instr));
       break;
 
+    case LOAD_LOCL_INT_VARS:
+      values.insert(std::pair<long, StackInstr*>(instr->GetOperand(), instr));
+      values.insert(std::pair<long, StackInstr*>(instr->GetOperand2(), instr));
+      break;
+
     default:
       break;
     }
@@ -4940,12 +5010,13 @@ void JitAmd64::ProcessIndices()
 
   long index = RED_ZONE;
   long last_id = -1;
+  local_offsets.clear();
   std::multimap<long, StackInstr*>::iterator value;
   for(value = values.begin(); value != values.end(); ++value) {
     long id = value->first;
     StackInstr* instr = value->second;
-    // instance reference
-    if(instr->GetOperand2() == INST || instr->GetOperand2() == CLS) {
+    // instance reference, note: INC_LOCL_INT_VAR holds a literal in operand2
+    if(instr->GetType() != INC_LOCL_INT_VAR && (instr->GetOperand2() == INST || instr->GetOperand2() == CLS)) {
       instr->SetOperand3(instr->GetOperand() * sizeof(size_t));
     }
     // local reference
@@ -4960,6 +5031,8 @@ void JitAmd64::ProcessIndices()
         case STOR_CLS_INST_INT_VAR:
         case COPY_LOCL_INT_VAR:
         case COPY_CLS_INST_INT_VAR:
+        case INC_LOCL_INT_VAR:
+        case LOAD_LOCL_INT_VARS:
           index -= sizeof(size_t);
           break;
 
@@ -4974,6 +5047,7 @@ void JitAmd64::ProcessIndices()
         }
       }
       instr->SetOperand3(index);
+      local_offsets[id] = index;
       last_id = id;
     }
 #ifdef _DEBUG_JIT
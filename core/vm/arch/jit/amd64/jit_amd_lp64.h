@@ -192,6 +192,8 @@ namespace Runtime {
     RegInstr(RegType t, int64_t o) {
       type = t;
       operand = o;
+      holder = nullptr;
+      instr = nullptr;
     }
 
     RegInstr(StackInstr* si);
@@ -324,6 +326,7 @@ namespace Runtime {
     std::vector<RegisterHolder*> aval_xregs;
     std::list<RegisterHolder*> used_xregs;
     std::unordered_map<long, StackInstr*> jump_table; // jump addresses
+    std::unordered_map<long, long> local_offsets;    // local id to stack offset
     std::vector<long> nil_deref_offsets;      // code -1
     std::vector<long> bounds_less_offsets;    // code -2
     std::vector<long> bounds_greater_offsets; // code -3
@@ -376,6 +379,7 @@ namespace Runtime {
     void ProcessLoadFloatElement(StackInstr* instr);
     void ProcessStoreFloatElement(StackInstr* instr);
     void ProcessJump(StackInstr* instr);
+    void ProcessSafepoint(StackInstr* instr);
     void ProcessFloor(StackInstr* instr);
     void ProcessCeiling(StackInstr* instr);
     void ProcessFloatToInt(StackInstr* instr);
@@ -413,6 +413,24 @@ void JitArm64::ProcessInstructions() {
 #endif
       ProcessCopy(instr);
       break;
+
+      // superinstructions
+    case INC_LOCL_INT_VAR:
+#ifdef _DEBUG_JIT_JIT
+      std::wcout << L"INC_LOCL_INT_VAR: id=" << instr->GetOperand() << L"; value=" << instr->GetOperand2()
+            << L"; regs=" << aval_regs.size() << endl;
+#endif
+      add_imm_mem(instr->GetOperand2(), instr->GetOperand3(), SP);
+      break;
+
+    case LOAD_LOCL_INT_VARS:
+#ifdef _DEBUG_JIT_JIT
+      std::wcout << L"LOAD_LOCL_INT_VARS: id=" << instr->GetOperand() << L"; id2=" << instr->GetOperand2()
+            << L"; regs=" << aval_regs.size() << endl;
+#endif
+      working_stack.push_front(new RegInstr(MEM_INT, local_offsets[instr->GetOperand()]));
+      working_stack.push_front(new RegInstr(MEM_INT, local_offsets[instr->GetOperand2()]));
+      break;
       
       // mathematical
     case AND_INT:
@@ -851,6 +869,15 @@ void JitArm64::ProcessInstructions() {
     }
       break;
 
+    case CHK_OBJ_INST: {
+#ifdef _DEBUG_JIT_JIT
+      std::wcout << L"CHK_OBJ_INST: regs=" << aval_regs.size() << endl;
+#endif
+      ProcessStackCallback(CHK_OBJ_INST, instr, instr_index, 1);
+      ProcessReturnParameters(INT_TYPE);
+    }
+      break;
+
     case LOAD_ARY_SIZE: {
 #ifdef _DEBUG_JIT_JIT
       std::wcout << L"LOAD_ARY_SIZE: regs=" << aval_regs.size() << endl;
@@ -1014,6 +1041,11 @@ void JitArm64::ProcessJump(StackInstr* instr) {
     std::wcout << L"JMP: id=" << instr->GetOperand() << L", regs=" << aval_regs.size()
           << endl;
 #endif
+    // loops are safepoints
+    if(instr->GetOperand() < instr_index) {
+      ProcessSafepoint(instr);
+    }
+    
     if(instr->GetOperand2() < 0) {
 #ifdef _DEBUG_JIT_JIT
       std::wcout << L"  " << (++instr_count) << L": [b <imm>]" << std::endl;
@@ -1082,6 +1114,26 @@ void JitArm64::ProcessJump(StackInstr* instr) {
   }
 }
 
+void JitArm64::ProcessSafepoint(StackInstr* instr) {
+  // test the collection flag
+  RegisterHolder* flag_holder = GetRegister();
+  move_imm_reg((size_t)MemoryManager::GetCollectingFlag(), flag_holder->GetRegister());
+  move_mem8_reg(0, flag_holder->GetRegister(), flag_holder->GetRegister());
+  cmp_imm_reg(0, flag_holder->GetRegister());
+  ReleaseRegister(flag_holder);
+
+#ifdef _DEBUG_JIT_JIT
+  std::wcout << L"  " << (++instr_count) << L": [b.eq <skip>]" << std::endl;
+#endif
+  const long skip_index = code_index;
+  AddMachineCode(0x54000000);
+
+  // wait for the collection in the VM, live registers are saved by the callback
+  ProcessStackCallback(JMP, instr, instr_index, 0);
+
+  code[skip_index] |= (code_index - skip_index) << 5;
+}
+
 void JitArm64::ProcessReturnParameters(MemoryType type) {
   switch(type) {
   case INT_TYPE:
@@ -2266,7 +2318,7 @@ void JitArm64::add_imm_reg(long imm, Register reg) {
   else {
     RegisterHolder* imm_holder = GetRegister();
     move_imm_reg(imm, imm_holder->GetRegister());
-    add_reg_reg(reg, imm_holder->GetRegister());
+    add_reg_reg(imm_holder->GetRegister(), reg);
     ReleaseRegister(imm_holder);
   }
 }
@@ -2341,7 +2393,7 @@ void JitArm64::sub_imm_reg(long imm, Register reg) {
   else {
     RegisterHolder* imm_holder = GetRegister();
     move_imm_reg(imm, imm_holder->GetRegister());
-    sub_reg_reg(reg, imm_holder->GetRegister());
+    sub_reg_reg(imm_holder->GetRegister(), reg);
     ReleaseRegister(imm_holder);
   }
 }
@@ -4206,9 +4258,15 @@ void JitArm64::ProcessIndices()
     case LOAD_FLOAT_VAR:
     case STOR_FLOAT_VAR:
     case COPY_FLOAT_VAR:
+    case INC_LOCL_INT_VAR:
       values.insert(pair<long, StackInstr*>(instr->GetOperand(), instr));
       break;
 
+    case LOAD_LOCL_INT_VARS:
+      values.insert(pair<long, StackInstr*>(instr->GetOperand(), instr));
+      values.insert(pair<long, StackInstr*>(instr->GetOperand2(), instr));
+      break;
+
     default:
       break;
     }
@@ -4216,12 +4274,13 @@ void JitArm64::ProcessIndices()
   
   long index = RED_ZONE;
   long last_id = -1;
+  local_offsets.clear();
   multimap<long, StackInstr*>::iterator value;
   for(value = values.begin(); value != values.end(); ++value) {
     long id = value->first;
     StackInstr* instr = (*value).second;
-    // instance reference
-    if(instr->GetOperand2() == INST || instr->GetOperand2() == CLS) {
+    // instance reference, note: INC_LOCL_INT_VAR holds a literal in operand2
+    if(instr->GetType() != INC_LOCL_INT_VAR && (instr->GetOperand2() == INST || instr->GetOperand2() == CLS)) {
       instr->SetOperand3(instr->GetOperand() * sizeof(size_t));
     }
     // local reference
@@ -4232,7 +4291,9 @@ void JitArm64::ProcessIndices()
            instr->GetType() == STOR_LOCL_INT_VAR ||
            instr->GetType() == STOR_CLS_INST_INT_VAR ||
            instr->GetType() == COPY_LOCL_INT_VAR ||
-           instr->GetType() == COPY_CLS_INST_INT_VAR) {
+           instr->GetType() == COPY_CLS_INST_INT_VAR ||
+           instr->GetType() == INC_LOCL_INT_VAR ||
+           instr->GetType() == LOAD_LOCL_INT_VARS) {
           index += sizeof(size_t);
         }
         else if(instr->GetType() == LOAD_FUNC_VAR ||
@@ -4244,6 +4305,7 @@ void JitArm64::ProcessIndices()
         }
       }
       instr->SetOperand3(index);
+      local_offsets[id] = index;
       last_id = id;
     }
 #ifdef _DEBUG_JIT_JIT
@@ -183,6 +183,8 @@ namespace Runtime {
     RegInstr(RegType t, long o) {
       type = t;
       operand = o;
+      holder = nullptr;
+      instr = nullptr;
     }
 
     RegInstr(StackInstr* si) {
@@ -324,6 +326,7 @@ namespace Runtime {
     vector<RegisterHolder*> aval_fregs;
     list<RegisterHolder*> used_fregs;
     unordered_map<long, StackInstr*> jump_table;
+    unordered_map<long, long> local_offsets; // local id to stack offset
     multimap<long, long> const_int_pool;
     vector<long> deref_offsets;          // -1
     vector<long> bounds_less_offsets;    // -2
@@ -379,6 +382,7 @@ namespace Runtime {
     void ProcessLoadFloatElement(StackInstr* instr);
     void ProcessStoreFloatElement(StackInstr* instr);
     void ProcessJump(StackInstr* instr);
+    void ProcessSafepoint(StackInstr* instr);
     void ProcessFloatToInt(StackInstr* instr);
     void ProcessIntToFloat(StackInstr* instr);
     
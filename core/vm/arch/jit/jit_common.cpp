@@ -74,6 +74,17 @@ void JitCompiler::JitStackCallback(const long instr_id, StackInstr* instr, const
   }
     break;
 
+  case CHK_OBJ_INST: {
+    size_t* mem = (size_t*)PopInt(op_stack, stack_pos);
+    if(!mem) {
+      std::wcerr << L">>> Unable to resolve virtual method call <<<" << std::endl;
+      std::wcerr << L"  native method: name=" << program->GetClass(cls_id)->GetMethod(mthd_id)->GetName() << std::endl;
+      exit(1);
+    }
+    PushInt(op_stack, stack_pos, (size_t)mem);
+  }
+    break;
+
   case LOAD_ARY_SIZE: {
     size_t* array = (size_t*)PopInt(op_stack, stack_pos);
     if(!array) {
@@ -410,25 +421,15 @@ void JitCompiler::JitStackCallback(const long instr_id, StackInstr* instr, const
       exit(1);
     }
 
-#ifdef _WIN32
-    HANDLE vm_thread = (HANDLE)instance[0];
-    if(WaitForSingleObject(vm_thread, INFINITE) != WAIT_OBJECT_0) {
-      std::wcerr << L"Unable to join thread!" << std::endl;
-      exit(-1);
-    }
-#else
-    void* status;
-    pthread_t vm_thread = (pthread_t)instance[0];
-    if(pthread_join(vm_thread, &status)) {
+    if(!Runtime::ThreadScheduler::Join(instance)) {
       std::wcerr << L"Unable to join thread!" << std::endl;
       exit(-1);
     }
-#endif      
   }
     break;
 
   case THREAD_SLEEP:
-    std::this_thread::sleep_for(std::chrono::milliseconds(PopInt(op_stack, stack_pos)));
+    Runtime::ThreadScheduler::Sleep((INT64_VALUE)PopInt(op_stack, stack_pos));
     break;
 
   case THREAD_MUTEX: {
@@ -438,11 +439,7 @@ void JitCompiler::JitStackCallback(const long instr_id, StackInstr* instr, const
       std::wcerr << L"  native method: name=" << program->GetClass(cls_id)->GetMethod(mthd_id)->GetName() << std::endl;
       exit(1);
     }
-#ifdef _WIN32      
-    InitializeCriticalSection((CRITICAL_SECTION*)&instance[1]);
-#else
-    pthread_mutex_init((pthread_mutex_t*)&instance[1], nullptr);
-#endif    
+    Runtime::ThreadScheduler::InitializeLock(instance);
   }
     break;
 
@@ -453,11 +450,7 @@ void JitCompiler::JitStackCallback(const long instr_id, StackInstr* instr, const
       std::wcerr << L"  native method: name=" << program->GetClass(cls_id)->GetMethod(mthd_id)->GetName() << std::endl;
       exit(1);
     }
-#ifdef _WIN32      
-    EnterCriticalSection((CRITICAL_SECTION*)&instance[1]);
-#else
-    pthread_mutex_lock((pthread_mutex_t*)&instance[1]);
-#endif      
+    Runtime::ThreadScheduler::Lock(instance);
   }
     break;
 
@@ -468,11 +461,12 @@ void JitCompiler::JitStackCallback(const long instr_id, StackInstr* instr, const
       std::wcerr << L"  native method: name=" << program->GetClass(cls_id)->GetMethod(mthd_id)->GetName() << std::endl;
       exit(1);
     }
-#ifdef _WIN32      
-    LeaveCriticalSection((CRITICAL_SECTION*)&instance[1]);
-#else
-    pthread_mutex_unlock((pthread_mutex_t*)&instance[1]);
-#endif      
+
+    if(!Runtime::ThreadScheduler::Unlock(instance)) {
+      std::wcerr << L"Releasing a mutex not held by the current thread" << std::endl;
+      std::wcerr << L"  native method: name=" << program->GetClass(cls_id)->GetMethod(mthd_id)->GetName() << std::endl;
+      exit(1);
+    }
   }
     break;
 
@@ -638,6 +632,11 @@ void JitCompiler::JitStackCallback(const long instr_id, StackInstr* instr, const
   }
     break;
 
+  // backward jumps are safepoints
+  case JMP:
+    MemoryManager::Safepoint();
+    break;
+
   case TRAP:
   case TRAP_RTRN:
     if(!TrapProcessor::ProcessTrap(program, inst, op_stack, stack_pos, nullptr)) {
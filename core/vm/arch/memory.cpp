@@ -36,6 +36,7 @@ StackProgram* MemoryManager::prgm;
 
 std::unordered_set<StackFrame**> MemoryManager::pda_frames;
 std::unordered_set<StackFrameMonitor*> MemoryManager::pda_monitors;
+std::unordered_multiset<size_t*> MemoryManager::native_roots;
 std::vector<StackFrame*> MemoryManager::jit_frames;
 std::set<size_t*> MemoryManager::allocated_memory;
 
@@ -58,6 +59,7 @@ long MemoryManager::mem_cycle = 0L;
 CRITICAL_SECTION MemoryManager::jit_frame_lock;
 CRITICAL_SECTION MemoryManager::pda_frame_lock;
 CRITICAL_SECTION MemoryManager::pda_monitor_lock;
+CRITICAL_SECTION MemoryManager::native_root_lock;
 CRITICAL_SECTION MemoryManager::allocated_lock;
 CRITICAL_SECTION MemoryManager::marked_lock;
 CRITICAL_SECTION MemoryManager::marked_sweep_lock;
@@ -66,12 +68,36 @@ CRITICAL_SECTION MemoryManager::free_memory_cache_lock;
 pthread_mutex_t MemoryManager::pda_monitor_lock = PTHREAD_MUTEX_INITIALIZER;
 pthread_mutex_t MemoryManager::pda_frame_lock = PTHREAD_MUTEX_INITIALIZER;
 pthread_mutex_t MemoryManager::jit_frame_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t MemoryManager::native_root_lock = PTHREAD_MUTEX_INITIALIZER;
 pthread_mutex_t MemoryManager::allocated_lock = PTHREAD_MUTEX_INITIALIZER;
 pthread_mutex_t MemoryManager::marked_lock = PTHREAD_MUTEX_INITIALIZER;
 pthread_mutex_t MemoryManager::marked_sweep_lock = PTHREAD_MUTEX_INITIALIZER;
 pthread_mutex_t MemoryManager::free_memory_cache_lock = PTHREAD_MUTEX_INITIALIZER;
 #endif
 
+// mutator tracking
+std::atomic<bool> MemoryManager::collecting(false);
+std::atomic<long> MemoryManager::running_mutators(0);
+thread_local bool MemoryManager::is_mutator = false;
+thread_local long MemoryManager::safe_depth = 0;
+thread_local long MemoryManager::mark_depth = 0;
+thread_local std::vector<std::pair<size_t*, bool> > MemoryManager::deferred_marks;
+#ifdef _WIN32
+CRITICAL_SECTION MemoryManager::mutator_lock;
+CONDITION_VARIABLE MemoryManager::mutator_cond;
+#else
+pthread_mutex_t MemoryManager::mutator_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t MemoryManager::mutator_cond = PTHREAD_COND_INITIALIZER;
+#endif
+
+#ifdef _WIN32
+#define MUTATOR_WAIT() SleepConditionVariableCS(&mutator_cond, &mutator_lock, INFINITE)
+#define MUTATOR_NOTIFY() WakeAllConditionVariable(&mutator_cond)
+#else
+#define MUTATOR_WAIT() pthread_cond_wait(&mutator_cond, &mutator_lock)
+#define MUTATOR_NOTIFY() pthread_cond_broadcast(&mutator_cond)
+#endif
+
 void MemoryManager::Initialize(StackProgram* p, size_t m)
 {
   prgm = p;
@@ -94,10 +120,13 @@ void MemoryManager::Initialize(StackProgram* p, size_t m)
   InitializeCriticalSection(&jit_frame_lock);
   InitializeCriticalSection(&pda_frame_lock);
   InitializeCriticalSection(&pda_monitor_lock);
+  InitializeCriticalSection(&native_root_lock);
   InitializeCriticalSection(&allocated_lock);
   InitializeCriticalSection(&marked_lock);
   InitializeCriticalSection(&marked_sweep_lock);
   InitializeCriticalSection(&free_memory_cache_lock);
+  InitializeCriticalSection(&mutator_lock);
+  InitializeConditionVariable(&mutator_cond);
 #endif
 
   initialized = true;
@@ -220,6 +249,94 @@ void MemoryManager::RemovePdaMethodRoot(StackFrameMonitor* monitor)
 #endif
 }
 
+void MemoryManager::AddNativeRoot(size_t* mem)
+{
+#ifndef _GC_SERIAL
+  MUTEX_LOCK(&native_root_lock);
+#endif
+  native_roots.insert(mem);
+#ifndef _GC_SERIAL
+  MUTEX_UNLOCK(&native_root_lock);
+#endif
+}
+
+void MemoryManager::RemoveNativeRoot(size_t* mem)
+{
+#ifndef _GC_SERIAL
+  MUTEX_LOCK(&native_root_lock);
+#endif
+  std::unordered_multiset<size_t*>::iterator found = native_roots.find(mem);
+  if(found != native_roots.end()) {
+    native_roots.erase(found);
+  }
+#ifndef _GC_SERIAL
+  MUTEX_UNLOCK(&native_root_lock);
+#endif
+}
+
+void MemoryManager::AddMutator()
+{
+  if(!is_mutator) {
+    // start out safe, joining waits for any collection in progress
+    is_mutator = true;
+    safe_depth = 1;
+    LeaveSafeRegion();
+  }
+}
+
+void MemoryManager::RemoveMutator()
+{
+  if(is_mutator) {
+    EnterSafeRegion();
+    is_mutator = false;
+    safe_depth = 0;
+  }
+}
+
+void MemoryManager::EnterSafeRegion()
+{
+  if(is_mutator && safe_depth++ == 0) {
+    running_mutators--;
+    if(collecting) {
+      MUTEX_LOCK(&mutator_lock);
+      MUTATOR_NOTIFY();
+      MUTEX_UNLOCK(&mutator_lock);
+    }
+  }
+}
+
+void MemoryManager::LeaveSafeRegion()
+{
+  if(is_mutator && --safe_depth == 0) {
+    running_mutators++;
+    if(collecting) {
+      // collection started while safe, stay off the heap until it's done
+      MUTEX_LOCK(&mutator_lock);
+      while(collecting) {
+        running_mutators--;
+        MUTATOR_NOTIFY();
+        MUTATOR_WAIT();
+        running_mutators++;
+      }
+      MUTEX_UNLOCK(&mutator_lock);
+    }
+  }
+}
+
+void MemoryManager::WaitForCollection()
+{
+  if(is_mutator && !safe_depth) {
+    MUTEX_LOCK(&mutator_lock);
+    while(collecting) {
+      running_mutators--;
+      MUTATOR_NOTIFY();
+      MUTATOR_WAIT();
+      running_mutators++;
+    }
+    MUTEX_UNLOCK(&mutator_lock);
+  }
+}
+
 size_t* MemoryManager::AllocateObject(const long obj_id, size_t* op_stack, long stack_pos, bool collect)
 {
   StackClass* cls = prgm->GetClass(obj_id);
@@ -232,8 +349,13 @@ size_t* MemoryManager::AllocateObject(const long obj_id, size_t* op_stack, long
     const long size = cls->GetInstanceMemorySize();
 
     // collect memory
-    if(collect && allocation_size + size > mem_max_size) {
-      CollectAllMemory(op_stack, stack_pos);
+    if(collect) {
+      if(allocation_size + size > mem_max_size) {
+        CollectAllMemory(op_stack, stack_pos);
+      }
+      else {
+        Safepoint();
+      }
     }
 
     // allocate memory
@@ -298,8 +420,13 @@ size_t* MemoryManager::AllocateArray(const size_t size, const MemoryType type, s
   }
 
   // collect memory
-  if (collect && allocation_size + calc_size > mem_max_size) {
-    CollectAllMemory(op_stack, stack_pos);
+  if(collect) {
+    if(allocation_size + calc_size > mem_max_size) {
+      CollectAllMemory(op_stack, stack_pos);
+    }
+    else {
+      Safepoint();
+    }
   }
 
   // allocate memory
@@ -341,6 +468,12 @@ size_t* MemoryManager::GetMemory(size_t size) {
     return mem;
   }
 
+  // round up to the cache pool size, so any block in a pool can be reused for any request mapped to it
+  const size_t pool_size = AlignMemorySize(size);
+  if(pool_size) {
+    size = pool_size;
+  }
+
   size_t alloc_size = size + sizeof(size_t);
   size_t* raw_mem = (size_t*)calloc(alloc_size, sizeof(char));
 #ifdef _DEBUG_GC
@@ -571,17 +704,29 @@ void MemoryManager::CollectAllMemory(size_t* op_stack, long stack_pos)
   clock_t start = clock();
 #endif
 
-#ifndef _GC_SERIAL
-#ifdef _WIN32
-  // only one thread at a time can invoke the gargabe collector
-  if(!TryEnterCriticalSection(&marked_sweep_lock)) {
+  // only one thread at a time can invoke the gargabe collector, others wait at their safepoint
+  const long self = is_mutator && !safe_depth ? 1 : 0;
+  MUTEX_LOCK(&mutator_lock);
+  if(collecting) {
+    running_mutators -= self;
+    MUTATOR_NOTIFY();
+    while(collecting) {
+      MUTATOR_WAIT();
+    }
+    running_mutators += self;
+    MUTEX_UNLOCK(&mutator_lock);
     return;
   }
-#else
-  if(pthread_mutex_trylock(&marked_sweep_lock)) {
-    return;
-  }  
-#endif
+
+  // stop the world: wait until every other mutator is parked or in a safe region
+  collecting = true;
+  while(running_mutators > self) {
+    MUTATOR_WAIT();
+  }
+  MUTEX_UNLOCK(&mutator_lock);
+
+#ifndef _GC_SERIAL
+  MUTEX_LOCK(&marked_sweep_lock);
 #endif
 
   CollectionInfo* info = new CollectionInfo;
@@ -631,6 +776,12 @@ void MemoryManager::CollectAllMemory(size_t* op_stack, long stack_pos)
   delete info;
   info = nullptr;
 
+  // restart the world
+  MUTEX_LOCK(&mutator_lock);
+  collecting = false;
+  MUTATOR_NOTIFY();
+  MUTEX_UNLOCK(&mutator_lock);
+
 #ifdef _TIMING
   clock_t end = clock();
   std::wcout << L"Collection: size=" << mem_max_size << L", time=" << (double)(end - start) / CLOCKS_PER_SEC << L" second(s)." << std::endl;
@@ -899,6 +1050,17 @@ void* MemoryManager::CheckStatic(void* arg)
     StackClass* cls = clss[i];
     CheckMemory(cls->GetClassMemory(), cls->GetClassDeclarations(), cls->GetNumberClassDeclarations(), 0);
   }
+
+  // objects held by native code
+#ifndef _GC_SERIAL
+  MUTEX_LOCK(&native_root_lock);
+#endif
+  for(std::unordered_multiset<size_t*>::iterator iter = native_roots.begin(); iter != native_roots.end(); ++iter) {
+    CheckObject(*iter, true, 1);
+  }
+#ifndef _GC_SERIAL
+  MUTEX_UNLOCK(&native_root_lock);
+#endif
   
   return 0;
 }
@@ -1132,7 +1294,7 @@ void* MemoryManager::CheckJitRoots(void* arg)
 
       // NOTE: this marks temporary variables that are stored in JIT memory
       // during some method calls. There are 6 integer temp addresses
-      // TODO: for non-ARM64 targets, skip 'has_and_or' variable addressed
+      // TODO: for ARM32, skip 'has_and_or' variable addressed
 #ifdef _ARM32
       // for ARM32, skip the link register
       for(int i = 1; i <= 6; ++i) {
@@ -1140,6 +1302,10 @@ void* MemoryManager::CheckJitRoots(void* arg)
       mem = start;
       for(int i = 0; i > -6; --i) {
 #else
+      // skip the 'has_and_or' variable, it sits between the locals and the temps
+      if(method->HasAndOr()) {
+        mem++;
+      }
       for(int i = 0; i < 6; ++i) {
 #endif
         size_t* check_mem = (size_t*)mem[i];
@@ -1238,7 +1404,25 @@ void* MemoryManager::CheckPdaRoots(void* arg)
     // gather stack frames
     long call_stack_pos = *(monitor->call_stack_pos);
 
-    if(call_stack_pos > 0) {
+    // operand stack of a stopped thread
+    if(monitor->op_stack && monitor->stack_pos) {
+      long stack_pos = *(monitor->stack_pos);
+      while(stack_pos > 0) {
+        size_t* check_mem = (size_t*)monitor->op_stack[--stack_pos];
+#ifndef _GC_SERIAL
+        MUTEX_LOCK(&allocated_lock);
+#endif
+        const bool found = allocated_memory.find(check_mem) != allocated_memory.end();
+#ifndef _GC_SERIAL
+        MUTEX_UNLOCK(&allocated_lock);
+#endif
+        if(found) {
+          CheckObject(check_mem, false, 1);
+        }
+      }
+    }
+
+    if(call_stack_pos > -1 && *(monitor->cur_frame)) {
       StackFrame** call_stack = monitor->call_stack;
       StackFrame* cur_frame = *(monitor->cur_frame);
 
@@ -1491,6 +1675,14 @@ void MemoryManager::CheckMemory(size_t* mem, StackDclr** dclrs, const long dcls_
 
 void MemoryManager::CheckObject(size_t* mem, bool is_obj, long depth)
 {
+  if(mark_depth >= MARK_DEPTH_MAX) {
+    if(mem) {
+      deferred_marks.push_back(std::make_pair(mem, is_obj));
+    }
+    return;
+  }
+
+  mark_depth++;
   if(allocated_memory.find(mem) != allocated_memory.end()) {
     StackClass* cls;
     if(is_obj) {
@@ -1529,9 +1721,8 @@ void MemoryManager::CheckObject(size_t* mem, bool is_obj, long depth)
 #endif
       // primitive or object array
       if(MarkValidMemory(mem)) {
-        // ensure we're only checking int and obj arrays
-        if(std::binary_search(allocated_memory.begin(), allocated_memory.end(), mem) && 
-          (mem[TYPE] == NIL_TYPE || mem[TYPE] == INT_TYPE)) {
+        // ensure we're only checking int and obj arrays, membership was checked above
+        if(mem[TYPE] == NIL_TYPE || mem[TYPE] == INT_TYPE) {
             size_t* array = mem;
             const size_t size = array[0];
             const size_t dim = array[1];
@@ -1543,4 +1734,17 @@ void MemoryManager::CheckObject(size_t* mem, bool is_obj, long depth)
       }
     }
   }
+  mark_depth--;
+
+  // outermost walk, mark deferred objects
+  if(!mark_depth) {
+    while(!deferred_marks.empty()) {
+      const std::pair<size_t*, bool> deferred = deferred_marks.back();
+      deferred_marks.pop_back();
+
+      mark_depth++;
+      CheckObject(deferred.first, deferred.second, depth);
+      mark_depth--;
+    }
+  }
 }
@@ -33,6 +33,7 @@
 #define __MEM_MGR_H__
 
 #include "../common.h"
+#include <atomic>
 
 // basic VM tuning parameters
 
@@ -46,6 +47,7 @@
 #define COLLECTED_COUNT 23
 
 #define EXTRA_BUF_SIZE 3
+#define MARK_DEPTH_MAX 1024
 #define MARKED_FLAG -1
 #define SIZE_OR_CLS -2
 #define TYPE -3
@@ -60,6 +62,8 @@ struct StackFrameMonitor {
   StackFrame** call_stack;
   long* call_stack_pos;
   StackFrame** cur_frame;
+  size_t* op_stack;
+  long* stack_pos;
 };
 
 // holders
@@ -80,6 +84,7 @@ class MemoryManager {
   static StackProgram* prgm;
   static std::unordered_set<StackFrameMonitor*> pda_monitors; // deleted elsewhere
   static std::unordered_set<StackFrame**> pda_frames;
+  static std::unordered_multiset<size_t*> native_roots;
   static std::vector<StackFrame*> jit_frames; // deleted elsewhere
   static std::set<size_t*> allocated_memory;
   static std::unordered_map<size_t, std::list<size_t*>*> free_memory_cache;
@@ -89,6 +94,7 @@ class MemoryManager {
   static CRITICAL_SECTION jit_frame_lock;
   static CRITICAL_SECTION pda_frame_lock;
   static CRITICAL_SECTION pda_monitor_lock;
+  static CRITICAL_SECTION native_root_lock;
   static CRITICAL_SECTION allocated_lock;
   static CRITICAL_SECTION marked_lock;
   static CRITICAL_SECTION marked_sweep_lock;
@@ -97,11 +103,29 @@ class MemoryManager {
   static pthread_mutex_t pda_monitor_lock;
   static pthread_mutex_t pda_frame_lock;
   static pthread_mutex_t jit_frame_lock;
+  static pthread_mutex_t native_root_lock;
   static pthread_mutex_t allocated_lock;
   static pthread_mutex_t marked_lock;
   static pthread_mutex_t marked_sweep_lock;
 	static pthread_mutex_t free_memory_cache_lock;
 #endif
+
+  // mutator threads stop at safepoints while memory is collected
+  static std::atomic<bool> collecting;
+  static std::atomic<long> running_mutators;
+  static thread_local bool is_mutator;
+  static thread_local long safe_depth;
+
+  // objects nested deeper than 'MARK_DEPTH_MAX' are marked once the walk unwinds, long chains would overflow the stack
+  static thread_local long mark_depth;
+  static thread_local std::vector<std::pair<size_t*, bool> > deferred_marks;
+#ifdef _WIN32
+  static CRITICAL_SECTION mutator_lock;
+  static CONDITION_VARIABLE mutator_cond;
+#else
+  static pthread_mutex_t mutator_lock;
+  static pthread_cond_t mutator_cond;
+#endif
     
   // note: protected by 'allocated_lock'
   static size_t allocation_size;
@@ -167,6 +191,7 @@ class MemoryManager {
   static size_t* GetFreeMemory(size_t size);
   static size_t AlignMemorySize(size_t size);
   static void ClearFreeMemory(bool all = false);
+  static void WaitForCollection();
   
  public:
   static void Initialize(StackProgram* p, size_t m);
@@ -192,20 +217,47 @@ class MemoryManager {
 #ifdef _WIN32
     DeleteCriticalSection(&jit_frame_lock);
     DeleteCriticalSection(&pda_monitor_lock);
+    DeleteCriticalSection(&native_root_lock);
     DeleteCriticalSection(&allocated_lock);
     DeleteCriticalSection(&marked_lock);
     DeleteCriticalSection(&marked_sweep_lock);
     DeleteCriticalSection(&free_memory_cache_lock);
+    DeleteCriticalSection(&mutator_lock);
 #endif
       
     initialized = false;
   }
   
+  //
+  // threads that execute VM code register as mutators. a mutator is stopped
+  // at its next safepoint before memory is marked, unless it is inside a safe
+  // region (i.e. blocked in native code) where it must not touch the heap.
+  //
+  static void AddMutator();
+  static void RemoveMutator();
+  static void EnterSafeRegion();
+  static void LeaveSafeRegion();
+
+  static inline void Safepoint() {
+    if(collecting.load(std::memory_order_relaxed)) {
+      WaitForCollection();
+    }
+  }
+
+  // polled by JIT-compiled loops, which call back into 'Safepoint()' when set
+  static inline const std::atomic<bool>* GetCollectingFlag() {
+    return &collecting;
+  }
+  
   // add and remove pda roots
   static void AddPdaMethodRoot(StackFrame** frame);
   static void RemovePdaMethodRoot(StackFrame** frame);
   static void AddPdaMethodRoot(StackFrameMonitor* monitor);  
   static void RemovePdaMethodRoot(StackFrameMonitor* monitor);
+
+  // objects only referenced from native code, such as queued tasks
+  static void AddNativeRoot(size_t* mem);
+  static void RemoveNativeRoot(size_t* mem);
   
   static void CheckMemory(size_t* mem, StackDclr** dclrs, const long dcls_size, const long depth);
   static void CheckObject(size_t* mem, bool is_obj, const long depth);
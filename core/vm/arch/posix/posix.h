@@ -49,6 +49,17 @@
 #include <sys/un.h>
 #include <pwd.h>
 #include <grp.h>
+#include <poll.h>
+#include <sys/mman.h>
+#ifdef _OSX
+#include <sys/event.h>
+#ifndef _XOPEN_SOURCE
+#define _XOPEN_SOURCE 600
+#endif
+#else
+#include <sys/epoll.h>
+#endif
+#include <ucontext.h>
 
 #define SOCKET int
 
@@ -148,6 +159,42 @@ class File {
     return fopen(name, mode);
   }
 
+  static char* MapFile(const char* name, size_t &size) {
+    const int fd = open(name, O_RDONLY);
+    if(fd < 0) {
+      return nullptr;
+    }
+
+    struct stat buf;
+    if(fstat(fd, &buf) || !S_ISREG(buf.st_mode)) {
+      close(fd);
+      return nullptr;
+    }
+
+    // empty files can't be mapped
+    size = buf.st_size;
+    if(!size) {
+      close(fd);
+      static char empty = '\0';
+      return &empty;
+    }
+
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED) {
+      return nullptr;
+    }
+    madvise(data, size, MADV_SEQUENTIAL);
+
+    return (char*)data;
+  }
+
+  static void UnmapFile(char* data, size_t size) {
+    if(size) {
+      munmap(data, size);
+    }
+  }
+
   static std::wstring FileOwner(const char* name, bool is_account) {
     struct stat info;
     if(stat(name, &info)) {
@@ -391,6 +438,9 @@ public:
     sin.sin_addr.s_addr = INADDR_ANY;
     sin.sin_port = htons(port);
     
+    int reuse = 1;
+    setsockopt(server, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
     if(::bind(server, (struct sockaddr *)&sin, sizeof(sin)) < 0) {
       close(server);
       return -1;
@@ -451,6 +501,207 @@ public:
   static void Close(SOCKET sock) {
     close(sock);
   }
+
+  static bool SetBlocking(SOCKET sock, bool is_blocking) {
+    int flags = fcntl(sock, F_GETFL, 0);
+    if(flags < 0) {
+      return false;
+    }
+
+    flags = is_blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK);
+    return fcntl(sock, F_SETFL, flags) == 0;
+  }
+
+  // true if the last call failed because a non-blocking socket was not ready
+  static bool IsPending() {
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+  }
+
+  // waits up to 'timeout' milliseconds, -1 to wait indefinitely
+  static bool WaitReady(SOCKET sock, bool is_write, int timeout) {
+    struct pollfd ready;
+    ready.fd = sock;
+    ready.events = is_write ? POLLOUT : POLLIN;
+    ready.revents = 0;
+
+    return poll(&ready, 1, timeout) > 0;
+  }
+};
+
+/****************************
+ * Socket readiness poller, 
+ * epoll on Linux and kqueue 
+ * on macOS
+ ****************************/
+class IPSocketPoller {
+  int poller;
+  // sockets may be added and removed while another thread waits
+  std::unordered_map<SOCKET, int> interests;
+  pthread_mutex_t interests_lock;
+
+#ifdef _OSX
+  bool Control(SOCKET sock, int filter, bool is_add) {
+    struct kevent change;
+    EV_SET(&change, sock, filter, is_add ? EV_ADD : EV_DELETE, 0, 0, nullptr);
+    return kevent(poller, &change, 1, nullptr, 0, nullptr) == 0;
+  }
+#else
+  bool Control(SOCKET sock, int events, int op) {
+    struct epoll_event change;
+    memset(&change, 0, sizeof(change));
+    if(events & SOCKET_POLL_READ) {
+      change.events |= EPOLLIN | EPOLLRDHUP;
+    }
+    if(events & SOCKET_POLL_WRITE) {
+      change.events |= EPOLLOUT;
+    }
+    change.data.fd = sock;
+
+    return epoll_ctl(poller, op, sock, &change) == 0;
+  }
+#endif
+
+ public:
+  IPSocketPoller() {
+#ifdef _OSX
+    poller = kqueue();
+#else
+    poller = epoll_create1(EPOLL_CLOEXEC);
+#endif
+    pthread_mutex_init(&interests_lock, nullptr);
+  }
+
+  ~IPSocketPoller() {
+    if(poller > -1) {
+      close(poller);
+      poller = -1;
+    }
+    pthread_mutex_destroy(&interests_lock);
+  }
+
+  bool IsOpen() {
+    return poller > -1;
+  }
+
+  // registered events for a socket, 0 if it isn't registered
+  int GetEvents(SOCKET sock) {
+    pthread_mutex_lock(&interests_lock);
+    std::unordered_map<SOCKET, int>::iterator found = interests.find(sock);
+    const int events = found != interests.end() ? found->second : 0;
+    pthread_mutex_unlock(&interests_lock);
+
+    return events;
+  }
+
+  std::vector<SOCKET> GetSockets() {
+    std::vector<SOCKET> socks;
+    pthread_mutex_lock(&interests_lock);
+    for(std::unordered_map<SOCKET, int>::iterator iter = interests.begin(); iter != interests.end(); ++iter) {
+      socks.push_back(iter->first);
+    }
+    pthread_mutex_unlock(&interests_lock);
+
+    return socks;
+  }
+
+  bool Add(SOCKET sock, int events) {
+    pthread_mutex_lock(&interests_lock);
+    std::unordered_map<SOCKET, int>::iterator found = interests.find(sock);
+#ifdef _OSX
+    const int current = found != interests.end() ? found->second : 0;
+    if((events & SOCKET_POLL_READ) && !(current & SOCKET_POLL_READ) && !Control(sock, EVFILT_READ, true)) {
+      pthread_mutex_unlock(&interests_lock);
+      return false;
+    }
+    else if(!(events & SOCKET_POLL_READ) && (current & SOCKET_POLL_READ)) {
+      Control(sock, EVFILT_READ, false);
+    }
+
+    if((events & SOCKET_POLL_WRITE) && !(current & SOCKET_POLL_WRITE) && !Control(sock, EVFILT_WRITE, true)) {
+      pthread_mutex_unlock(&interests_lock);
+      return false;
+    }
+    else if(!(events & SOCKET_POLL_WRITE) && (current & SOCKET_POLL_WRITE)) {
+      Control(sock, EVFILT_WRITE, false);
+    }
+#else
+    // a closed descriptor leaves epoll on its own, so a reused one must be added again
+    if(found == interests.end() || !Control(sock, events, EPOLL_CTL_MOD)) {
+      if(!Control(sock, events, EPOLL_CTL_ADD)) {
+        pthread_mutex_unlock(&interests_lock);
+        return false;
+      }
+    }
+#endif
+    interests[sock] = events;
+    pthread_mutex_unlock(&interests_lock);
+
+    return true;
+  }
+
+  bool Remove(SOCKET sock) {
+    pthread_mutex_lock(&interests_lock);
+    std::unordered_map<SOCKET, int>::iterator found = interests.find(sock);
+    if(found == interests.end()) {
+      pthread_mutex_unlock(&interests_lock);
+      return false;
+    }
+
+#ifdef _OSX
+    if(found->second & SOCKET_POLL_READ) {
+      Control(sock, EVFILT_READ, false);
+    }
+    if(found->second & SOCKET_POLL_WRITE) {
+      Control(sock, EVFILT_WRITE, false);
+    }
+#else
+    Control(sock, 0, EPOLL_CTL_DEL);
+#endif
+    interests.erase(found);
+    pthread_mutex_unlock(&interests_lock);
+
+    return true;
+  }
+
+  int Wait(int timeout, std::unordered_map<SOCKET, int> &ready) {
+#ifdef _OSX
+    struct kevent events[SOCKET_POLL_MAX];
+    struct timespec* wait_time = nullptr;
+    struct timespec time_out;
+    if(timeout > -1) {
+      time_out.tv_sec = timeout / 1000;
+      time_out.tv_nsec = (timeout % 1000) * 1000000;
+      wait_time = &time_out;
+    }
+
+    const int count = kevent(poller, nullptr, 0, events, SOCKET_POLL_MAX, wait_time);
+    for(int i = 0; i < count; ++i) {
+      int event = events[i].filter == EVFILT_WRITE ? SOCKET_POLL_WRITE : SOCKET_POLL_READ;
+      if(events[i].flags & (EV_EOF | EV_ERROR)) {
+        event |= SOCKET_POLL_CLOSED;
+      }
+      ready[(SOCKET)events[i].ident] |= event;
+    }
+#else
+    struct epoll_event events[SOCKET_POLL_MAX];
+    const int count = epoll_wait(poller, events, SOCKET_POLL_MAX, timeout);
+    for(int i = 0; i < count; ++i) {
+      int event = 0;
+      if(events[i].events & EPOLLIN) {
+        event |= SOCKET_POLL_READ;
+      }
+      if(events[i].events & EPOLLOUT) {
+        event |= SOCKET_POLL_WRITE;
+      }
+      if(events[i].events & (EPOLLHUP | EPOLLRDHUP | EPOLLERR)) {
+        event |= SOCKET_POLL_CLOSED;
+      }
+      ready[events[i].data.fd] |= event;
+    }
+#endif
+
+    return count;
+  }
 };
 
 /****************************
@@ -575,6 +826,86 @@ class IPSecureSocket {
   }
 };
 
+/****************************
+ * Execution context with its
+ * own stack, green threads are
+ * switched between carriers
+ ****************************/
+class Fiber {
+  ucontext_t context;
+  char* stack;
+  size_t stack_size;
+  void (*entry)(void*);
+  void* arg;
+
+  static void Start(unsigned int high, unsigned int low) {
+    Fiber* fiber = (Fiber*)(uintptr_t)(((uint64_t)high << 32) | low);
+    fiber->entry(fiber->arg);
+  }
+
+ public:
+  Fiber() {
+    stack = nullptr;
+    stack_size = 0;
+    entry = nullptr;
+    arg = nullptr;
+  }
+
+  ~Fiber() {
+    if(stack) {
+      munmap(stack, stack_size);
+      stack = nullptr;
+    }
+  }
+
+  //
+  // (re)starts the context in 'entry', which must never return. the stack
+  // is kept when the fiber is reused and has a guard page at its base.
+  //
+  bool Create(size_t size, void (*e)(void*), void* a) {
+    if(!stack || stack_size != size) {
+      if(stack) {
+        munmap(stack, stack_size);
+      }
+
+      stack = (char*)mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if(stack == MAP_FAILED) {
+        stack = nullptr;
+        return false;
+      }
+      stack_size = size;
+      mprotect(stack, sysconf(_SC_PAGESIZE), PROT_NONE);
+    }
+
+    if(getcontext(&context)) {
+      return false;
+    }
+    context.uc_stack.ss_sp = stack;
+    context.uc_stack.ss_size = stack_size;
+    context.uc_link = nullptr;
+
+    entry = e;
+    arg = a;
+    const uint64_t self = (uint64_t)(uintptr_t)this;
+    makecontext(&context, (void (*)())Start, 2, (unsigned int)(self >> 32), (unsigned int)self);
+
+    return true;
+  }
+
+  // carrier threads switch from their own stack
+  bool Attach() {
+    return true;
+  }
+
+  void Detach() {
+  }
+
+  // saves the running context here and resumes 'to'
+  inline void Switch(Fiber* to) {
+    swapcontext(&context, &to->context);
+  }
+};
+
 /****************************
  * System operations
  ****************************/
@@ -227,6 +227,45 @@ class File {
     return file;
   }
 
+  static char* MapFile(const char* name, size_t &size) {
+    HANDLE file = CreateFile(name, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if(file == INVALID_HANDLE_VALUE) {
+      return nullptr;
+    }
+
+    LARGE_INTEGER file_size;
+    if(!GetFileSizeEx(file, &file_size)) {
+      CloseHandle(file);
+      return nullptr;
+    }
+
+    // empty files can't be mapped
+    size = (size_t)file_size.QuadPart;
+    if(!size) {
+      CloseHandle(file);
+      static char empty = '\0';
+      return &empty;
+    }
+
+    HANDLE mapping = CreateFileMapping(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if(!mapping) {
+      return nullptr;
+    }
+
+    // the view holds a reference to the mapping
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+
+    return (char*)data;
+  }
+
+  static void UnmapFile(char* data, size_t size) {
+    if(size) {
+      UnmapViewOfFile(data);
+    }
+  }
+
   static bool MakeDir(const char* name) {
     if(CreateDirectory(name, nullptr) == 0) {
       return false;
@@ -493,6 +532,131 @@ class IPSocket {
   }
 
   static SOCKET Accept(SOCKET server, char* client_address, int& client_port);
+
+  static bool SetBlocking(SOCKET sock, bool is_blocking) {
+    u_long mode = is_blocking ? 0 : 1;
+    return ioctlsocket(sock, FIONBIO, &mode) == 0;
+  }
+
+  // true if the last call failed because a non-blocking socket was not ready
+  static bool IsPending() {
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+  }
+
+  // waits up to 'timeout' milliseconds, -1 to wait indefinitely
+  static bool WaitReady(SOCKET sock, bool is_write, int timeout) {
+    WSAPOLLFD ready;
+    ready.fd = sock;
+    ready.events = is_write ? POLLWRNORM : POLLRDNORM;
+    ready.revents = 0;
+
+    return WSAPoll(&ready, 1, timeout) > 0;
+  }
+};
+
+/****************************
+ * Socket readiness poller 
+ * backed by WSAPoll
+ ****************************/
+class IPSocketPoller {
+  // sockets may be added and removed while another thread waits, they're
+  // seen by the next wait
+  std::unordered_map<SOCKET, int> interests;
+  CRITICAL_SECTION interests_lock;
+
+ public:
+  IPSocketPoller() {
+    InitializeCriticalSection(&interests_lock);
+  }
+
+  ~IPSocketPoller() {
+    DeleteCriticalSection(&interests_lock);
+  }
+
+  bool IsOpen() {
+    return true;
+  }
+
+  // registered events for a socket, 0 if it isn't registered
+  int GetEvents(SOCKET sock) {
+    EnterCriticalSection(&interests_lock);
+    std::unordered_map<SOCKET, int>::iterator found = interests.find(sock);
+    const int events = found != interests.end() ? found->second : 0;
+    LeaveCriticalSection(&interests_lock);
+
+    return events;
+  }
+
+  std::vector<SOCKET> GetSockets() {
+    std::vector<SOCKET> socks;
+    EnterCriticalSection(&interests_lock);
+    for(std::unordered_map<SOCKET, int>::iterator iter = interests.begin(); iter != interests.end(); ++iter) {
+      socks.push_back(iter->first);
+    }
+    LeaveCriticalSection(&interests_lock);
+
+    return socks;
+  }
+
+  bool Add(SOCKET sock, int events) {
+    EnterCriticalSection(&interests_lock);
+    interests[sock] = events;
+    LeaveCriticalSection(&interests_lock);
+
+    return true;
+  }
+
+  bool Remove(SOCKET sock) {
+    EnterCriticalSection(&interests_lock);
+    const bool is_removed = interests.erase(sock) > 0;
+    LeaveCriticalSection(&interests_lock);
+
+    return is_removed;
+  }
+
+  int Wait(int timeout, std::unordered_map<SOCKET, int> &ready) {
+    EnterCriticalSection(&interests_lock);
+    if(interests.empty()) {
+      LeaveCriticalSection(&interests_lock);
+      Sleep(timeout > -1 ? timeout : 0);
+      return 0;
+    }
+
+    std::vector<WSAPOLLFD> polls;
+    for(std::unordered_map<SOCKET, int>::iterator iter = interests.begin(); iter != interests.end(); ++iter) {
+      WSAPOLLFD poll;
+      poll.fd = iter->first;
+      poll.events = 0;
+      if(iter->second & SOCKET_POLL_READ) {
+        poll.events |= POLLRDNORM;
+      }
+      if(iter->second & SOCKET_POLL_WRITE) {
+        poll.events |= POLLWRNORM;
+      }
+      poll.revents = 0;
+      polls.push_back(poll);
+    }
+    LeaveCriticalSection(&interests_lock);
+
+    const int count = WSAPoll(polls.data(), (ULONG)polls.size(), timeout);
+    for(size_t i = 0; count > 0 && i < polls.size(); ++i) {
+      int event = 0;
+      if(polls[i].revents & POLLRDNORM) {
+        event |= SOCKET_POLL_READ;
+      }
+      if(polls[i].revents & POLLWRNORM) {
+        event |= SOCKET_POLL_WRITE;
+      }
+      if(polls[i].revents & (POLLHUP | POLLERR | POLLNVAL)) {
+        event |= SOCKET_POLL_CLOSED;
+      }
+      if(event) {
+        ready[polls[i].fd] |= event;
+      }
+    }
+
+    return count;
+  }
 };
 
 /****************************
@@ -617,6 +781,74 @@ class IPSecureSocket {
   }
 };
 
+/****************************
+ * Execution context with its
+ * own stack, green threads are
+ * switched between carriers
+ ****************************/
+class Fiber {
+  LPVOID fiber;
+  bool is_thread;
+  void (*entry)(void*);
+  void* arg;
+
+  static VOID CALLBACK Start(LPVOID param) {
+    Fiber* fiber = (Fiber*)param;
+    fiber->entry(fiber->arg);
+  }
+
+ public:
+  Fiber() {
+    fiber = nullptr;
+    is_thread = false;
+    entry = nullptr;
+    arg = nullptr;
+  }
+
+  ~Fiber() {
+    if(fiber && !is_thread) {
+      DeleteFiber(fiber);
+      fiber = nullptr;
+    }
+  }
+
+  //
+  // (re)starts the context in 'entry', which must never return. fibers
+  // cannot be rewound, so a reused fiber is recreated.
+  //
+  bool Create(size_t size, void (*e)(void*), void* a) {
+    if(fiber) {
+      DeleteFiber(fiber);
+    }
+
+    entry = e;
+    arg = a;
+    fiber = CreateFiberEx(0, size, FIBER_FLAG_FLOAT_SWITCH, Start, this);
+
+    return fiber != nullptr;
+  }
+
+  // carrier threads must become fibers before switching
+  bool Attach() {
+    fiber = ConvertThreadToFiberEx(nullptr, FIBER_FLAG_FLOAT_SWITCH);
+    is_thread = fiber != nullptr;
+    return is_thread;
+  }
+
+  void Detach() {
+    if(is_thread) {
+      ConvertFiberToThread();
+      fiber = nullptr;
+      is_thread = false;
+    }
+  }
+
+  // resumes 'to', the running context is saved by the system
+  inline void Switch(Fiber* to) {
+    SwitchToFiber(to->fiber);
+  }
+};
+
 /****************************
  * System operations
  ****************************/
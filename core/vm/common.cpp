@@ -58,6 +58,15 @@ pthread_mutex_t StackProgram::program_mutex = PTHREAD_MUTEX_INITIALIZER;
 pthread_mutex_t StackProgram::prop_mutex = PTHREAD_MUTEX_INITIALIZER;
 #endif
 
+#ifdef _WIN32
+CRITICAL_SECTION SocketBuffer::buffer_cs;
+#else
+pthread_mutex_t SocketBuffer::buffer_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+std::unordered_map<size_t, SocketBuffer*> SocketBuffer::socket_buffers;
+std::unordered_map<size_t, std::vector<const void*>> SocketBuffer::socket_pollers;
+std::unordered_map<const void*, std::unordered_set<size_t>> SocketBuffer::poller_pending;
+
 std::map<std::wstring, std::wstring> StackProgram::properties_map;
 std::unordered_map<long, StackMethod*> StackProgram::signal_handler_func;
 
@@ -1386,6 +1395,51 @@ size_t* TrapProcessor::CreateStringObject(const std::wstring &value_str, StackPr
   return str_obj;
 }
 
+/********************************
+ * Create a string instance from 
+ * UTF-8 bytes
+ ********************************/
+size_t* TrapProcessor::CreateStringObject(const char* value, size_t size, StackProgram* program,
+                                          size_t* &op_stack, long* &stack_pos) {
+  // create character array
+  const long char_array_size = (long)Utf8Length(value, size);
+  const long char_array_dim = 1;
+  size_t* char_array = MemoryManager::AllocateArray(char_array_size + 1 + ((char_array_dim + 2) * sizeof(size_t)), 
+                                                    CHAR_ARY_TYPE, op_stack, *stack_pos, false);
+  char_array[0] = char_array_size + 1;
+  char_array[1] = char_array_dim;
+  char_array[2] = char_array_size;
+
+  // decode string
+  wchar_t* char_array_ptr = (wchar_t*)(char_array + 3);
+  Utf8Decode(value, size, char_array_ptr);
+  char_array_ptr[char_array_size] = L'\0';
+
+  // create 'System.String' object instance
+  size_t* str_obj = MemoryManager::AllocateObject(program->GetStringObjectId(), op_stack, *stack_pos, false);
+  str_obj[0] = (size_t)char_array;
+  str_obj[1] = char_array_size;
+  str_obj[2] = char_array_size;
+
+  return str_obj;
+}
+
+/********************************
+ * Decode UTF-8 bytes into a 
+ * character array at an offset
+ ********************************/
+size_t TrapProcessor::DecodeCharArray(const char* bytes, size_t size, const size_t* array, size_t offset, bool skip_bom) {
+  // skip BOM (U+FEFF, U+FFFE)
+  const unsigned char* in = (const unsigned char*)bytes;
+  if(skip_bom && size > 2 && in[0] == 0xef && ((in[1] == 0xbb && in[2] == 0xbf) || (in[1] == 0xbf && in[2] == 0xbe))) {
+    bytes += 3;
+    size -= 3;
+  }
+
+  wchar_t* out = (wchar_t*)(array + 3) + offset;
+  return Utf8Decode(bytes, size, out, array[0] - offset);
+}
+
 /********************************
  * Date/time calculations
  ********************************/
@@ -1868,145 +1922,671 @@ FLOAT_VALUE TrapProcessor::DeserializeFloat(size_t* inst)
 }
 
 /********************************
- * Serializes an object graph
+ * SocketBuffer class
  ********************************/
-void TrapProcessor::SerializeObject(size_t* inst, StackFrame* frame, size_t* &op_stack, long* &stack_pos)
+SocketBuffer* SocketBuffer::GetBuffer(size_t key, size_t s, SSL_CTX* c, BIO* b, bool i)
 {
-  size_t* obj = (size_t*)frame->mem[1];
-  ObjectSerializer serializer(obj);
-  std::vector<char> src_buffer = serializer.GetValues();
-  const long src_buffer_size = (long)src_buffer.size();
-  size_t* dest_buffer = (size_t*)inst[0];
-  long dest_pos = (long)inst[1];
+  SocketBuffer* buffer;
 
-  // expand buffer, if needed
-  dest_buffer = ExpandSerialBuffer(src_buffer_size, dest_buffer, inst, op_stack, stack_pos);
-  inst[0] = (size_t)dest_buffer;
-
-  // copy content
-  char* dest_buffer_ptr = ((char*)(dest_buffer + 3) + dest_pos);
-  for(int i = 0; i < src_buffer_size; i++, dest_pos++) {
-    dest_buffer_ptr[i] = src_buffer[i];
+#ifdef _WIN32
+  MUTEX_LOCK(&buffer_cs);
+#else
+  MUTEX_LOCK(&buffer_mutex);
+#endif
+  std::unordered_map<size_t, SocketBuffer*>::iterator result = socket_buffers.find(key);
+  if(result != socket_buffers.end()) {
+    buffer = result->second;
   }
-  inst[1] = dest_pos;
+  else {
+    buffer = new SocketBuffer(s, c, b, i);
+    socket_buffers.insert(std::pair<size_t, SocketBuffer*>(key, buffer));
+  }
+  buffer->refs++;
+#ifdef _WIN32
+  MUTEX_UNLOCK(&buffer_cs);
+#else
+  MUTEX_UNLOCK(&buffer_mutex);
+#endif
+
+  return buffer;
 }
 
-/********************************
- * Deserializes an object graph
- ********************************/
-void TrapProcessor::DeserializeObject(size_t* inst, size_t* &op_stack, long* &stack_pos) {
-  if(!DeserializeByte(inst)) {
-    PushInt(0, op_stack, stack_pos);
+void SocketBuffer::Unreference(SocketBuffer* buffer)
+{
+#ifdef _WIN32
+  MUTEX_LOCK(&buffer_cs);
+#else
+  MUTEX_LOCK(&buffer_mutex);
+#endif
+  const bool is_unused = --buffer->refs == 0;
+#ifdef _WIN32
+  MUTEX_UNLOCK(&buffer_cs);
+#else
+  MUTEX_UNLOCK(&buffer_mutex);
+#endif
+
+  if(is_unused) {
+    delete buffer;
+    buffer = nullptr;
   }
-  else {
-    size_t* byte_array = (size_t*)inst[0];
-    const long dest_pos = (long)inst[1];
-    const long byte_array_dim_size = (long)byte_array[2];
-    const char* byte_array_ptr = ((char*)(byte_array + 3) + dest_pos);
+}
 
-    ObjectDeserializer deserializer(byte_array_ptr, byte_array_dim_size, op_stack, stack_pos);
-    PushInt((size_t)deserializer.DeserializeObject(), op_stack, stack_pos);
-    inst[1] = dest_pos + deserializer.GetOffset();
+// a contended lock may be held across a blocking send or receive, wait for it outside the carrier
+#ifdef _WIN32
+void SocketBuffer::Lock(CRITICAL_SECTION* lock)
+{
+  if(!TryEnterCriticalSection(lock)) {
+    Runtime::ThreadScheduler::BlockingStart();
+    EnterCriticalSection(lock);
+    Runtime::ThreadScheduler::BlockingEnd();
+  }
+}
+#else
+void SocketBuffer::Lock(pthread_mutex_t* lock)
+{
+  if(pthread_mutex_trylock(lock)) {
+    Runtime::ThreadScheduler::BlockingStart();
+    pthread_mutex_lock(lock);
+    Runtime::ThreadScheduler::BlockingEnd();
   }
 }
+#endif
 
-/********************************
- * Handles callback traps from
- * the interpreter and JIT code
- ********************************/
-bool TrapProcessor::ProcessTrap(StackProgram* program, size_t* inst,
-                                size_t* &op_stack, long* &stack_pos, StackFrame* frame) {
-  const INT64_VALUE id = (INT64_VALUE)PopInt(op_stack, stack_pos);
-  switch(id) {
-  case LOAD_CLS_INST_ID:
-    return LoadClsInstId(program, inst, op_stack, stack_pos, frame);
+void SocketBuffer::Watch(const void* poller, size_t sock)
+{
+#ifdef _WIN32
+  MUTEX_LOCK(&buffer_cs);
+#else
+  MUTEX_LOCK(&buffer_mutex);
+#endif
+  std::vector<const void*> &pollers = socket_pollers[sock];
+  if(std::find(pollers.begin(), pollers.end(), poller) == pollers.end()) {
+    pollers.push_back(poller);
+  }
 
-  case STRING_HASH_ID:
-    return HashStringId(program, inst, op_stack, stack_pos, frame);
+  std::unordered_map<size_t, SocketBuffer*>::iterator result = socket_buffers.find(sock);
+  if(result != socket_buffers.end() && result->second->is_pending) {
+    poller_pending[poller].insert(sock);
+  }
+#ifdef _WIN32
+  MUTEX_UNLOCK(&buffer_cs);
+#else
+  MUTEX_UNLOCK(&buffer_mutex);
+#endif
+}
 
-  case LOAD_NEW_OBJ_INST:
-    return LoadNewObjInst(program, inst, op_stack, stack_pos, frame);
+void SocketBuffer::Unwatch(const void* poller, size_t sock)
+{
+#ifdef _WIN32
+  MUTEX_LOCK(&buffer_cs);
+#else
+  MUTEX_LOCK(&buffer_mutex);
+#endif
+  std::unordered_map<size_t, std::vector<const void*>>::iterator found = socket_pollers.find(sock);
+  if(found != socket_pollers.end()) {
+    std::vector<const void*> &pollers = found->second;
+    pollers.erase(std::remove(pollers.begin(), pollers.end(), poller), pollers.end());
+    if(pollers.empty()) {
+      socket_pollers.erase(found);
+    }
+  }
 
-  case LOAD_CLS_BY_INST:
-    return LoadClsByInst(program, inst, op_stack, stack_pos, frame);
+  std::unordered_map<const void*, std::unordered_set<size_t>>::iterator pending = poller_pending.find(poller);
+  if(pending != poller_pending.end()) {
+    pending->second.erase(sock);
+    if(pending->second.empty()) {
+      poller_pending.erase(pending);
+    }
+  }
+#ifdef _WIN32
+  MUTEX_UNLOCK(&buffer_cs);
+#else
+  MUTEX_UNLOCK(&buffer_mutex);
+#endif
+}
 
-  case BYTES_TO_UNICODE:
-    return ConvertBytesToUnicode(program, inst, op_stack, stack_pos, frame);
+void SocketBuffer::GetPending(const void* poller, std::vector<size_t> &socks)
+{
+  std::vector<SocketBuffer*> buffers;
 
-  case UNICODE_TO_BYTES:
-    return ConvertUnicodeToBytes(program, inst, op_stack, stack_pos, frame);
+#ifdef _WIN32
+  MUTEX_LOCK(&buffer_cs);
+#else
+  MUTEX_LOCK(&buffer_mutex);
+#endif
+  std::unordered_map<const void*, std::unordered_set<size_t>>::iterator pending = poller_pending.find(poller);
+  if(pending != poller_pending.end()) {
+    std::unordered_set<size_t> &pending_socks = pending->second;
+    for(std::unordered_set<size_t>::iterator iter = pending_socks.begin(); iter != pending_socks.end();) {
+      std::unordered_map<size_t, SocketBuffer*>::iterator result = socket_buffers.find(*iter);
+      // released buffers leave their sockets behind
+      if(result == socket_buffers.end()) {
+        iter = pending_socks.erase(iter);
+      }
+      else {
+        result->second->refs++;
+        buffers.push_back(result->second);
+        ++iter;
+      }
+    }
+  }
+#ifdef _WIN32
+  MUTEX_UNLOCK(&buffer_cs);
+#else
+  MUTEX_UNLOCK(&buffer_mutex);
+#endif
 
-  case LOAD_MULTI_ARY_SIZE:
-    return LoadMultiArySize(program, inst, op_stack, stack_pos, frame);
+  for(size_t i = 0; i < buffers.size(); ++i) {
+    SocketBuffer* buffer = buffers[i];
+    if(buffer->FlushPending()) {
+      socks.push_back(buffer->sock);
+    }
+    Unreference(buffer);
+  }
+}
 
-  case CPY_CHAR_STR_ARY:
-    return CpyCharStrAry(program, inst, op_stack, stack_pos, frame);
+// note: called with 'read_lock' or 'write_lock' held
+void SocketBuffer::MarkPending()
+{
+  if(is_secure || is_pending.load(std::memory_order_relaxed) || is_pending.exchange(true)) {
+    return;
+  }
 
-  case CPY_CHAR_STR_ARYS:
-    return CpyCharStrArys(program, inst, op_stack, stack_pos, frame);
+#ifdef _WIN32
+  MUTEX_LOCK(&buffer_cs);
+#else
+  MUTEX_LOCK(&buffer_mutex);
+#endif
+  std::unordered_map<size_t, std::vector<const void*>>::iterator found = socket_pollers.find(sock);
+  if(found != socket_pollers.end()) {
+    for(size_t i = 0; i < found->second.size(); ++i) {
+      poller_pending[found->second[i]].insert(sock);
+    }
+  }
+#ifdef _WIN32
+  MUTEX_UNLOCK(&buffer_cs);
+#else
+  MUTEX_UNLOCK(&buffer_mutex);
+#endif
+}
 
-  case CPY_INT_STR_ARY:
-    return CpyIntStrAry(program, inst, op_stack, stack_pos, frame);
+bool SocketBuffer::FlushPending()
+{
+  Lock(&write_lock);
+  FlushOutput();
 
-  case CPY_BOOL_STR_ARY:
-    return CpyBoolStrAry(program, inst, op_stack, stack_pos, frame);
+  // a thread that holds the read lock is consuming the input itself
+  bool is_unread = false;
+#ifdef _WIN32
+  if(TryEnterCriticalSection(&read_lock)) {
+#else
+  if(!pthread_mutex_trylock(&read_lock)) {
+#endif
+    is_unread = in_pos < in_end;
+    // both locks are held, so no call can mark the buffer again until they're released
+    if(!is_unread) {
+#ifdef _WIN32
+      MUTEX_LOCK(&buffer_cs);
+#else
+      MUTEX_LOCK(&buffer_mutex);
+#endif
+      is_pending = false;
+      std::unordered_map<size_t, std::vector<const void*>>::iterator found = socket_pollers.find(sock);
+      if(found != socket_pollers.end()) {
+        for(size_t i = 0; i < found->second.size(); ++i) {
+          std::unordered_map<const void*, std::unordered_set<size_t>>::iterator pending = poller_pending.find(found->second[i]);
+          if(pending != poller_pending.end()) {
+            pending->second.erase(sock);
+          }
+        }
+      }
+#ifdef _WIN32
+      MUTEX_UNLOCK(&buffer_cs);
+#else
+      MUTEX_UNLOCK(&buffer_mutex);
+#endif
+    }
+    MUTEX_UNLOCK(&read_lock);
+  }
+  MUTEX_UNLOCK(&write_lock);
 
-  case CPY_FLOAT_STR_ARY:
-    return CpyFloatStrAry(program, inst, op_stack, stack_pos, frame);
+  return is_unread;
+}
 
-  case STD_OUT_BOOL:
-    return StdOutBool(program, inst, op_stack, stack_pos, frame);
+void SocketBuffer::ReleaseBuffer(size_t key)
+{
+  SocketBuffer* buffer = nullptr;
 
-  case STD_OUT_BYTE:
-    return StdOutByte(program, inst, op_stack, stack_pos, frame);
+#ifdef _WIN32
+  MUTEX_LOCK(&buffer_cs);
+#else
+  MUTEX_LOCK(&buffer_mutex);
+#endif
+  std::unordered_map<size_t, SocketBuffer*>::iterator result = socket_buffers.find(key);
+  if(result != socket_buffers.end()) {
+    buffer = result->second;
+    socket_buffers.erase(result);
+  }
+#ifdef _WIN32
+  MUTEX_UNLOCK(&buffer_cs);
+#else
+  MUTEX_UNLOCK(&buffer_mutex);
+#endif
 
-  case STD_OUT_CHAR:
-    return StdOutChar(program, inst, op_stack, stack_pos, frame);
+  // blocked calls keep their own reference, the buffer is deleted once they leave
+  if(buffer) {
+    buffer->Flush();
+    Unreference(buffer);
+  }
+}
 
-  case STD_OUT_INT:
-    return StdOutInt(program, inst, op_stack, stack_pos, frame);
+int SocketBuffer::Receive(char* buffer, int len)
+{
+  int status = -1;
+  Runtime::ThreadScheduler::BlockingStart();
+  if(is_secure) {
+    status = IPSecureSocket::ReadBytes(buffer, len, ctx, bio);
+  }
+  else if(!has_deadline || WaitReadable()) {
+    status = IPSocket::ReadBytes(buffer, len, (SOCKET)sock);
+  }
+  Runtime::ThreadScheduler::BlockingEnd();
 
-  case STD_OUT_FLOAT:
-    return StdOutFloat(program, inst, op_stack, stack_pos, frame);
-      
-  case STD_INT_FMT:
-    return StdOutIntFrmt(program, inst, op_stack, stack_pos, frame);
-    
-  case STD_FLOAT_FMT:
-    return StdOutFloatFrmt(program, inst, op_stack, stack_pos, frame);
-    
-  case STD_FLOAT_PER:
-    return StdOutFloatPer(program, inst, op_stack, stack_pos, frame);
-    
-  case STD_WIDTH:
-    return StdOutWidth(program, inst, op_stack, stack_pos, frame);
-    
-  case STD_FILL:
-    return StdOutFill(program, inst, op_stack, stack_pos, frame);
+  return status;
+}
 
-  case STD_OUT_STRING:
-    return StdOutString(program, inst, op_stack, stack_pos, frame);
-    
-  case STD_IN_BYTE_ARY_LEN:
-    return StdInByteAryLen(program, inst, op_stack, stack_pos, frame);
+// waits for input until the read deadline, if one is set
+bool SocketBuffer::WaitReadable()
+{
+  if(!has_deadline) {
+    return IPSocket::WaitReady((SOCKET)sock, false, -1);
+  }
 
-  case STD_IN_CHAR_ARY_LEN:
-    return StdInCharAryLen(program, inst, op_stack, stack_pos, frame);
+  // an interrupted wait is retried with the time left
+  while(true) {
+    const long long remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+    if(remaining <= 0) {
+      return false;
+    }
+    else if(IPSocket::WaitReady((SOCKET)sock, false, (int)remaining)) {
+      return true;
+    }
+  }
+}
 
-  case STD_OUT_BYTE_ARY_LEN:
-    return StdOutByteAryLen(program, inst, op_stack, stack_pos, frame);
+void SocketBuffer::SetReadDeadline(long timeout)
+{
+  Lock(&read_lock);
+  has_deadline = timeout > -1;
+  deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout > -1 ? timeout : 0);
+  MUTEX_UNLOCK(&read_lock);
+}
 
-  case STD_OUT_CHAR_ARY_LEN:
-    return StdOutCharAryLen(program, inst, op_stack, stack_pos, frame);
+int SocketBuffer::Send(const char* buffer, int len)
+{
+  Runtime::ThreadScheduler::BlockingStart();
+  if(is_secure) {
+    const int status = IPSecureSocket::WriteBytes(buffer, len, ctx, bio) > 0 ? len : -1;
+    Runtime::ThreadScheduler::BlockingEnd();
+    return status;
+  }
 
-  case STD_IN_STRING:
-    return StdInString(program, inst, op_stack, stack_pos, frame);
+  // send() may accept less than requested
+  int sent = 0;
+  while(sent < len) {
+    const int status = IPSocket::WriteBytes(buffer + sent, len - sent, (SOCKET)sock);
+    if(status <= 0) {
+      // non-blocking socket, wait for room rather than dropping output
+      if(status < 0 && IPSocket::IsPending() && IPSocket::WaitReady((SOCKET)sock, true, -1)) {
+        continue;
+      }
+      sent = -1;
+      break;
+    }
+    sent += status;
+  }
+  Runtime::ThreadScheduler::BlockingEnd();
 
-  case STD_FLUSH:
-    return StdFlush(program, inst, op_stack, stack_pos, frame);
-      
-  case STD_ERR_BOOL:
-    return StdErrBool(program, inst, op_stack, stack_pos, frame);
+  return sent;
+}
+
+// note: called with 'read_lock' held
+int SocketBuffer::Fill(bool is_waiting)
+{
+  // pending output is sent before blocking on a read, peers are often waiting for it
+  if(!Flush()) {
+    return -1;
+  }
+
+  Runtime::ThreadScheduler::BlockingStart();
+  int status = Receive(in_buffer, SOCKET_BUFFER_MAX);
+  // byte and line reads wait on non-blocking sockets so partial input isn't lost
+  while(status < 0 && is_waiting && !is_secure && IPSocket::IsPending() && WaitReadable()) {
+    status = Receive(in_buffer, SOCKET_BUFFER_MAX);
+  }
+  Runtime::ThreadScheduler::BlockingEnd();
+  in_pos = 0;
+  in_end = status > 0 ? status : 0;
+  if(in_end) {
+    MarkPending();
+  }
+
+  return status;
+}
+
+char SocketBuffer::ReadByte(int &status)
+{
+  Lock(&read_lock);
+  const char value = NextByte(status);
+  MUTEX_UNLOCK(&read_lock);
+
+  return value;
+}
+
+// note: called with 'read_lock' held
+char SocketBuffer::NextByte(int &status)
+{
+  if(in_pos == in_end) {
+    status = Fill(true);
+    if(status <= 0) {
+      return '\0';
+    }
+  }
+
+  status = 1;
+  return in_buffer[in_pos++];
+}
+
+int SocketBuffer::ReadBytes(char* buffer, int len)
+{
+  Lock(&read_lock);
+  const int status = NextBytes(buffer, len);
+  MUTEX_UNLOCK(&read_lock);
+
+  return status;
+}
+
+// note: called with 'read_lock' held
+int SocketBuffer::NextBytes(char* buffer, int len)
+{
+  if(len <= 0) {
+    return 0;
+  }
+
+  if(in_pos == in_end) {
+    // large reads bypass the buffer
+    if(len >= SOCKET_BUFFER_MAX) {
+      if(!Flush()) {
+        return -1;
+      }
+      return Receive(buffer, len);
+    }
+
+    const int status = Fill(false);
+    if(status <= 0) {
+      return status;
+    }
+  }
+
+  const int count = in_end - in_pos < len ? in_end - in_pos : len;
+  memcpy(buffer, in_buffer + in_pos, count);
+  in_pos += count;
+
+  return count;
+}
+
+int SocketBuffer::ReadFully(char* buffer, int len)
+{
+  Lock(&read_lock);
+  int read = 0;
+  while(read < len) {
+    const int status = NextBytes(buffer + read, len - read);
+    if(status < 0) {
+      read = -1;
+      break;
+    }
+    else if(!status) {
+      break;
+    }
+    read += status;
+  }
+  MUTEX_UNLOCK(&read_lock);
+
+  return read;
+}
+
+std::string SocketBuffer::ReadLine(size_t max)
+{
+  std::string line;
+
+  Lock(&read_lock);
+  int status = 1;
+  char value = '\0';
+  bool end_line = false;
+  while(!end_line && line.size() < max) {
+    value = NextByte(status);
+    if(status > 0 && value != '\0' && value != '\r' && value != '\n') {
+      line += value;
+    }
+    else {
+      end_line = true;
+    }
+  }
+
+  // consume the LF of a CRLF pair
+  if(status > 0 && value == '\r' && (in_pos < in_end || Fill(true) > 0) && in_buffer[in_pos] == '\n') {
+    in_pos++;
+  }
+  MUTEX_UNLOCK(&read_lock);
+
+  return line;
+}
+
+bool SocketBuffer::WriteByte(char value)
+{
+  Lock(&write_lock);
+  if(out_end == SOCKET_BUFFER_MAX && !FlushOutput()) {
+    MUTEX_UNLOCK(&write_lock);
+    return false;
+  }
+
+  out_buffer[out_end++] = value;
+  MarkPending();
+  MUTEX_UNLOCK(&write_lock);
+
+  return true;
+}
+
+int SocketBuffer::WriteBytes(const char* buffer, int len)
+{
+  if(len <= 0) {
+    return 0;
+  }
+
+  Lock(&write_lock);
+  int status = len;
+  if(out_end + len > SOCKET_BUFFER_MAX && !FlushOutput()) {
+    status = -1;
+  }
+  // large writes bypass the buffer
+  else if(len >= SOCKET_BUFFER_MAX) {
+    status = Send(buffer, len);
+  }
+  else {
+    memcpy(out_buffer + out_end, buffer, len);
+    out_end += len;
+    MarkPending();
+  }
+  MUTEX_UNLOCK(&write_lock);
+
+  return status;
+}
+
+bool SocketBuffer::Flush()
+{
+  Lock(&write_lock);
+  const bool is_sent = FlushOutput();
+  MUTEX_UNLOCK(&write_lock);
+
+  return is_sent;
+}
+
+// note: called with 'write_lock' held
+bool SocketBuffer::FlushOutput()
+{
+  if(!out_end) {
+    return true;
+  }
+
+  const int status = Send(out_buffer, out_end);
+  out_end = 0;
+
+  return status > -1;
+}
+
+/********************************
+ * Serializes an object graph
+ ********************************/
+void TrapProcessor::SerializeObject(size_t* inst, StackFrame* frame, size_t* &op_stack, long* &stack_pos)
+{
+  size_t* obj = (size_t*)frame->mem[1];
+  ObjectSerializer serializer(obj);
+  std::vector<char> src_buffer = serializer.GetValues();
+  const long src_buffer_size = (long)src_buffer.size();
+  size_t* dest_buffer = (size_t*)inst[0];
+  long dest_pos = (long)inst[1];
+
+  // expand buffer, if needed
+  dest_buffer = ExpandSerialBuffer(src_buffer_size, dest_buffer, inst, op_stack, stack_pos);
+  inst[0] = (size_t)dest_buffer;
+
+  // copy content
+  char* dest_buffer_ptr = ((char*)(dest_buffer + 3) + dest_pos);
+  for(int i = 0; i < src_buffer_size; i++, dest_pos++) {
+    dest_buffer_ptr[i] = src_buffer[i];
+  }
+  inst[1] = dest_pos;
+}
+
+/********************************
+ * Deserializes an object graph
+ ********************************/
+void TrapProcessor::DeserializeObject(size_t* inst, size_t* &op_stack, long* &stack_pos) {
+  if(!DeserializeByte(inst)) {
+    PushInt(0, op_stack, stack_pos);
+  }
+  else {
+    size_t* byte_array = (size_t*)inst[0];
+    const long dest_pos = (long)inst[1];
+    const long byte_array_dim_size = (long)byte_array[2];
+    const char* byte_array_ptr = ((char*)(byte_array + 3) + dest_pos);
+
+    ObjectDeserializer deserializer(byte_array_ptr, byte_array_dim_size, op_stack, stack_pos);
+    PushInt((size_t)deserializer.DeserializeObject(), op_stack, stack_pos);
+    inst[1] = dest_pos + deserializer.GetOffset();
+  }
+}
+
+/********************************
+ * Handles callback traps from
+ * the interpreter and JIT code
+ ********************************/
+bool TrapProcessor::ProcessTrap(StackProgram* program, size_t* inst,
+                                size_t* &op_stack, long* &stack_pos, StackFrame* frame) {
+  const INT64_VALUE id = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  switch(id) {
+  case LOAD_CLS_INST_ID:
+    return LoadClsInstId(program, inst, op_stack, stack_pos, frame);
+
+  case STRING_HASH_ID:
+    return HashStringId(program, inst, op_stack, stack_pos, frame);
+
+  case STRING_COMPARE:
+    return CompareString(program, inst, op_stack, stack_pos, frame);
+
+  case LOAD_NEW_OBJ_INST:
+    return LoadNewObjInst(program, inst, op_stack, stack_pos, frame);
+
+  case LOAD_CLS_BY_INST:
+    return LoadClsByInst(program, inst, op_stack, stack_pos, frame);
+
+  case BYTES_TO_UNICODE:
+    return ConvertBytesToUnicode(program, inst, op_stack, stack_pos, frame);
+
+  case UNICODE_TO_BYTES:
+    return ConvertUnicodeToBytes(program, inst, op_stack, stack_pos, frame);
+
+  case LOAD_MULTI_ARY_SIZE:
+    return LoadMultiArySize(program, inst, op_stack, stack_pos, frame);
+
+  case CPY_CHAR_STR_ARY:
+    return CpyCharStrAry(program, inst, op_stack, stack_pos, frame);
+
+  case CPY_CHAR_STR_ARYS:
+    return CpyCharStrArys(program, inst, op_stack, stack_pos, frame);
+
+  case CPY_INT_STR_ARY:
+    return CpyIntStrAry(program, inst, op_stack, stack_pos, frame);
+
+  case CPY_BOOL_STR_ARY:
+    return CpyBoolStrAry(program, inst, op_stack, stack_pos, frame);
+
+  case CPY_FLOAT_STR_ARY:
+    return CpyFloatStrAry(program, inst, op_stack, stack_pos, frame);
+
+  case STD_OUT_BOOL:
+    return StdOutBool(program, inst, op_stack, stack_pos, frame);
+
+  case STD_OUT_BYTE:
+    return StdOutByte(program, inst, op_stack, stack_pos, frame);
+
+  case STD_OUT_CHAR:
+    return StdOutChar(program, inst, op_stack, stack_pos, frame);
+
+  case STD_OUT_INT:
+    return StdOutInt(program, inst, op_stack, stack_pos, frame);
+
+  case STD_OUT_FLOAT:
+    return StdOutFloat(program, inst, op_stack, stack_pos, frame);
+      
+  case STD_INT_FMT:
+    return StdOutIntFrmt(program, inst, op_stack, stack_pos, frame);
+    
+  case STD_FLOAT_FMT:
+    return StdOutFloatFrmt(program, inst, op_stack, stack_pos, frame);
+    
+  case STD_FLOAT_PER:
+    return StdOutFloatPer(program, inst, op_stack, stack_pos, frame);
+    
+  case STD_WIDTH:
+    return StdOutWidth(program, inst, op_stack, stack_pos, frame);
+    
+  case STD_FILL:
+    return StdOutFill(program, inst, op_stack, stack_pos, frame);
+
+  case STD_OUT_STRING:
+    return StdOutString(program, inst, op_stack, stack_pos, frame);
+    
+  case STD_IN_BYTE_ARY_LEN:
+    return StdInByteAryLen(program, inst, op_stack, stack_pos, frame);
+
+  case STD_IN_CHAR_ARY_LEN:
+    return StdInCharAryLen(program, inst, op_stack, stack_pos, frame);
+
+  case STD_OUT_BYTE_ARY_LEN:
+    return StdOutByteAryLen(program, inst, op_stack, stack_pos, frame);
+
+  case STD_OUT_CHAR_ARY_LEN:
+    return StdOutCharAryLen(program, inst, op_stack, stack_pos, frame);
+
+  case STD_IN_STRING:
+    return StdInString(program, inst, op_stack, stack_pos, frame);
+
+  case STD_FLUSH:
+    return StdFlush(program, inst, op_stack, stack_pos, frame);
+      
+  case STD_ERR_BOOL:
+    return StdErrBool(program, inst, op_stack, stack_pos, frame);
 
   case STD_ERR_BYTE:
     return StdErrByte(program, inst, op_stack, stack_pos, frame);
@@ -2092,6 +2672,9 @@ bool TrapProcessor::ProcessTrap(StackProgram* program, size_t* inst,
   case TIMER_ELAPSED:
     return TimerElapsed(program, inst, op_stack, stack_pos, frame);
 
+  case TIMER_TICKS:
+    return TimerTicks(program, inst, op_stack, stack_pos, frame);
+
   case GET_PLTFRM:
     return GetPltfrm(program, inst, op_stack, stack_pos, frame);
 
@@ -2355,49 +2938,217 @@ bool TrapProcessor::ProcessTrap(StackProgram* program, size_t* inst,
   case SOCK_TCP_SSL_OUT_CHAR_ARY:
     return SockTcpSslOutCharAry(program, inst, op_stack, stack_pos, frame);
 
-  case FILE_IN_BYTE:
-    return FileInByte(program, inst, op_stack, stack_pos, frame);
+  case SOCK_TCP_FLUSH:
+    return SockTcpFlush(program, inst, op_stack, stack_pos, frame);
 
-  case FILE_IN_CHAR_ARY:
-    return FileInCharAry(program, inst, op_stack, stack_pos, frame);
+  case SOCK_TCP_SSL_FLUSH:
+    return SockTcpSslFlush(program, inst, op_stack, stack_pos, frame);
 
-  case FILE_IN_BYTE_ARY:
-    return FileInByteAry(program, inst, op_stack, stack_pos, frame);
+  case SOCK_TCP_SET_BLOCKING:
+    return SockTcpSetBlocking(program, inst, op_stack, stack_pos, frame);
 
-  case FILE_OUT_BYTE:
-    return FileOutByte(program, inst, op_stack, stack_pos, frame);
+  case SOCK_TCP_SET_DEADLINE:
+    return SockTcpSetDeadline(program, inst, op_stack, stack_pos, frame);
 
-  case FILE_OUT_BYTE_ARY:
-    return FileOutByteAry(program, inst, op_stack, stack_pos, frame);
+  case SOCK_POLL_CREATE:
+    return SockPollCreate(program, inst, op_stack, stack_pos, frame);
 
-  case FILE_OUT_CHAR_ARY:
-    return FileOutCharAry(program, inst, op_stack, stack_pos, frame);
+  case SOCK_POLL_ADD:
+    return SockPollAdd(program, inst, op_stack, stack_pos, frame);
 
-  case FILE_SEEK:
-    return FileSeek(program, inst, op_stack, stack_pos, frame);
+  case SOCK_POLL_REMOVE:
+    return SockPollRemove(program, inst, op_stack, stack_pos, frame);
 
-  case FILE_EOF:
-    return FileEof(program, inst, op_stack, stack_pos, frame);
+  case SOCK_POLL_WAIT:
+    return SockPollWait(program, inst, op_stack, stack_pos, frame);
 
-  case FILE_IS_OPEN:
-    return FileIsOpen(program, inst, op_stack, stack_pos, frame);
+  case SOCK_POLL_CLOSE:
+    return SockPollClose(program, inst, op_stack, stack_pos, frame);
 
-  case FILE_EXISTS:
-    return FileExists(program, inst, op_stack, stack_pos, frame);
+  case EXECUTOR_SUBMIT:
+    return ExecutorSubmit(program, inst, op_stack, stack_pos, frame);
 
-  case FILE_CAN_WRITE_ONLY:
-    return FileCanWriteOnly(program, inst, op_stack, stack_pos, frame);
+  case EXECUTOR_SIZE:
+    return ExecutorSize(program, inst, op_stack, stack_pos, frame);
 
-  case FILE_CAN_READ_ONLY:
-    return FileCanReadOnly(program, inst, op_stack, stack_pos, frame);
+  case EXECUTOR_WAIT:
+    return ExecutorWait(program, inst, op_stack, stack_pos, frame);
 
-  case FILE_CAN_READ_WRITE:
-    return FileCanReadWrite(program, inst, op_stack, stack_pos, frame);
+  case EXECUTOR_NOTIFY:
+    return ExecutorNotify(program, inst, op_stack, stack_pos, frame);
 
-  case FILE_SIZE:
-    return FileSize(program, inst, op_stack, stack_pos, frame);
+  case ATOMIC_LOAD:
+    return AtomicLoad(program, inst, op_stack, stack_pos, frame);
 
-  case FILE_FULL_PATH:
+  case ATOMIC_STORE:
+    return AtomicStore(program, inst, op_stack, stack_pos, frame);
+
+  case ATOMIC_ADD:
+    return AtomicAdd(program, inst, op_stack, stack_pos, frame);
+
+  case ATOMIC_SWAP:
+    return AtomicSwap(program, inst, op_stack, stack_pos, frame);
+
+  case ATOMIC_CAS:
+    return AtomicCas(program, inst, op_stack, stack_pos, frame);
+
+  case ATOMIC_ARY_LOAD:
+    return AtomicAryLoad(program, inst, op_stack, stack_pos, frame);
+
+  case ATOMIC_ARY_STORE:
+    return AtomicAryStore(program, inst, op_stack, stack_pos, frame);
+
+  case ATOMIC_ARY_ADD:
+    return AtomicAryAdd(program, inst, op_stack, stack_pos, frame);
+
+  case ATOMIC_ARY_SWAP:
+    return AtomicArySwap(program, inst, op_stack, stack_pos, frame);
+
+  case ATOMIC_ARY_CAS:
+    return AtomicAryCas(program, inst, op_stack, stack_pos, frame);
+
+  case COND_VAR_INIT:
+    return ConditionInit(program, inst, op_stack, stack_pos, frame);
+
+  case COND_VAR_WAIT:
+    return ConditionWait(program, inst, op_stack, stack_pos, frame);
+
+  case COND_VAR_SIGNAL:
+    return ConditionSignal(program, inst, op_stack, stack_pos, frame);
+
+  case COND_VAR_BROADCAST:
+    return ConditionBroadcast(program, inst, op_stack, stack_pos, frame);
+
+  case SEMAPHORE_INIT:
+    return SemaphoreInit(program, inst, op_stack, stack_pos, frame);
+
+  case SEMAPHORE_ACQUIRE:
+    return SemaphoreAcquire(program, inst, op_stack, stack_pos, frame);
+
+  case SEMAPHORE_TRY_ACQUIRE:
+    return SemaphoreTryAcquire(program, inst, op_stack, stack_pos, frame);
+
+  case SEMAPHORE_RELEASE:
+    return SemaphoreRelease(program, inst, op_stack, stack_pos, frame);
+
+  case RW_LOCK_INIT:
+    return ReadWriteInit(program, inst, op_stack, stack_pos, frame);
+
+  case RW_LOCK_READ:
+    return ReadLock(program, inst, op_stack, stack_pos, frame);
+
+  case RW_UNLOCK_READ:
+    return ReadUnlock(program, inst, op_stack, stack_pos, frame);
+
+  case RW_LOCK_WRITE:
+    return WriteLock(program, inst, op_stack, stack_pos, frame);
+
+  case RW_UNLOCK_WRITE:
+    return WriteUnlock(program, inst, op_stack, stack_pos, frame);
+
+  case PARALLEL_SORT_INT:
+    return ParallelSortInt(program, inst, op_stack, stack_pos, frame);
+
+  case PARALLEL_SORT_FLOAT:
+    return ParallelSortFloat(program, inst, op_stack, stack_pos, frame);
+
+  case PARALLEL_SCAN_INT:
+    return ParallelScanInt(program, inst, op_stack, stack_pos, frame);
+
+  case PARALLEL_SCAN_FLOAT:
+    return ParallelScanFloat(program, inst, op_stack, stack_pos, frame);
+
+  case MAPPED_FILE_OPEN:
+    return MappedFileOpen(program, inst, op_stack, stack_pos, frame);
+
+  case MAPPED_FILE_CLOSE:
+    return MappedFileClose(program, inst, op_stack, stack_pos, frame);
+
+  case MAPPED_FILE_IN_BYTE:
+    return MappedFileInByte(program, inst, op_stack, stack_pos, frame);
+
+  case MAPPED_FILE_IN_BYTE_ARY:
+    return MappedFileInByteAry(program, inst, op_stack, stack_pos, frame);
+
+  case MAPPED_FILE_FIND_BYTE:
+    return MappedFileFindByte(program, inst, op_stack, stack_pos, frame);
+
+  case MAPPED_FILE_IN_LINE:
+    return MappedFileInLine(program, inst, op_stack, stack_pos, frame);
+
+  case MAPPED_FILE_IN_STRING:
+    return MappedFileInString(program, inst, op_stack, stack_pos, frame);
+
+  case JSON_TAPE_INDEX:
+    return JsonTapeIndex(program, inst, op_stack, stack_pos, frame);
+
+  case BYTES_TO_STRING:
+    return BytesToString(program, inst, op_stack, stack_pos, frame);
+
+  case CSV_INDEX:
+    return CsvIndex(program, inst, op_stack, stack_pos, frame);
+
+  case CSV_INTS:
+    return CsvInts(program, inst, op_stack, stack_pos, frame);
+
+  case CSV_FLOATS:
+    return CsvFloats(program, inst, op_stack, stack_pos, frame);
+
+  case XML_INDEX:
+    return XmlIndex(program, inst, op_stack, stack_pos, frame);
+
+  case XML_DECODE:
+    return XmlDecode(program, inst, op_stack, stack_pos, frame);
+
+  case STRING_UTF8_ENCODE:
+    return StringUtf8Encode(program, inst, op_stack, stack_pos, frame);
+
+  case REGEX_EXECUTE:
+    return RegexExecute(program, inst, op_stack, stack_pos, frame);
+
+  case FILE_IN_BYTE:
+    return FileInByte(program, inst, op_stack, stack_pos, frame);
+
+  case FILE_IN_CHAR_ARY:
+    return FileInCharAry(program, inst, op_stack, stack_pos, frame);
+
+  case FILE_IN_BYTE_ARY:
+    return FileInByteAry(program, inst, op_stack, stack_pos, frame);
+
+  case FILE_OUT_BYTE:
+    return FileOutByte(program, inst, op_stack, stack_pos, frame);
+
+  case FILE_OUT_BYTE_ARY:
+    return FileOutByteAry(program, inst, op_stack, stack_pos, frame);
+
+  case FILE_OUT_CHAR_ARY:
+    return FileOutCharAry(program, inst, op_stack, stack_pos, frame);
+
+  case FILE_SEEK:
+    return FileSeek(program, inst, op_stack, stack_pos, frame);
+
+  case FILE_EOF:
+    return FileEof(program, inst, op_stack, stack_pos, frame);
+
+  case FILE_IS_OPEN:
+    return FileIsOpen(program, inst, op_stack, stack_pos, frame);
+
+  case FILE_EXISTS:
+    return FileExists(program, inst, op_stack, stack_pos, frame);
+
+  case FILE_CAN_WRITE_ONLY:
+    return FileCanWriteOnly(program, inst, op_stack, stack_pos, frame);
+
+  case FILE_CAN_READ_ONLY:
+    return FileCanReadOnly(program, inst, op_stack, stack_pos, frame);
+
+  case FILE_CAN_READ_WRITE:
+    return FileCanReadWrite(program, inst, op_stack, stack_pos, frame);
+
+  case FILE_SIZE:
+    return FileSize(program, inst, op_stack, stack_pos, frame);
+
+  case FILE_FULL_PATH:
     return FileFullPath(program, inst, op_stack, stack_pos, frame);
 
   case FILE_TEMP_NAME:
@@ -2484,6 +3235,31 @@ bool TrapProcessor::HashStringId(StackProgram* program, size_t* inst, size_t*& o
   return true;
 }
 
+bool TrapProcessor::CompareString(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  size_t* rhs_obj = (size_t*)PopInt(op_stack, stack_pos);
+  size_t* str_obj = (size_t*)PopInt(op_stack, stack_pos);
+
+  // other classes order before strings
+  if(!rhs_obj || MemoryManager::GetClass(rhs_obj) != MemoryManager::GetClass(str_obj)) {
+    PushInt(-1, op_stack, stack_pos);
+    return true;
+  }
+
+  const wchar_t* left = (wchar_t*)((size_t*)str_obj[0] + 3);
+  const size_t left_size = str_obj[2];
+  const wchar_t* right = (wchar_t*)((size_t*)rhs_obj[0] + 3);
+  const size_t right_size = rhs_obj[2];
+
+  int result = wmemcmp(left, right, std::min(left_size, right_size));
+  if(!result && left_size != right_size) {
+    result = left_size < right_size ? -1 : 1;
+  }
+  PushInt(result < 0 ? -1 : (result > 0 ? 1 : 0), op_stack, stack_pos);
+
+  return true;
+}
+
 bool TrapProcessor::LoadClsInstId(StackProgram* program, size_t* inst, size_t* &op_stack, long* &stack_pos, StackFrame* frame)
 {
   size_t* obj = (size_t*)PopInt(op_stack, stack_pos);
@@ -2536,10 +3312,11 @@ bool TrapProcessor::ConvertBytesToUnicode(StackProgram* program, size_t* inst, s
     std::wcerr << L">>> Attempting to dereference a 'Nil' memory instance <<<" << std::endl;
     return false;
   }
-  const std::wstring out = BytesToUnicode((char*)(array + 3));
+  const char* bytes = (char*)(array + 3);
+  const size_t bytes_size = strnlen(bytes, array[0]);
 
   // create character array
-  const long char_array_size = (long)out.size();
+  const long char_array_size = (long)Utf8Length(bytes, bytes_size);
   const long char_array_dim = 1;
   size_t* char_array = MemoryManager::AllocateArray(char_array_size + 1 + ((char_array_dim + 2) * sizeof(size_t)), 
                                                     CHAR_ARY_TYPE, op_stack, *stack_pos, false);
@@ -2547,13 +3324,8 @@ bool TrapProcessor::ConvertBytesToUnicode(StackProgram* program, size_t* inst, s
   char_array[1] = char_array_dim;
   char_array[2] = char_array_size;
 
-  // copy string
-  wchar_t* char_array_ptr = (wchar_t*)(char_array + 3);
-#ifdef _WIN32
-  wcsncpy_s(char_array_ptr, char_array_size + 1, out.c_str(), char_array_size);
-#else
-  wcsncpy(char_array_ptr, out.c_str(), char_array_size);
-#endif
+  // decode string
+  Utf8Decode(bytes, bytes_size, (wchar_t*)(char_array + 3));
 
   // push result
   PushInt((size_t)char_array, op_stack, stack_pos);
@@ -2568,10 +3340,11 @@ bool TrapProcessor::ConvertUnicodeToBytes(StackProgram* program, size_t* inst, s
     std::wcerr << L">>> Attempting to dereference a 'Nil' memory instance <<<" << std::endl;
     return false;
   }
-  const std::string out = UnicodeToBytes((wchar_t*)(array + 3));
+  const wchar_t* chars = (wchar_t*)(array + 3);
+  const size_t chars_size = wcsnlen(chars, array[0]);
 
   // create byte array
-  const long byte_array_size = (long)out.size();
+  const long byte_array_size = (long)Utf8EncodedLength(chars, chars_size);
   const long byte_array_dim = 1;
   size_t* byte_array = MemoryManager::AllocateArray(byte_array_size + 1 + ((byte_array_dim + 2) * sizeof(size_t)),
                                                     BYTE_ARY_TYPE, op_stack, *stack_pos, false);
@@ -2579,13 +3352,8 @@ bool TrapProcessor::ConvertUnicodeToBytes(StackProgram* program, size_t* inst, s
   byte_array[1] = byte_array_dim;
   byte_array[2] = byte_array_size;
 
-  // copy bytes
-  char* byte_array_ptr = (char*)(byte_array + 3);
-#ifdef _WIN32
-  strncpy_s(byte_array_ptr, byte_array_size + 1, out.c_str(), byte_array_size);
-#else
-  strncpy(byte_array_ptr, out.c_str(), byte_array_size);
-#endif
+  // encode string
+  Utf8Encode(chars, chars_size, (char*)(byte_array + 3));
   
   // push result
   PushInt((size_t)byte_array, op_stack, stack_pos);
@@ -2995,7 +3763,10 @@ bool TrapProcessor::StdInByteAryLen(StackProgram* program, size_t* inst, size_t*
 
   if(array && offset > -1 && offset + num <= (long)array[0]) {
     char* buffer = (char*)(array + 3);
-    PushInt(fread(buffer + offset, num, 1, stdin), op_stack, stack_pos);
+    Runtime::ThreadScheduler::BlockingStart();
+    const size_t read = fread(buffer + offset, num, 1, stdin);
+    Runtime::ThreadScheduler::BlockingEnd();
+    PushInt(read, op_stack, stack_pos);
   }
   else {
     PushInt(-1, op_stack, stack_pos);
@@ -3015,19 +3786,13 @@ bool TrapProcessor::StdInCharAryLen(StackProgram* program, size_t* inst, size_t*
 #endif
 
   if(array && offset > -1 && offset + num <= (long)array[0]) {
-    wchar_t* buffer = (wchar_t*)(array + 3);
     // allocate temporary buffer
-    char* byte_buffer = new char[num * 2 + 1];
-    size_t read = fread(byte_buffer + offset, 1, num, stdin);
+    char* byte_buffer = new char[num + 1];
+    Runtime::ThreadScheduler::BlockingStart();
+    size_t read = fread(byte_buffer, 1, num, stdin);
+    Runtime::ThreadScheduler::BlockingEnd();
     if(read) {
-      byte_buffer[read] = '\0';
-      std::wstring in = BytesToUnicode(byte_buffer);
-#ifdef _WIN32
-      wcsncpy_s(buffer, array[0] + 1, in.c_str(), in.size());
-#else
-      wcsncpy(buffer, in.c_str(), in.size());
-#endif
-      PushInt(in.size(), op_stack, stack_pos);
+      PushInt(DecodeCharArray(byte_buffer, read, array, offset, false), op_stack, stack_pos);
     }
     else {
       PushInt(-1, op_stack, stack_pos);
@@ -3048,6 +3813,7 @@ bool TrapProcessor::StdInString(StackProgram* program, size_t* inst, size_t*& op
   size_t* array = (size_t*)PopInt(op_stack, stack_pos);
   if(array) {
     std::wstring wbuffer;
+    Runtime::ThreadScheduler::BlockingStart();
     if(Runtime::StackInterpreter::IsBinaryStdio()) {
       std::string buffer;
       std::getline(std::cin, buffer);
@@ -3056,6 +3822,7 @@ bool TrapProcessor::StdInString(StackProgram* program, size_t* inst, size_t*& op
     else {
       std::getline(std::wcin, wbuffer);
     }
+    Runtime::ThreadScheduler::BlockingEnd();
 
     // copy to dest
     wchar_t* dest = (wchar_t*)(array + 3);
@@ -3080,12 +3847,19 @@ bool TrapProcessor::StdOutByteAryLen(StackProgram* program, size_t* inst, size_t
 #endif
 
   if(array && offset > -1 && offset + num <= (long)array[0]) {
-    const char* buffer = (char*)(array + 3);
+    const char* buffer = (char*)(array + 3) + offset;
 #ifdef _MODULE_STDIO
-    const std::wstring wide_buffer(BytesToUnicode(buffer));
+    const std::wstring wide_buffer(BytesToUnicode(std::string(buffer, num)));
     program->output_buffer.write(wide_buffer.c_str(), wide_buffer.size());
+    PushInt(num, op_stack, stack_pos);
+#elif defined(_WIN32)
+    // console is in UTF-16 text mode
+    std::wcout << BytesToUnicode(std::string(buffer, num));
+    PushInt(num, op_stack, stack_pos);
 #else
-    PushInt(fwrite(buffer, 1, num, stdout), op_stack, stack_pos);
+    // stdout is wide oriented once 'wcout' has been used, write the bytes after anything it has buffered
+    std::wcout.flush();
+    PushInt(write(STDOUT_FILENO, buffer, num), op_stack, stack_pos);
 #endif
   }
   else {
@@ -3285,7 +4059,10 @@ bool TrapProcessor::SysCmd(StackProgram* program, size_t* inst, size_t*& op_stac
   array = (size_t*)array[0];
   if(array) {
     const std::string cmd = UnicodeToBytes((wchar_t*)(array + 3));
-    PushInt(system(cmd.c_str()), op_stack, stack_pos);
+    Runtime::ThreadScheduler::BlockingStart();
+    const int status = system(cmd.c_str());
+    Runtime::ThreadScheduler::BlockingEnd();
+    PushInt(status, op_stack, stack_pos);
   }
 
   return true;
@@ -3389,7 +4166,9 @@ bool TrapProcessor::SysCmdOut(StackProgram* program, size_t* inst, size_t*& op_s
     const std::string cmd = UnicodeToBytes((wchar_t*)(str_array + 3));
 
     int status;
+    Runtime::ThreadScheduler::BlockingStart();
     std::vector<std::string> output_lines = System::CommandOutput(cmd.c_str(), status);
+    Runtime::ThreadScheduler::BlockingEnd();
     
     // create 'System.String' object array
     const long str_obj_array_size = (long)output_lines.size();
@@ -3617,6 +4396,15 @@ bool TrapProcessor::TimerElapsed(StackProgram* program, size_t* inst, size_t* &o
   return true;
 }
 
+bool TrapProcessor::TimerTicks(StackProgram* program, size_t* inst, size_t* &op_stack, long* &stack_pos, StackFrame* frame)
+{
+  // monotonic milliseconds, unaffected by wall clock changes
+  const auto ticks = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch());
+  PushInt((INT64_VALUE)ticks.count(), op_stack, stack_pos);
+
+  return true;
+}
+
 bool TrapProcessor::GetPltfrm(StackProgram* program, size_t* inst, size_t* &op_stack, long* &stack_pos, StackFrame* frame)
 {
   ProcessPlatform(program, op_stack, stack_pos);
@@ -3806,7 +4594,9 @@ bool TrapProcessor::SockTcpConnect(StackProgram* program, size_t* inst, size_t*
   if(array && instance) {
     array = (size_t*)array[0];
     const std::string addr = UnicodeToBytes((wchar_t*)(array + 3));
+    Runtime::ThreadScheduler::BlockingStart();
     SOCKET sock = IPSocket::Open(addr.c_str(), port);
+    Runtime::ThreadScheduler::BlockingEnd();
 #ifdef _DEBUG
     std::wcout << L"# socket connect: addr='" << BytesToUnicode(addr) << "'; instance="
 	       << instance << L"(" << (size_t)instance << L")" << L"; addr=" << sock << L"("
@@ -3868,7 +4658,9 @@ bool TrapProcessor::SockTcpAccept(StackProgram* program, size_t* inst, size_t* &
     SOCKET server = (SOCKET)instance[0];
     char client_address[SMALL_BUFFER_MAX] = {0};
     int client_port;
+    Runtime::ThreadScheduler::BlockingStart();
     SOCKET client = IPSocket::Accept(server, client_address, client_port);
+    Runtime::ThreadScheduler::BlockingEnd();
 #ifdef _DEBUG
     std::wcout << L"# socket accept: instance=" << instance << L"(" << (size_t)instance << L")" << L"; ip="
       << BytesToUnicode(client_address) << L"; port=" << client_port << L"; addr=" << server << L"("
@@ -3896,6 +4688,7 @@ bool TrapProcessor::SockTcpClose(StackProgram* program, size_t* inst, size_t* &o
     std::wcout << L"# socket close: addr=" << sock << L"(" << (long)sock << L") #" << std::endl;
 #endif  
     instance[0] = 0;
+    SocketBuffer::ReleaseSocketBuffer(sock);
     IPSocket::Close(sock);
   }
 
@@ -3915,7 +4708,7 @@ bool TrapProcessor::SockTcpOutString(StackProgram* program, size_t* inst, size_t
 #endif        
     if((long)sock > -1) {
       const std::string data = UnicodeToBytes((wchar_t*)(array + 3));
-      IPSocket::WriteBytes(data.c_str(), (int)data.size(), sock);
+      SocketBuffer::GetSocketBuffer(sock)->WriteBytes(data.c_str(), (int)data.size());
     }
   }
 
@@ -3927,39 +4720,13 @@ bool TrapProcessor::SockTcpInString(StackProgram* program, size_t* inst, size_t*
   size_t* array = (size_t*)PopInt(op_stack, stack_pos);
   size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
   if(array && instance && (long)instance[0] > -1) {
-    char buffer[MID_BUFFER_MAX] = {0};
     SOCKET sock = (SOCKET)instance[0];
-    int status;
 
     if((long)sock > -1) {
-      int index = 0;
-      char value;
-      bool end_line = false;
-      do {
-        value = IPSocket::ReadByte(sock, status);
-        if(value != '\0' && value != '\r' && value != '\n' && index < MID_BUFFER_MAX - 1 && status > 0) {
-          buffer[index++] = value;
-        }
-        else {
-          end_line = true;
-        }
-      }
-      while(!end_line && index < (int)array[0] - 1);
-      buffer[index] = '\0';
-
-      // assume LF
-      if(value == '\r') {
-        IPSocket::ReadByte(sock, status);
-      }
+      const std::string line = SocketBuffer::GetSocketBuffer(sock)->ReadLine(array[0] - 1);
 
       // copy content
-      const std::wstring in = BytesToUnicode(buffer);
-      wchar_t* out = (wchar_t*)(array + 3);
-#ifdef _WIN32
-      wcsncpy_s(out, array[0] + 1, in.c_str(), in.size());
-#else
-      wcsncpy(out, in.c_str(), in.size());
-#endif
+      DecodeCharArray(line.c_str(), line.size(), array, 0, false);
     }
   }
 
@@ -3975,10 +4742,13 @@ bool TrapProcessor::SockTcpSslConnect(StackProgram* program, size_t* inst, size_
     array = (size_t*)array[0];
     const std::string addr = UnicodeToBytes((wchar_t*)(array + 3));
 
+    SocketBuffer::ReleaseSecureBuffer((BIO*)instance[1]);
     IPSecureSocket::Close((SSL_CTX*)instance[0], (BIO*)instance[1], (X509*)instance[2]);
 
     SSL_CTX* ctx; BIO* bio; X509* cert;
+    Runtime::ThreadScheduler::BlockingStart();
     bool is_open = IPSecureSocket::Open(addr.c_str(), port, ctx, bio, cert);
+    Runtime::ThreadScheduler::BlockingEnd();
     instance[0] = (size_t)ctx;
     instance[1] = (size_t)bio;
     instance[2] = (size_t)cert;
@@ -4039,6 +4809,7 @@ bool TrapProcessor::SockTcpSslClose(StackProgram* program, size_t* inst, size_t*
   std::wcout << L"# socket close: addr=" << ctx << L"|" << bio << L"("
     << (size_t)ctx << L"|" << (size_t)bio << L") #" << std::endl;
 #endif      
+  SocketBuffer::ReleaseSecureBuffer(bio);
   IPSecureSocket::Close(ctx, bio, cert);
   instance[0] = instance[1] = instance[2] = instance[3] = 0;
 
@@ -4054,7 +4825,7 @@ bool TrapProcessor::SockTcpSslOutString(StackProgram* program, size_t* inst, siz
     BIO* bio = (BIO*)instance[1];
     if(instance[3]) {
       const std::string out = UnicodeToBytes((wchar_t*)(array + 3));
-      IPSecureSocket::WriteBytes(out.c_str(), (int)out.size(), ctx, bio);
+      SocketBuffer::GetSecureBuffer(ctx, bio)->WriteBytes(out.c_str(), (int)out.size());
     }
   }
 
@@ -4066,39 +4837,13 @@ bool TrapProcessor::SockTcpSslInString(StackProgram* program, size_t* inst, size
   size_t* array = (size_t*)PopInt(op_stack, stack_pos);
   size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
   if(array && instance) {
-    char buffer[MID_BUFFER_MAX] = {0};
     SSL_CTX* ctx = (SSL_CTX*)instance[0];
     BIO* bio = (BIO*)instance[1];
-    int status;
     if(instance[3]) {
-      size_t index = 0;
-      char value;
-      bool end_line = false;
-      do {
-        value = IPSecureSocket::ReadByte(ctx, bio, status);
-        if(value != '\0' && value != '\r' && value != '\n' && index < MID_BUFFER_MAX - 1 && status > 0) {
-          buffer[index++] = value;
-        }
-        else {
-          end_line = true;
-        }
-      }
-      while(!end_line && index < array[0] - 1);
-      buffer[index] = '\0';
-
-      // assume LF
-      if(value == '\r') {
-        IPSecureSocket::ReadByte(ctx, bio, status);
-      }
+      const std::string line = SocketBuffer::GetSecureBuffer(ctx, bio)->ReadLine(array[0] - 1);
 
       // copy content
-      const std::wstring in = BytesToUnicode(buffer);
-      wchar_t* out = (wchar_t*)(array + 3);
-#ifdef _WIN32
-      wcsncpy_s(out, array[0], in.c_str(), in.size());
-#else
-      wcsncpy(out, in.c_str(), in.size());
-#endif
+      DecodeCharArray(line.c_str(), line.size(), array, 0, false);
     }
   }
 
@@ -4202,10 +4947,13 @@ bool TrapProcessor::SockTcpSslAccept(StackProgram* program, size_t* inst, size_t
     BIO* bio = (BIO*)instance[1];
     
     if(server_bio && bio) {
+      Runtime::ThreadScheduler::BlockingStart();
       BIO_do_accept(server_bio);
 
       BIO* client_bio = BIO_pop(server_bio);
-      if(BIO_do_handshake(client_bio) <= 0) {
+      const bool is_shaken = BIO_do_handshake(client_bio) > 0;
+      Runtime::ThreadScheduler::BlockingEnd();
+      if(!is_shaken) {
         BIO_free_all(client_bio);
         PushInt(0, op_stack, stack_pos);
         return true;
@@ -4875,7 +5623,10 @@ bool TrapProcessor::FileInString(StackProgram* program, size_t* inst, size_t* &o
   if(array && instance && instance[0]) {
     FILE* file = (FILE*)instance[0];
     char buffer[MID_BUFFER_MAX] = {0};
-    if(file && fgets(buffer, MID_BUFFER_MAX - 1, file)) {
+    Runtime::ThreadScheduler::BlockingStart();
+    const bool is_read = file && fgets(buffer, MID_BUFFER_MAX - 1, file);
+    Runtime::ThreadScheduler::BlockingEnd();
+    if(is_read) {
       long end_index = (long)strlen(buffer) - 1;
       if(end_index > -1) {
         if(buffer[end_index] == '\n' || buffer[end_index] == '\r') {
@@ -4890,18 +5641,8 @@ bool TrapProcessor::FileInString(StackProgram* program, size_t* inst, size_t* &o
         buffer[0] = '\0';
       }
       
-      // copy and remove file BOM UTF (8, 16, 32)
-      std::wstring in = BytesToUnicode(buffer);
-      if(in.size() > 0 && (in[0] == (wchar_t)0xFEFF || in[0] == (wchar_t)0xFFFE || in[0] == (wchar_t)0xFFFE0000 || in[0] == (wchar_t)0xEFBBBF)) {
-        in.erase(in.begin(), in.begin() + 1);
-      }
-
-      wchar_t* out = (wchar_t*)(array + 3);
-#ifdef _WIN32
-      wcsncpy_s(out, array[0], in.c_str(), in.size());
-#else
-      wcsncpy(out, in.c_str(), in.size());
-#endif
+      // copy and remove file BOM
+      DecodeCharArray(buffer, strlen(buffer), array, 0, true);
     }
   }
 
@@ -4966,7 +5707,10 @@ bool TrapProcessor::PipeConnect(StackProgram* program, size_t* inst, size_t*& op
   if(instance && instance[0] && (int)instance[1] == -3 /* Mode->CREATE */) {
 #ifdef _WIN32
     const HANDLE pipe = (HANDLE)instance[0];
-    if(Pipe::OpenServer(pipe)) {
+    Runtime::ThreadScheduler::BlockingStart();
+    const bool is_open = Pipe::OpenServer(pipe);
+    Runtime::ThreadScheduler::BlockingEnd();
+    if(is_open) {
       PushInt(1, op_stack, stack_pos);
     }
     else {
@@ -4975,7 +5719,10 @@ bool TrapProcessor::PipeConnect(StackProgram* program, size_t* inst, size_t*& op
 #else
     int client_pipe;
     const int server_pipe = (int)instance[0];
-    if(Pipe::OpenServer(server_pipe, client_pipe)) {
+    Runtime::ThreadScheduler::BlockingStart();
+    const bool is_open = Pipe::OpenServer(server_pipe, client_pipe);
+    Runtime::ThreadScheduler::BlockingEnd();
+    if(is_open) {
       instance[0] = client_pipe;
       PushInt(1, op_stack, stack_pos);
     }
@@ -5007,7 +5754,10 @@ bool TrapProcessor::PipeOpen(StackProgram* program, size_t* inst, size_t*& op_st
     int pipe = (int)instance[0];
     const std::string filename = "/tmp/" + UnicodeToBytes(name);
 #endif
-    if(Pipe::OpenClient(filename.c_str(), pipe)) {
+    Runtime::ThreadScheduler::BlockingStart();
+    const bool is_open = Pipe::OpenClient(filename.c_str(), pipe);
+    Runtime::ThreadScheduler::BlockingEnd();
+    if(is_open) {
       PushInt(1, op_stack, stack_pos);
     }
     else {
@@ -5054,10 +5804,16 @@ bool TrapProcessor::PipeInByte(StackProgram* program, size_t* inst, size_t*& op_
   if(instance && instance[0]) {
 #ifdef _WIN32
     HANDLE pipe = (HANDLE)instance[0];
-    PushInt(Pipe::ReadByte(pipe), op_stack, stack_pos);
+    Runtime::ThreadScheduler::BlockingStart();
+    const size_t result = (size_t)Pipe::ReadByte(pipe);
+    Runtime::ThreadScheduler::BlockingEnd();
+    PushInt(result, op_stack, stack_pos);
 #else
     int pipe = (int)instance[0];
-    PushInt(Pipe::ReadByte(pipe), op_stack, stack_pos);
+    Runtime::ThreadScheduler::BlockingStart();
+    const size_t result = (size_t)Pipe::ReadByte(pipe);
+    Runtime::ThreadScheduler::BlockingEnd();
+    PushInt(result, op_stack, stack_pos);
 #endif
   }
   else {
@@ -5075,10 +5831,16 @@ bool TrapProcessor::PipeOutByte(StackProgram* program, size_t* inst, size_t*& op
   if(instance && (FILE*)instance[0]) {
 #ifdef _WIN32
     HANDLE pipe = (HANDLE)instance[0];
-    PushInt(Pipe::WriteByte(value, pipe), op_stack, stack_pos);
+    Runtime::ThreadScheduler::BlockingStart();
+    const size_t result = (size_t)Pipe::WriteByte(value, pipe);
+    Runtime::ThreadScheduler::BlockingEnd();
+    PushInt(result, op_stack, stack_pos);
 #else
     int pipe = (int)instance[0];
-    PushInt(Pipe::WriteByte(value, pipe), op_stack, stack_pos);
+    Runtime::ThreadScheduler::BlockingStart();
+    const size_t result = (size_t)Pipe::WriteByte(value, pipe);
+    Runtime::ThreadScheduler::BlockingEnd();
+    PushInt(result, op_stack, stack_pos);
 #endif
   }
   else {
@@ -5102,7 +5864,10 @@ bool TrapProcessor::PipeInByteAry(StackProgram* program, size_t* inst, size_t*&
     int pipe = (int)instance[0];
 #endif
     char* buffer = (char*)(array + 3);
-    PushInt(Pipe::ReadByteArray(buffer, offset, num, pipe), op_stack, stack_pos);
+    Runtime::ThreadScheduler::BlockingStart();
+    const size_t result = (size_t)Pipe::ReadByteArray(buffer, offset, num, pipe);
+    Runtime::ThreadScheduler::BlockingEnd();
+    PushInt(result, op_stack, stack_pos);
   }
   else {
     PushInt(-1, op_stack, stack_pos);
@@ -5119,7 +5884,6 @@ bool TrapProcessor::PipeInCharAry(StackProgram* program, size_t* inst, size_t*&
   const size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
 
   if(array && instance && (FILE*)instance[0] && offset > -1 && offset + num <= (long)array[0]) {
-    wchar_t* out = (wchar_t*)(array + 3);
 #ifdef _WIN32
     HANDLE pipe = (HANDLE)instance[0];
 #else
@@ -5127,28 +5891,22 @@ bool TrapProcessor::PipeInCharAry(StackProgram* program, size_t* inst, size_t*&
 #endif
 
     // read from pipe
-    char* byte_buffer = new char[num * 2 + 1];
-    const size_t read = Pipe::ReadByteArray(byte_buffer, offset, num, pipe);
-    byte_buffer[read] = '\0';
-    std::wstring in(BytesToUnicode(byte_buffer));
+    char* byte_buffer = new char[num + 1];
+    Runtime::ThreadScheduler::BlockingStart();
+    const long read = (long)Pipe::ReadByteArray(byte_buffer, 0, num, pipe);
+    Runtime::ThreadScheduler::BlockingEnd();
 
-    // copy and remove file BOM UTF (8, 16, 32)
-    if(in.size() > 0 && (in[0] == (wchar_t)0xFEFF || in[0] == (wchar_t)0xFFFE || in[0] == (wchar_t)0xFFFE0000 || in[0] == (wchar_t)0xEFBBBF)) {
-      in.erase(in.begin(), in.begin() + 1);
+    // copy and remove file BOM
+    if(read > -1) {
+      PushInt(DecodeCharArray(byte_buffer, read, array, offset, true), op_stack, stack_pos);
+    }
+    else {
+      PushInt(-1, op_stack, stack_pos);
     }
-
-    // copy
-#ifdef _WIN32
-    wcsncpy_s(out, array[0] + 1, in.c_str(), in.size());
-#else
-    wcsncpy(out, in.c_str(), in.size());
-#endif
 
     // clean up
     delete[] byte_buffer;
     byte_buffer = nullptr;
-
-    PushInt(read, op_stack, stack_pos);
   }
   else {
     PushInt(-1, op_stack, stack_pos);
@@ -5171,7 +5929,10 @@ bool TrapProcessor::PipeOutByteAry(StackProgram* program, size_t* inst, size_t*&
     int pipe = (int)instance[0];
 #endif
     char* buffer = (char*)(array + 3);
-    PushInt(Pipe::WriteByteArray(buffer, offset, num, pipe), op_stack, stack_pos);
+    Runtime::ThreadScheduler::BlockingStart();
+    const size_t result = (size_t)Pipe::WriteByteArray(buffer, offset, num, pipe);
+    Runtime::ThreadScheduler::BlockingEnd();
+    PushInt(result, op_stack, stack_pos);
   }
   else {
     PushInt(-1, op_stack, stack_pos);
@@ -5198,7 +5959,10 @@ bool TrapProcessor::PipeOutCharAry(StackProgram* program, size_t* inst, size_t*&
     const std::wstring sub_buffer(buffer + offset, num);
     // convert to bytes and write out
     std::string buffer_out = UnicodeToBytes(sub_buffer);
-    PushInt(Pipe::WriteByteArray(buffer_out.c_str(), 0, buffer_out.size(), pipe), op_stack, stack_pos);
+    Runtime::ThreadScheduler::BlockingStart();
+    const size_t result = (size_t)Pipe::WriteByteArray(buffer_out.c_str(), 0, buffer_out.size(), pipe);
+    Runtime::ThreadScheduler::BlockingEnd();
+    PushInt(result, op_stack, stack_pos);
   }
   else {
     PushInt(-1, op_stack, stack_pos);
@@ -5214,25 +5978,19 @@ bool TrapProcessor::PipeInString(StackProgram* program, size_t* inst, size_t*& o
   if(array && instance && instance[0]) {
 #ifdef _WIN32
     HANDLE pipe = (HANDLE)instance[0];
+    Runtime::ThreadScheduler::BlockingStart();
     std::string buffer = Pipe::ReadString(pipe);
+    Runtime::ThreadScheduler::BlockingEnd();
 #else
     int pipe = (int)instance[0];
+    Runtime::ThreadScheduler::BlockingStart();
     std::string buffer = Pipe::ReadString(pipe);
+    Runtime::ThreadScheduler::BlockingEnd();
 #endif
     
     if(!buffer.empty()) {
-      // copy and remove file BOM UTF (8, 16, 32)
-      std::wstring in = BytesToUnicode(buffer);
-      if(in.size() > 0 && (in[0] == (wchar_t)0xFEFF || in[0] == (wchar_t)0xFFFE || in[0] == (wchar_t)0xFFFE0000 || in[0] == (wchar_t)0xEFBBBF)) {
-        in.erase(in.begin(), in.begin() + 1);
-      }
-      
-      wchar_t* out = (wchar_t*)(array + 3);
-#ifdef _WIN32
-      wcsncpy_s(out, array[0] + 1, in.c_str(), in.size());
-#else
-      wcsncpy(out, in.c_str(), in.size());
-#endif
+      // copy and remove file BOM
+      DecodeCharArray(buffer.c_str(), buffer.size(), array, 0, true);
     }
   }
   
@@ -5250,7 +6008,9 @@ bool TrapProcessor::PipeOutString(StackProgram* program, size_t* inst, size_t*&
 #else
     int pipe = (int)instance[0];
 #endif
+    Runtime::ThreadScheduler::BlockingStart();
     Pipe::WriteString(output, pipe);
+    Runtime::ThreadScheduler::BlockingEnd();
   }
 
   return true;
@@ -5276,7 +6036,7 @@ bool TrapProcessor::SockTcpInByte(StackProgram* program, size_t* inst, size_t* &
   if(instance && (long)instance[0] > -1) {
     SOCKET sock = (SOCKET)instance[0];
     int status;
-    PushInt(IPSocket::ReadByte(sock, status), op_stack, stack_pos);
+    PushInt(SocketBuffer::GetSocketBuffer(sock)->ReadByte(status), op_stack, stack_pos);
   }
   else {
     PushInt(0, op_stack, stack_pos);
@@ -5295,7 +6055,7 @@ bool TrapProcessor::SockTcpInByteAry(StackProgram* program, size_t* inst, size_t
   if(array && instance && (long)instance[0] > -1 && offset > -1 && offset + num <= (long)array[0]) {
     SOCKET sock = (SOCKET)instance[0];
     char* buffer = (char*)(array + 3);
-    PushInt(IPSocket::ReadBytes(buffer + offset, num, sock), op_stack, stack_pos);
+    PushInt(SocketBuffer::GetSocketBuffer(sock)->ReadBytes(buffer + offset, num), op_stack, stack_pos);
   }
   else {
     PushInt(-1, op_stack, stack_pos);
@@ -5313,19 +6073,11 @@ bool TrapProcessor::SockTcpInCharAry(StackProgram* program, size_t* inst, size_t
 
   if(array && instance && (long)instance[0] > -1 && offset > -1 && offset + num <= (long)array[0]) {
     SOCKET sock = (SOCKET)instance[0];
-    wchar_t* buffer = (wchar_t*)(array + 3);
     // allocate temporary buffer
-    char* byte_buffer = new char[num * 2 + 1];
-    int read = IPSocket::ReadBytes(byte_buffer + offset, num, sock);
+    char* byte_buffer = new char[num + 1];
+    int read = SocketBuffer::GetSocketBuffer(sock)->ReadBytes(byte_buffer, num);
     if(read > -1) {
-      byte_buffer[read] = '\0';
-      std::wstring in = BytesToUnicode(byte_buffer);
-#ifdef _WIN32
-      wcsncpy_s(buffer, array[0] + 1, in.c_str(), in.size());
-#else
-      wcsncpy(buffer, in.c_str(), in.size());
-#endif
-      PushInt(in.size(), op_stack, stack_pos);
+      PushInt(DecodeCharArray(byte_buffer, read, array, offset, false), op_stack, stack_pos);
     }
     else {
       PushInt(-1, op_stack, stack_pos);
@@ -5347,8 +6099,7 @@ bool TrapProcessor::SockTcpOutByte(StackProgram* program, size_t* inst, size_t*
   size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
   if(instance && (long)instance[0] > -1) {
     SOCKET sock = (SOCKET)instance[0];
-    IPSocket::WriteByte((char)value, sock);
-    PushInt(1, op_stack, stack_pos);
+    PushInt(SocketBuffer::GetSocketBuffer(sock)->WriteByte((char)value), op_stack, stack_pos);
   }
   else {
     PushInt(0, op_stack, stack_pos);
@@ -5367,7 +6118,7 @@ bool TrapProcessor::SockTcpOutByteAry(StackProgram* program, size_t* inst, size_
   if(array && instance && (long)instance[0] > -1 && offset > -1 && offset + num <= (long)array[0]) {
     SOCKET sock = (SOCKET)instance[0];
     char* buffer = (char*)(array + 3);
-    PushInt(IPSocket::WriteBytes(buffer + offset, num, sock), op_stack, stack_pos);
+    PushInt(SocketBuffer::GetSocketBuffer(sock)->WriteBytes(buffer + offset, num), op_stack, stack_pos);
   }
   else {
     PushInt(-1, op_stack, stack_pos);
@@ -5390,7 +6141,7 @@ bool TrapProcessor::SockTcpOutCharAry(StackProgram* program, size_t* inst, size_
     const std::wstring sub_buffer(buffer + offset, num);
     // convert to bytes and write out
     std::string buffer_out = UnicodeToBytes(sub_buffer);
-    PushInt(IPSocket::WriteBytes(buffer_out.c_str(), (int)buffer_out.size(), sock), op_stack, stack_pos);
+    PushInt(SocketBuffer::GetSocketBuffer(sock)->WriteBytes(buffer_out.c_str(), (int)buffer_out.size()), op_stack, stack_pos);
   }
   else {
     PushInt(-1, op_stack, stack_pos);
@@ -5406,7 +6157,7 @@ bool TrapProcessor::SockTcpSslInByte(StackProgram* program, size_t* inst, size_t
     SSL_CTX* ctx = (SSL_CTX*)instance[0];
     BIO* bio = (BIO*)instance[1];
     int status;
-    PushInt(IPSecureSocket::ReadByte(ctx, bio, status), op_stack, stack_pos);
+    PushInt(SocketBuffer::GetSecureBuffer(ctx, bio)->ReadByte(status), op_stack, stack_pos);
   }
   else {
     PushInt(0, op_stack, stack_pos);
@@ -5426,23 +6177,7 @@ bool TrapProcessor::SockTcpSslInByteAry(StackProgram* program, size_t* inst, siz
     SSL_CTX* ctx = (SSL_CTX*)instance[0];
     BIO* bio = (BIO*)instance[1];
     char* buffer = (char*)(array + 3);
-
-    int status; int read = 0;
-    char* temp = buffer + offset;
-    bool done = false;
-    for(long i = 0; !done && i < num; ++i) {
-      temp[i] = IPSecureSocket::ReadByte(ctx, bio, status);
-      if(!status) {
-        done = true;
-      }
-      else if(status < 0) {
-        PushInt(-1, op_stack, stack_pos);
-        return true;
-      }
-      ++read;
-    }
-    
-    PushInt(read, op_stack, stack_pos);
+    PushInt(SocketBuffer::GetSecureBuffer(ctx, bio)->ReadFully(buffer + offset, num), op_stack, stack_pos);
   }
   else {
     PushInt(-1, op_stack, stack_pos);
@@ -5461,18 +6196,10 @@ bool TrapProcessor::SockTcpSslInCharAry(StackProgram* program, size_t* inst, siz
   if(array && instance && offset > -1 && offset + num <= (long)array[0]) {
     SSL_CTX* ctx = (SSL_CTX*)instance[0];
     BIO* bio = (BIO*)instance[1];
-    wchar_t* buffer = (wchar_t*)(array + 3);
-    char* byte_buffer = new char[num * 2 + 1];
-    int read = IPSecureSocket::ReadBytes(byte_buffer + offset, num, ctx, bio);
+    char* byte_buffer = new char[num + 1];
+    int read = SocketBuffer::GetSecureBuffer(ctx, bio)->ReadBytes(byte_buffer, num);
     if(read > -1) {
-      byte_buffer[read] = '\0';
-      std::wstring in = BytesToUnicode(byte_buffer);
-#ifdef _WIN32
-      wcsncpy_s(buffer, array[0] + 1, in.c_str(), in.size());
-#else
-      wcsncpy(buffer, in.c_str(), in.size());
-#endif
-      PushInt(in.size(), op_stack, stack_pos);
+      PushInt(DecodeCharArray(byte_buffer, read, array, offset, false), op_stack, stack_pos);
     }
     else {
       PushInt(-1, op_stack, stack_pos);
@@ -5495,8 +6222,7 @@ bool TrapProcessor::SockTcpSslOutByte(StackProgram* program, size_t* inst, size_
   if(instance) {
     SSL_CTX* ctx = (SSL_CTX*)instance[0];
     BIO* bio = (BIO*)instance[1];
-    IPSecureSocket::WriteByte((char)value, ctx, bio);
-    PushInt(1, op_stack, stack_pos);
+    PushInt(SocketBuffer::GetSecureBuffer(ctx, bio)->WriteByte((char)value), op_stack, stack_pos);
   }
   else {
     PushInt(0, op_stack, stack_pos);
@@ -5516,7 +6242,7 @@ bool TrapProcessor::SockTcpSslOutByteAry(StackProgram* program, size_t* inst, si
     SSL_CTX* ctx = (SSL_CTX*)instance[0];
     BIO* bio = (BIO*)instance[1];
     char* buffer = (char*)(array + 3);
-    PushInt(IPSecureSocket::WriteBytes(buffer + offset, num, ctx, bio), op_stack, stack_pos);
+    PushInt(SocketBuffer::GetSecureBuffer(ctx, bio)->WriteBytes(buffer + offset, num), op_stack, stack_pos);
   }
   else {
     PushInt(-1, op_stack, stack_pos);
@@ -5540,7 +6266,7 @@ bool TrapProcessor::SockTcpSslOutCharAry(StackProgram* program, size_t* inst, si
     const std::wstring sub_buffer(buffer + offset, num);
     // convert to bytes and write out
     std::string buffer_out = UnicodeToBytes(sub_buffer);
-    PushInt(IPSecureSocket::WriteBytes(buffer_out.c_str(), (int)buffer_out.size(), ctx, bio), op_stack, stack_pos);
+    PushInt(SocketBuffer::GetSecureBuffer(ctx, bio)->WriteBytes(buffer_out.c_str(), (int)buffer_out.size()), op_stack, stack_pos);
   }
   else {
     PushInt(-1, op_stack, stack_pos);
@@ -5549,13 +6275,36 @@ bool TrapProcessor::SockTcpSslOutCharAry(StackProgram* program, size_t* inst, si
   return true;
 }
 
-bool TrapProcessor::FileInByte(StackProgram* program, size_t* inst, size_t* &op_stack, long* &stack_pos, StackFrame* frame)
+bool TrapProcessor::SockTcpFlush(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
 {
-  const size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
-  if((FILE*)instance[0]) {
-    FILE* file = (FILE*)instance[0];
-    const int value = fgetc(file);
-    PushInt(value < 0 ? 0 : value, op_stack, stack_pos);
+  size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  if(instance && (long)instance[0] > -1) {
+    SOCKET sock = (SOCKET)instance[0];
+    SocketBuffer::GetSocketBuffer(sock)->Flush();
+  }
+
+  return true;
+}
+
+bool TrapProcessor::SockTcpSslFlush(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  if(instance && instance[3]) {
+    SSL_CTX* ctx = (SSL_CTX*)instance[0];
+    BIO* bio = (BIO*)instance[1];
+    SocketBuffer::GetSecureBuffer(ctx, bio)->Flush();
+  }
+
+  return true;
+}
+
+bool TrapProcessor::SockTcpSetBlocking(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  const bool is_blocking = (bool)PopInt(op_stack, stack_pos);
+  size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  if(instance && (long)instance[0] > -1) {
+    SOCKET sock = (SOCKET)instance[0];
+    PushInt(IPSocket::SetBlocking(sock, is_blocking), op_stack, stack_pos);
   }
   else {
     PushInt(0, op_stack, stack_pos);
@@ -5564,40 +6313,2991 @@ bool TrapProcessor::FileInByte(StackProgram* program, size_t* inst, size_t* &op_
   return true;
 }
 
-bool TrapProcessor::FileInCharAry(StackProgram* program, size_t* inst, size_t* &op_stack, long* &stack_pos, StackFrame* frame)
+bool TrapProcessor::SockTcpSetDeadline(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
 {
-  const size_t* array = (size_t*)PopInt(op_stack, stack_pos);
-  const INT64_VALUE num = (INT64_VALUE)PopInt(op_stack, stack_pos);
-  const INT64_VALUE offset = (INT64_VALUE)PopInt(op_stack, stack_pos);
-  const size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
-  
-  if(array && instance && (FILE*)instance[0] && offset > -1 && offset + num <= (long)array[0]) {
-    FILE* file = (FILE*)instance[0];
-    wchar_t* out = (wchar_t*)(array + 3);
+  const long timeout = (long)PopInt(op_stack, stack_pos);
+  size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  if(instance && (long)instance[0] > -1) {
+    SocketBuffer::GetSocketBuffer((SOCKET)instance[0])->SetReadDeadline(timeout);
+  }
 
-    // read from file
-    char* byte_buffer = new char[num * 2 + 1];
-    const size_t read = fread(byte_buffer + offset, 1, num, file);
-    byte_buffer[read] = '\0';
-    std::wstring in(BytesToUnicode(byte_buffer));
-    
-    // remove file BOM UTF (8, 16, 32)
-    if(in.size() > 0 && ((size_t)in[0] == 0xFEFF || (size_t)in[0] == 0xFFFE || (size_t)in[0] == 0xFFFE0000 || (size_t)in[0] == 0xEFBBBF)) {
-      in.erase(in.begin(), in.begin() + 1);
+  return true;
+}
+
+bool TrapProcessor::SockPollCreate(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  if(instance) {
+    IPSocketPoller* poller = new IPSocketPoller;
+    if(!poller->IsOpen()) {
+      delete poller;
+      poller = nullptr;
     }
+    instance[0] = (size_t)poller;
+  }
 
-    // copy
-#ifdef _WIN32
-    wcsncpy_s(out, array[0] + 1, in.c_str(), in.size());
-#else
-    wcsncpy(out, in.c_str(), array[2]);
-#endif
+  return true;
+}
 
-    // clean up
-    delete[] byte_buffer;
-    byte_buffer = nullptr;
+bool TrapProcessor::SockPollAdd(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  const long events = (long)PopInt(op_stack, stack_pos);
+  size_t* sock_obj = (size_t*)PopInt(op_stack, stack_pos);
+  size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  if(instance && instance[0] && sock_obj && (long)sock_obj[0] > -1) {
+    IPSocketPoller* poller = (IPSocketPoller*)instance[0];
+    const bool is_added = poller->Add((SOCKET)sock_obj[0], events);
+    if(is_added) {
+      SocketBuffer::Watch(poller, sock_obj[0]);
+    }
+    PushInt(is_added, op_stack, stack_pos);
+  }
+  else {
+    PushInt(0, op_stack, stack_pos);
+  }
 
-    PushInt(read, op_stack, stack_pos);
+  return true;
+}
+
+bool TrapProcessor::SockPollRemove(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  size_t* sock_obj = (size_t*)PopInt(op_stack, stack_pos);
+  size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  if(instance && instance[0] && sock_obj) {
+    IPSocketPoller* poller = (IPSocketPoller*)instance[0];
+    SocketBuffer::Unwatch(poller, sock_obj[0]);
+    PushInt(poller->Remove((SOCKET)sock_obj[0]), op_stack, stack_pos);
+  }
+  else {
+    PushInt(0, op_stack, stack_pos);
+  }
+
+  return true;
+}
+
+bool TrapProcessor::SockPollWait(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  const long timeout = (long)PopInt(op_stack, stack_pos);
+  size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  if(instance && instance[0]) {
+    IPSocketPoller* poller = (IPSocketPoller*)instance[0];
+
+    // send buffered output and report buffered input, neither is visible to the kernel
+    std::vector<size_t> pending;
+    SocketBuffer::GetPending(poller, pending);
+
+    std::unordered_map<SOCKET, int> ready;
+    for(size_t i = 0; i < pending.size(); ++i) {
+      if(poller->GetEvents((SOCKET)pending[i]) & SOCKET_POLL_READ) {
+        ready[(SOCKET)pending[i]] |= SOCKET_POLL_READ;
+      }
+    }
+    Runtime::ThreadScheduler::BlockingStart();
+    poller->Wait(ready.empty() ? (int)timeout : 0, ready);
+    Runtime::ThreadScheduler::BlockingEnd();
+
+    // ready handles and events as pairs
+    const long array_size = (long)ready.size() * 2;
+    size_t* array = MemoryManager::AllocateArray(array_size + 3, instructions::INT_TYPE, op_stack, *stack_pos, false);
+    array[0] = array_size;
+    array[1] = 1;
+    array[2] = array_size;
+
+    size_t* values = array + 3;
+    for(std::unordered_map<SOCKET, int>::iterator iter = ready.begin(); iter != ready.end(); ++iter) {
+      *values++ = (size_t)iter->first;
+      *values++ = iter->second;
+    }
+
+    PushInt((size_t)array, op_stack, stack_pos);
+  }
+  else {
+    PushInt(0, op_stack, stack_pos);
+  }
+
+  return true;
+}
+
+bool TrapProcessor::SockPollClose(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  if(instance && instance[0]) {
+    IPSocketPoller* poller = (IPSocketPoller*)instance[0];
+    const std::vector<SOCKET> socks = poller->GetSockets();
+    for(size_t i = 0; i < socks.size(); ++i) {
+      SocketBuffer::Unwatch(poller, socks[i]);
+    }
+    delete poller;
+    poller = nullptr;
+    instance[0] = 0;
+  }
+
+  return true;
+}
+
+bool TrapProcessor::ExecutorSubmit(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  size_t* task = (size_t*)PopInt(op_stack, stack_pos);
+  if(task) {
+    Runtime::TaskExecutor::Submit(task);
+  }
+
+  return true;
+}
+
+bool TrapProcessor::ExecutorSize(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  PushInt(Runtime::TaskExecutor::GetSize(), op_stack, stack_pos);
+
+  return true;
+}
+
+bool TrapProcessor::ExecutorWait(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  if(instance) {
+    Runtime::TaskExecutor::Wait(instance);
+  }
+
+  return true;
+}
+
+bool TrapProcessor::ExecutorNotify(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  Runtime::TaskExecutor::Notify();
+
+  return true;
+}
+
+//
+// atomics, Int values are machine words so the standard library's lock-free
+// operations lower to native instructions (e.g. 'lock xadd', 'ldaddal')
+//
+static_assert(sizeof(std::atomic<size_t>) == sizeof(size_t), "atomic words must match memory slots");
+
+static inline std::atomic<size_t>* AtomicField(size_t* instance, const INT64_VALUE index)
+{
+  if(!instance) {
+    std::wcerr << L">>> Attempting to dereference a 'Nil' memory instance <<<" << std::endl;
+    return nullptr;
+  }
+
+  return reinterpret_cast<std::atomic<size_t>*>(instance + index);
+}
+
+static std::atomic<size_t>* AtomicElement(size_t* array, const INT64_VALUE index)
+{
+  if(!array) {
+    std::wcerr << L">>> Attempting to dereference a 'Nil' memory element <<<" << std::endl;
+    return nullptr;
+  }
+
+  const INT64_VALUE size = (INT64_VALUE)array[0];
+  if(index < 0 || index >= size) {
+    std::wcerr << L">>> Index out of bounds: " << index << L"," << size << L" <<<" << std::endl;
+    return nullptr;
+  }
+
+  return reinterpret_cast<std::atomic<size_t>*>(array + 3 + index);
+}
+
+bool TrapProcessor::AtomicLoad(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  const INT64_VALUE index = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  std::atomic<size_t>* field = AtomicField((size_t*)PopInt(op_stack, stack_pos), index);
+  if(!field) {
+    return false;
+  }
+  PushInt(field->load(std::memory_order_acquire), op_stack, stack_pos);
+
+  return true;
+}
+
+bool TrapProcessor::AtomicStore(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  const size_t value = PopInt(op_stack, stack_pos);
+  const INT64_VALUE index = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  std::atomic<size_t>* field = AtomicField((size_t*)PopInt(op_stack, stack_pos), index);
+  if(!field) {
+    return false;
+  }
+  field->store(value, std::memory_order_release);
+
+  return true;
+}
+
+bool TrapProcessor::AtomicAdd(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  const size_t delta = PopInt(op_stack, stack_pos);
+  const INT64_VALUE index = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  std::atomic<size_t>* field = AtomicField((size_t*)PopInt(op_stack, stack_pos), index);
+  if(!field) {
+    return false;
+  }
+  PushInt(field->fetch_add(delta), op_stack, stack_pos);
+
+  return true;
+}
+
+bool TrapProcessor::AtomicSwap(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  const size_t value = PopInt(op_stack, stack_pos);
+  const INT64_VALUE index = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  std::atomic<size_t>* field = AtomicField((size_t*)PopInt(op_stack, stack_pos), index);
+  if(!field) {
+    return false;
+  }
+  PushInt(field->exchange(value), op_stack, stack_pos);
+
+  return true;
+}
+
+bool TrapProcessor::AtomicCas(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  const size_t desired = PopInt(op_stack, stack_pos);
+  size_t expected = PopInt(op_stack, stack_pos);
+  const INT64_VALUE index = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  std::atomic<size_t>* field = AtomicField((size_t*)PopInt(op_stack, stack_pos), index);
+  if(!field) {
+    return false;
+  }
+  PushInt(field->compare_exchange_strong(expected, desired) ? 1 : 0, op_stack, stack_pos);
+
+  return true;
+}
+
+bool TrapProcessor::AtomicAryLoad(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  const INT64_VALUE index = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  std::atomic<size_t>* element = AtomicElement((size_t*)PopInt(op_stack, stack_pos), index);
+  if(!element) {
+    return false;
+  }
+  PushInt(element->load(std::memory_order_acquire), op_stack, stack_pos);
+
+  return true;
+}
+
+bool TrapProcessor::AtomicAryStore(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  const size_t value = PopInt(op_stack, stack_pos);
+  const INT64_VALUE index = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  std::atomic<size_t>* element = AtomicElement((size_t*)PopInt(op_stack, stack_pos), index);
+  if(!element) {
+    return false;
+  }
+  element->store(value, std::memory_order_release);
+
+  return true;
+}
+
+bool TrapProcessor::AtomicAryAdd(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  const size_t delta = PopInt(op_stack, stack_pos);
+  const INT64_VALUE index = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  std::atomic<size_t>* element = AtomicElement((size_t*)PopInt(op_stack, stack_pos), index);
+  if(!element) {
+    return false;
+  }
+  PushInt(element->fetch_add(delta), op_stack, stack_pos);
+
+  return true;
+}
+
+bool TrapProcessor::AtomicArySwap(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  const size_t value = PopInt(op_stack, stack_pos);
+  const INT64_VALUE index = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  std::atomic<size_t>* element = AtomicElement((size_t*)PopInt(op_stack, stack_pos), index);
+  if(!element) {
+    return false;
+  }
+  PushInt(element->exchange(value), op_stack, stack_pos);
+
+  return true;
+}
+
+bool TrapProcessor::AtomicAryCas(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  const size_t desired = PopInt(op_stack, stack_pos);
+  size_t expected = PopInt(op_stack, stack_pos);
+  const INT64_VALUE index = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  std::atomic<size_t>* element = AtomicElement((size_t*)PopInt(op_stack, stack_pos), index);
+  if(!element) {
+    return false;
+  }
+  PushInt(element->compare_exchange_strong(expected, desired) ? 1 : 0, op_stack, stack_pos);
+
+  return true;
+}
+
+//
+// conditions, semaphores and reader-writer locks, waiting threads are safe
+// points for the collector
+//
+bool TrapProcessor::ConditionInit(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  Runtime::ThreadScheduler::InitializeWaitQueue(instance);
+
+  return true;
+}
+
+bool TrapProcessor::ConditionWait(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  size_t* mutex = (size_t*)PopInt(op_stack, stack_pos);
+  size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  if(!mutex) {
+    std::wcerr << L">>> Attempting to dereference a 'Nil' memory element <<<" << std::endl;
+    return false;
+  }
+
+  if(!Runtime::ThreadScheduler::ConditionWait(instance, mutex)) {
+    std::wcerr << L">>> Waiting on a condition without holding its mutex <<<" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+bool TrapProcessor::ConditionSignal(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  Runtime::ThreadScheduler::ConditionNotify(instance, false);
+
+  return true;
+}
+
+bool TrapProcessor::ConditionBroadcast(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  Runtime::ThreadScheduler::ConditionNotify(instance, true);
+
+  return true;
+}
+
+bool TrapProcessor::SemaphoreInit(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  Runtime::ThreadScheduler::InitializeWaitQueue(instance + 1);
+
+  return true;
+}
+
+bool TrapProcessor::SemaphoreAcquire(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  const INT64_VALUE permits = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  if(permits > 0) {
+    Runtime::ThreadScheduler::SemaphoreAcquire(instance, permits);
+  }
+
+  return true;
+}
+
+bool TrapProcessor::SemaphoreTryAcquire(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  const INT64_VALUE permits = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  PushInt(permits <= 0 || Runtime::ThreadScheduler::SemaphoreTryAcquire(instance, permits) ? 1 : 0, op_stack, stack_pos);
+
+  return true;
+}
+
+bool TrapProcessor::SemaphoreRelease(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  const INT64_VALUE permits = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  if(permits > 0) {
+    Runtime::ThreadScheduler::SemaphoreRelease(instance, permits);
+  }
+
+  return true;
+}
+
+bool TrapProcessor::ReadWriteInit(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  Runtime::ThreadScheduler::InitializeWaitQueue(instance + 3);
+
+  return true;
+}
+
+bool TrapProcessor::ReadLock(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  Runtime::ThreadScheduler::ReadLock(instance);
+
+  return true;
+}
+
+bool TrapProcessor::ReadUnlock(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  Runtime::ThreadScheduler::ReadUnlock(instance);
+
+  return true;
+}
+
+bool TrapProcessor::WriteLock(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  Runtime::ThreadScheduler::WriteLock(instance);
+
+  return true;
+}
+
+bool TrapProcessor::WriteUnlock(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  Runtime::ThreadScheduler::WriteUnlock(instance);
+
+  return true;
+}
+
+//
+// parallel sorts and scans over Int and Float arrays, run as native jobs on
+// the executor's threads. Small arrays are handled serially.
+//
+#define PARALLEL_SORT_MIN 32768
+#define PARALLEL_SCAN_MIN 65536
+
+// elements taken from 'a' in the first 'diagonal' elements of a stable merge
+template<typename T, typename Less>
+static size_t MergeSplit(const T* a, size_t a_size, const T* b, size_t b_size, size_t diagonal, Less less)
+{
+  size_t low = diagonal > b_size ? diagonal - b_size : 0;
+  size_t high = diagonal < a_size ? diagonal : a_size;
+  while(low < high) {
+    const size_t mid = low + (high - low) / 2;
+    const size_t j = diagonal - mid;
+    if(j > 0 && !less(b[j - 1], a[mid])) {
+      low = mid + 1;
+    }
+    else {
+      high = mid;
+    }
+  }
+
+  return low;
+}
+
+//
+// sorts chunks, then merges pairs of runs, each merge is split along its
+// merge path so every round keeps all threads busy
+//
+template<typename T, typename Less>
+static void ParallelSort(T* values, const size_t size, Less less)
+{
+  if(size < PARALLEL_SORT_MIN) {
+    std::sort(values, values + size, less);
+    return;
+  }
+
+  size_t chunks = 2;
+  while(chunks < (size_t)Runtime::TaskExecutor::GetSize() * 2 && size / (chunks * 2) >= PARALLEL_SORT_MIN / 2) {
+    chunks *= 2;
+  }
+
+  std::vector<size_t> bounds(chunks + 1);
+  for(size_t i = 0; i <= chunks; ++i) {
+    bounds[i] = size * i / chunks;
+  }
+
+  Runtime::TaskExecutor::ParallelFor(chunks, [&](size_t i) {
+    std::sort(values + bounds[i], values + bounds[i + 1], less);
+  });
+
+  std::vector<T> buffer(size);
+  T* from = values;
+  T* to = buffer.data();
+  for(size_t span = 1; span < chunks; span *= 2) {
+    const size_t parts = span * 2;
+    Runtime::TaskExecutor::ParallelFor(chunks, [&](size_t i) {
+      const size_t pair = i / parts;
+      const size_t part = i % parts;
+      const size_t start = bounds[pair * parts];
+      const size_t middle = bounds[pair * parts + span];
+      const size_t end = bounds[pair * parts + parts];
+
+      const T* a = from + start;
+      const T* b = from + middle;
+      const size_t a_size = middle - start;
+      const size_t b_size = end - middle;
+      const size_t first = (end - start) * part / parts;
+      const size_t last = (end - start) * (part + 1) / parts;
+      const size_t a_first = MergeSplit(a, a_size, b, b_size, first, less);
+      const size_t a_last = MergeSplit(a, a_size, b, b_size, last, less);
+
+      std::merge(a + a_first, a + a_last, b + (first - a_first), b + (last - a_last), to + start + first, less);
+    });
+    std::swap(from, to);
+  }
+
+  if(from != values) {
+    memcpy(values, from, size * sizeof(T));
+  }
+}
+
+// inclusive prefix sums, chunk totals are summed first and then offset each chunk
+template<typename T>
+static void ParallelScan(T* values, const size_t size)
+{
+  if(size < PARALLEL_SCAN_MIN) {
+    for(size_t i = 1; i < size; ++i) {
+      values[i] += values[i - 1];
+    }
+    return;
+  }
+
+  size_t chunks = (size_t)Runtime::TaskExecutor::GetSize() * 2;
+  if(chunks > size / (PARALLEL_SCAN_MIN / 2)) {
+    chunks = size / (PARALLEL_SCAN_MIN / 2);
+  }
+
+  std::vector<T> totals(chunks + 1);
+  Runtime::TaskExecutor::ParallelFor(chunks, [&](size_t i) {
+    T total = 0;
+    for(size_t j = size * i / chunks; j < size * (i + 1) / chunks; ++j) {
+      total += values[j];
+    }
+    totals[i + 1] = total;
+  });
+
+  for(size_t i = 1; i <= chunks; ++i) {
+    totals[i] += totals[i - 1];
+  }
+
+  Runtime::TaskExecutor::ParallelFor(chunks, [&](size_t i) {
+    T sum = totals[i];
+    for(size_t j = size * i / chunks; j < size * (i + 1) / chunks; ++j) {
+      sum += values[j];
+      values[j] = sum;
+    }
+  });
+}
+
+// NaN values sort last
+static inline bool FloatLess(const FLOAT_VALUE left, const FLOAT_VALUE right)
+{
+  return left < right || (std::isnan(right) && !std::isnan(left));
+}
+
+bool TrapProcessor::ParallelSortInt(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  size_t* array = (size_t*)PopInt(op_stack, stack_pos);
+  if(!array) {
+    std::wcerr << L">>> Attempting to dereference a 'Nil' memory element <<<" << std::endl;
+    return false;
+  }
+
+  INT64_VALUE* values = (INT64_VALUE*)(array + array[1] + 2);
+  ParallelSort(values, array[0], [](const INT64_VALUE left, const INT64_VALUE right) { return left < right; });
+
+  return true;
+}
+
+bool TrapProcessor::ParallelSortFloat(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  size_t* array = (size_t*)PopInt(op_stack, stack_pos);
+  if(!array) {
+    std::wcerr << L">>> Attempting to dereference a 'Nil' memory element <<<" << std::endl;
+    return false;
+  }
+
+  FLOAT_VALUE* values = (FLOAT_VALUE*)(array + array[1] + 2);
+  ParallelSort(values, array[0], FloatLess);
+
+  return true;
+}
+
+bool TrapProcessor::ParallelScanInt(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  size_t* array = (size_t*)PopInt(op_stack, stack_pos);
+  if(!array) {
+    std::wcerr << L">>> Attempting to dereference a 'Nil' memory element <<<" << std::endl;
+    return false;
+  }
+
+  // unsigned, overflow wraps like Int arithmetic
+  ParallelScan((size_t*)(array + array[1] + 2), array[0]);
+
+  return true;
+}
+
+bool TrapProcessor::ParallelScanFloat(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  size_t* array = (size_t*)PopInt(op_stack, stack_pos);
+  if(!array) {
+    std::wcerr << L">>> Attempting to dereference a 'Nil' memory element <<<" << std::endl;
+    return false;
+  }
+
+  ParallelScan((FLOAT_VALUE*)(array + array[1] + 2), array[0]);
+
+  return true;
+}
+
+bool TrapProcessor::MappedFileOpen(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  size_t* array = (size_t*)PopInt(op_stack, stack_pos);
+  size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  if(array && instance) {
+    array = (size_t*)array[0];
+    const std::string filename = UnicodeToBytes((wchar_t*)(array + 3));
+    size_t size = 0;
+    Runtime::ThreadScheduler::BlockingStart();
+    char* data = File::MapFile(filename.c_str(), size);
+    Runtime::ThreadScheduler::BlockingEnd();
+#ifdef _DEBUG
+    std::wcout << L"# mapped file open: name='" << BytesToUnicode(filename) << L"'; addr=" << (void*)data
+               << L"; size=" << size << L" #" << std::endl;
+#endif
+    instance[0] = (size_t)data;
+    instance[1] = data ? size : 0;
+    instance[2] = 0;
+  }
+
+  return true;
+}
+
+bool TrapProcessor::MappedFileClose(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  if(instance && instance[0]) {
+    File::UnmapFile((char*)instance[0], instance[1]);
+    instance[0] = instance[1] = instance[2] = 0;
+  }
+
+  return true;
+}
+
+bool TrapProcessor::MappedFileInByte(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  const INT64_VALUE index = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  const size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  if(!instance || !instance[0]) {
+    std::wcerr << L">>> Attempting to dereference a 'Nil' memory instance <<<" << std::endl;
+    return false;
+  }
+
+  const INT64_VALUE size = (INT64_VALUE)instance[1];
+  if(index < 0 || index >= size) {
+    std::wcerr << L">>> Index out of bounds: " << index << L"," << size << L" <<<" << std::endl;
+    return false;
+  }
+  PushInt(((unsigned char*)instance[0])[index], op_stack, stack_pos);
+
+  return true;
+}
+
+bool TrapProcessor::MappedFileInByteAry(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  const size_t* array = (size_t*)PopInt(op_stack, stack_pos);
+  const INT64_VALUE num = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  const INT64_VALUE offset = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  const INT64_VALUE from = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  const size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+
+  if(array && instance && instance[0] && from > -1 && num > -1 && offset > -1 && offset + num <= (INT64_VALUE)array[0]) {
+    const INT64_VALUE size = (INT64_VALUE)instance[1];
+    const INT64_VALUE read = from < size ? std::min(num, size - from) : 0;
+    memcpy((char*)(array + 3) + offset, (char*)instance[0] + from, read);
+    PushInt(read, op_stack, stack_pos);
+  }
+  else {
+    PushInt(-1, op_stack, stack_pos);
+  }
+
+  return true;
+}
+
+bool TrapProcessor::MappedFileFindByte(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  const INT64_VALUE to = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  const INT64_VALUE from = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  const int value = (int)PopInt(op_stack, stack_pos);
+  const size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+
+  INT64_VALUE index = -1;
+  if(instance && instance[0] && from > -1) {
+    const char* data = (char*)instance[0];
+    const INT64_VALUE end = std::min(to, (INT64_VALUE)instance[1]);
+    if(from < end) {
+      const char* found = (const char*)memchr(data + from, value, end - from);
+      if(found) {
+        index = found - data;
+      }
+    }
+  }
+  PushInt(index, op_stack, stack_pos);
+
+  return true;
+}
+
+bool TrapProcessor::MappedFileInLine(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  if(!instance || !instance[0] || instance[2] >= instance[1]) {
+    PushInt(0, op_stack, stack_pos);
+    return true;
+  }
+
+  const char* data = (char*)instance[0];
+  const size_t size = instance[1];
+  size_t start = instance[2];
+
+  // lines end at '\n' with an optional '\r', the last line may not have one
+  const char* found = (const char*)memchr(data + start, '\n', size - start);
+  size_t end = found ? found - data : size;
+  instance[2] = found ? end + 1 : size;
+  if(end > start && data[end - 1] == '\r') {
+    end--;
+  }
+
+  // skip the UTF-8 BOM
+  if(start == 0 && end >= 3 && !memcmp(data, "\xEF\xBB\xBF", 3)) {
+    start = 3;
+  }
+  PushInt((size_t)CreateStringObject(data + start, end - start, program, op_stack, stack_pos), op_stack, stack_pos);
+
+  return true;
+}
+
+bool TrapProcessor::MappedFileInString(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  const INT64_VALUE length = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  const INT64_VALUE from = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  const size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  if(!instance || !instance[0]) {
+    std::wcerr << L">>> Attempting to dereference a 'Nil' memory instance <<<" << std::endl;
+    return false;
+  }
+
+  const INT64_VALUE size = (INT64_VALUE)instance[1];
+  if(from < 0 || length < 0 || from + length > size) {
+    std::wcerr << L">>> Index out of bounds: " << from + length << L"," << size << L" <<<" << std::endl;
+    return false;
+  }
+  PushInt((size_t)CreateStringObject((char*)instance[0] + from, length, program, op_stack, stack_pos), op_stack, stack_pos);
+
+  return true;
+}
+
+/********************************
+ * JSON structural index
+ ********************************/
+// tape entry types, in 'Data.JSON.JsonElement->JsonType' order
+enum JsonTapeType {
+  JSON_TAPE_STRING = 0,
+  JSON_TAPE_NUMBER,
+  JSON_TAPE_TRUE,
+  JSON_TAPE_FALSE,
+  JSON_TAPE_NULL,
+  JSON_TAPE_ARRAY,
+  JSON_TAPE_OBJECT
+};
+
+static inline unsigned JsonLowestBit(uint32_t mask) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return (unsigned)index;
+#else
+  return (unsigned)__builtin_ctz(mask);
+#endif
+}
+
+static inline bool JsonIsSpace(unsigned char c) {
+  return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\f' || c == '\v';
+}
+
+/**
+ * Offset of the next quote or backslash
+ */
+static size_t JsonStringStop(const unsigned char* in, size_t size, size_t pos) {
+#if defined(UTF8_AVX2)
+  const __m256i quote = _mm256_set1_epi8('"');
+  const __m256i slash = _mm256_set1_epi8('\\');
+  for(; pos + 32 <= size; pos += 32) {
+    const __m256i block = _mm256_loadu_si256((const __m256i*)(in + pos));
+    const uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(block, quote), _mm256_cmpeq_epi8(block, slash)));
+    if(mask) {
+      return pos + JsonLowestBit(mask);
+    }
+  }
+#elif defined(UTF8_SSE2)
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i slash = _mm_set1_epi8('\\');
+  for(; pos + 16 <= size; pos += 16) {
+    const __m128i block = _mm_loadu_si128((const __m128i*)(in + pos));
+    const uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, slash)));
+    if(mask) {
+      return pos + JsonLowestBit(mask);
+    }
+  }
+#elif defined(UTF8_NEON)
+  const uint8x16_t quote = vdupq_n_u8('"');
+  const uint8x16_t slash = vdupq_n_u8('\\');
+  for(; pos + 16 <= size; pos += 16) {
+    const uint8x16_t block = vld1q_u8(in + pos);
+    if(vmaxvq_u8(vorrq_u8(vceqq_u8(block, quote), vceqq_u8(block, slash)))) {
+      break;
+    }
+  }
+#endif
+  for(; pos < size && in[pos] != '"' && in[pos] != '\\'; ++pos);
+  return pos;
+}
+
+/**
+ * Offset of the next byte that isn't whitespace or in a '//' comment
+ */
+static size_t JsonSkipSpace(const unsigned char* in, size_t size, size_t pos) {
+  while(pos < size) {
+    if(JsonIsSpace(in[pos])) {
+      ++pos;
+      // indentation runs
+#if defined(UTF8_AVX2)
+      const __m256i space = _mm256_set1_epi8(' ');
+      const __m256i tab = _mm256_set1_epi8('\t');
+      for(; pos + 32 <= size; pos += 32) {
+        const __m256i block = _mm256_loadu_si256((const __m256i*)(in + pos));
+        const uint32_t mask = ~(uint32_t)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(block, space), _mm256_cmpeq_epi8(block, tab)));
+        if(mask) {
+          pos += JsonLowestBit(mask);
+          break;
+        }
+      }
+#elif defined(UTF8_SSE2)
+      const __m128i space = _mm_set1_epi8(' ');
+      const __m128i tab = _mm_set1_epi8('\t');
+      for(; pos + 16 <= size; pos += 16) {
+        const __m128i block = _mm_loadu_si128((const __m128i*)(in + pos));
+        const uint32_t mask = ~(uint32_t)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, space), _mm_cmpeq_epi8(block, tab))) & 0xffff;
+        if(mask) {
+          pos += JsonLowestBit(mask);
+          break;
+        }
+      }
+#endif
+    }
+    else if(in[pos] == '/' && pos + 1 < size && in[pos + 1] == '/') {
+      for(pos += 2; pos < size && in[pos] != '\n' && in[pos] != '\r'; ++pos);
+    }
+    else {
+      break;
+    }
+  }
+
+  return pos;
+}
+
+static inline void JsonTapeAdd(std::vector<INT64_VALUE> &tape, JsonTapeType type, INT64_VALUE payload, INT64_VALUE extra) {
+  tape.push_back((payload << 4) | type);
+  tape.push_back(extra);
+}
+
+/**
+ * Scans a string, number or word at 'pos' onto the tape, returns the offset
+ * past it or 'size' plus one on error
+ */
+static size_t JsonScanScalar(const unsigned char* in, size_t size, size_t pos, bool key, std::vector<INT64_VALUE> &tape) {
+  const unsigned char c = in[pos];
+
+  // string, escapes are kept
+  if(c == '"') {
+    const size_t start = ++pos;
+    while(true) {
+      pos = JsonStringStop(in, size, pos);
+      if(pos >= size) {
+        return size + 1;
+      }
+      else if(in[pos] == '\\') {
+        pos += 2;
+      }
+      else {
+        break;
+      }
+    }
+    JsonTapeAdd(tape, JSON_TAPE_STRING, start, pos - start);
+    return pos + 1;
+  }
+
+  // number
+  if(!key && ((c >= '0' && c <= '9') || c == '-' || c == '.')) {
+    const size_t start = pos;
+    int dots = 0;
+    for(; pos < size; ++pos) {
+      const unsigned char d = in[pos];
+      if(d == '.') {
+        ++dots;
+      }
+      else if(!((d >= '0' && d <= '9') || d == '-' || d == '+' || d == 'e' || d == 'E')) {
+        break;
+      }
+    }
+    if(dots > 1) {
+      return size + 1;
+    }
+    JsonTapeAdd(tape, JSON_TAPE_NUMBER, start, pos - start);
+    return pos;
+  }
+
+  // bare word
+  if((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c >= 0x80) {
+    const size_t start = pos;
+    for(; pos < size; ++pos) {
+      const unsigned char d = in[pos];
+      if(!((d >= 'a' && d <= 'z') || (d >= 'A' && d <= 'Z') || (d >= '0' && d <= '9') || d == '_' || d >= 0x80)) {
+        break;
+      }
+    }
+
+    const size_t length = pos - start;
+    if(!key && length == 4 && !memcmp(in + start, "true", 4)) {
+      JsonTapeAdd(tape, JSON_TAPE_TRUE, 0, 0);
+    }
+    else if(!key && length == 5 && !memcmp(in + start, "false", 5)) {
+      JsonTapeAdd(tape, JSON_TAPE_FALSE, 0, 0);
+    }
+    else if(!key && length == 4 && !memcmp(in + start, "null", 4)) {
+      JsonTapeAdd(tape, JSON_TAPE_NULL, 0, 0);
+    }
+    else {
+      JsonTapeAdd(tape, JSON_TAPE_STRING, start, length);
+    }
+    return pos;
+  }
+
+  return size + 1;
+}
+
+/**
+ * Indexes JSON text onto a tape of two word entries. Strings and numbers hold their byte offset
+ * and length, arrays and objects their child count and the index of the entry after their last
+ * descendant. Object members are a key string entry followed by the value's entries. Returns -1
+ * on success or the offset of the first error.
+ */
+static INT64_VALUE JsonIndex(const unsigned char* in, size_t size, std::vector<INT64_VALUE> &tape) {
+  struct JsonFrame {
+    size_t entry;
+    INT64_VALUE count;
+    bool object;
+  };
+  std::vector<JsonFrame> frames;
+
+  size_t pos = 0;
+  if(size > 2 && in[0] == 0xef && in[1] == 0xbb && in[2] == 0xbf) {
+    pos = 3;
+  }
+
+  while(true) {
+    pos = JsonSkipSpace(in, size, pos);
+    if(pos >= size) {
+      return (INT64_VALUE)size;
+    }
+
+    unsigned char c = in[pos];
+    if(!frames.empty()) {
+      JsonFrame &frame = frames.back();
+
+      // close container
+      if(c == (frame.object ? '}' : ']')) {
+        tape[frame.entry * 2] = (frame.count << 4) | (frame.object ? JSON_TAPE_OBJECT : JSON_TAPE_ARRAY);
+        tape[frame.entry * 2 + 1] = (INT64_VALUE)(tape.size() / 2);
+        frames.pop_back();
+        ++pos;
+
+        if(frames.empty()) {
+          return -1;
+        }
+        continue;
+      }
+
+      // separators are optional
+      if(c == ',') {
+        ++pos;
+        continue;
+      }
+
+      // member name
+      if(frame.object) {
+        const size_t start = pos;
+        pos = JsonScanScalar(in, size, pos, true, tape);
+        if(pos > size) {
+          return (INT64_VALUE)start;
+        }
+
+        pos = JsonSkipSpace(in, size, pos);
+        if(pos >= size || in[pos] != ':') {
+          return (INT64_VALUE)pos;
+        }
+        pos = JsonSkipSpace(in, size, pos + 1);
+        if(pos >= size) {
+          return (INT64_VALUE)size;
+        }
+        c = in[pos];
+      }
+      frame.count++;
+    }
+
+    // value
+    if(c == '{' || c == '[') {
+      frames.push_back({ tape.size() / 2, 0, c == '{' });
+      JsonTapeAdd(tape, c == '{' ? JSON_TAPE_OBJECT : JSON_TAPE_ARRAY, 0, 0);
+      ++pos;
+    }
+    else {
+      const size_t start = pos;
+      pos = JsonScanScalar(in, size, pos, false, tape);
+      if(pos > size) {
+        return (INT64_VALUE)start;
+      }
+
+      if(frames.empty()) {
+        return -1;
+      }
+    }
+  }
+}
+
+bool TrapProcessor::JsonTapeIndex(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  const size_t* array = (size_t*)PopInt(op_stack, stack_pos);
+  if(!array) {
+    std::wcerr << L">>> Attempting to dereference a 'Nil' memory instance <<<" << std::endl;
+    return false;
+  }
+
+  const unsigned char* in = (const unsigned char*)(array + 3);
+  const size_t size = array[0];
+
+  std::vector<INT64_VALUE> tape;
+  tape.reserve(size / 4 + 2);
+  const INT64_VALUE error = JsonIndex(in, size, tape);
+
+  // first word holds the entry count, or minus one less the error offset
+  const long tape_size = error < 0 ? (long)tape.size() + 1 : 1;
+  const long tape_dim = 1;
+  size_t* tape_array = MemoryManager::AllocateArray(tape_size + tape_dim + 2, instructions::INT_TYPE, op_stack, *stack_pos, false);
+  tape_array[0] = tape_size;
+  tape_array[1] = tape_dim;
+  tape_array[2] = tape_size;
+
+  INT64_VALUE* out = (INT64_VALUE*)(tape_array + 3);
+  if(error < 0) {
+    out[0] = (INT64_VALUE)(tape.size() / 2);
+    if(!tape.empty()) {
+      memcpy(out + 1, tape.data(), tape.size() * sizeof(INT64_VALUE));
+    }
+  }
+  else {
+    out[0] = -1 - error;
+  }
+  PushInt((size_t)tape_array, op_stack, stack_pos);
+
+  return true;
+}
+
+bool TrapProcessor::BytesToString(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  const INT64_VALUE length = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  const INT64_VALUE offset = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  const size_t* array = (size_t*)PopInt(op_stack, stack_pos);
+  if(!array) {
+    std::wcerr << L">>> Attempting to dereference a 'Nil' memory instance <<<" << std::endl;
+    return false;
+  }
+
+  const INT64_VALUE size = (INT64_VALUE)array[0];
+  if(offset < 0 || length < 0 || offset + length > size) {
+    std::wcerr << L">>> Index out of bounds: " << offset + length << L"," << size << L" <<<" << std::endl;
+    return false;
+  }
+  PushInt((size_t)CreateStringObject((const char*)(array + 3) + offset, length, program, op_stack, stack_pos), op_stack, stack_pos);
+
+  return true;
+}
+
+bool TrapProcessor::StringUtf8Encode(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  const INT64_VALUE position = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  size_t* array = (size_t*)PopInt(op_stack, stack_pos);
+  const size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  if(!array || !instance) {
+    std::wcerr << L">>> Attempting to dereference a 'Nil' memory instance <<<" << std::endl;
+    return false;
+  }
+
+  const INT64_VALUE size = (INT64_VALUE)array[0];
+  if(position < 0 || position > size) {
+    std::wcerr << L">>> Index out of bounds: " << position << L"," << size << L" <<<" << std::endl;
+    return false;
+  }
+
+  // 'System.String' holds its characters and length in the first and third words
+  const size_t* chars = (size_t*)instance[0];
+  const size_t length = instance[2];
+  const wchar_t* in = (const wchar_t*)(chars + 3);
+
+  // the exact length is only counted when the worst case doesn't fit
+  const size_t worst = length * (sizeof(wchar_t) == 2 ? 3 : 4);
+  if((size_t)(size - position) < worst) {
+    const size_t needed = Utf8EncodedLength(in, length);
+    if((size_t)(size - position) < needed) {
+      PushInt((size_t)(-1 - (INT64_VALUE)needed), op_stack, stack_pos);
+      return true;
+    }
+  }
+
+  const size_t written = Utf8Encode(in, length, (char*)(array + 3) + position);
+  PushInt((size_t)(position + written), op_stack, stack_pos);
+
+  return true;
+}
+
+/********************************
+ * CSV structural index
+ ********************************/
+// cell flags, in 'Data.CSV.CsvReader' order
+enum CsvCellFlag {
+  CSV_CELL_ROW_END = 1,
+  CSV_CELL_ESCAPED = 2
+};
+
+// words ahead of the first cell: cell count, row count and offset after the last row
+#define CSV_INDEX_HEADER 3
+
+/**
+ * Offset of the next delimiter or newline
+ */
+static size_t CsvCellStop(const unsigned char* in, size_t size, size_t pos, unsigned char delimiter) {
+#if defined(UTF8_AVX2)
+  const __m256i delim = _mm256_set1_epi8((char)delimiter);
+  const __m256i line = _mm256_set1_epi8('\n');
+  for(; pos + 32 <= size; pos += 32) {
+    const __m256i block = _mm256_loadu_si256((const __m256i*)(in + pos));
+    const uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(block, delim), _mm256_cmpeq_epi8(block, line)));
+    if(mask) {
+      return pos + JsonLowestBit(mask);
+    }
+  }
+#elif defined(UTF8_SSE2)
+  const __m128i delim = _mm_set1_epi8((char)delimiter);
+  const __m128i line = _mm_set1_epi8('\n');
+  for(; pos + 16 <= size; pos += 16) {
+    const __m128i block = _mm_loadu_si128((const __m128i*)(in + pos));
+    const uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, delim), _mm_cmpeq_epi8(block, line)));
+    if(mask) {
+      return pos + JsonLowestBit(mask);
+    }
+  }
+#elif defined(UTF8_NEON)
+  const uint8x16_t delim = vdupq_n_u8(delimiter);
+  const uint8x16_t line = vdupq_n_u8('\n');
+  for(; pos + 16 <= size; pos += 16) {
+    const uint8x16_t block = vld1q_u8(in + pos);
+    if(vmaxvq_u8(vorrq_u8(vceqq_u8(block, delim), vceqq_u8(block, line)))) {
+      break;
+    }
+  }
+#endif
+  for(; pos < size && in[pos] != delimiter && in[pos] != '\n'; ++pos);
+  return pos;
+}
+
+static inline bool CsvIsBlank(unsigned char c) {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+/**
+ * Indexes the complete rows in [start, end), stopping early when 'cells' is full. When 'last' is set the end of
+ * input also ends a row. Returns the row count, or -1 if the first row needs more cells than are available.
+ */
+static INT64_VALUE CsvIndexRows(const unsigned char* in, size_t start, size_t end, unsigned char delimiter, bool last,
+                                INT64_VALUE* cells, size_t capacity)
+{
+  INT64_VALUE* out = cells + CSV_INDEX_HEADER;
+  size_t count = 0;
+  INT64_VALUE rows = 0;
+  size_t consumed = start;
+
+  size_t pos = start;
+  while(pos < end) {
+    const size_t row_first = count;
+    bool row_end = false;
+    bool blank = false;
+
+    while(!row_end) {
+      // leading blanks are dropped, an opening quote must come first
+      while(pos < end && (in[pos] == ' ' || in[pos] == '\t')) {
+        ++pos;
+      }
+
+      size_t cell_start, cell_end;
+      INT64_VALUE flags = 0;
+      if(pos < end && in[pos] == '"') {
+        cell_start = ++pos;
+        cell_end = end;
+        bool closed = false;
+        while(!closed) {
+          const unsigned char* quote = (const unsigned char*)memchr(in + pos, '"', end - pos);
+          if(!quote) {
+            if(!last) {
+              count = row_first;
+              goto done;
+            }
+            pos = end;
+            closed = true;
+          }
+          else {
+            pos = quote - in;
+            if(pos + 1 == end && !last) {
+              count = row_first;
+              goto done;
+            }
+            else if(pos + 1 < end && in[pos + 1] == '"') {
+              flags |= CSV_CELL_ESCAPED;
+              pos += 2;
+            }
+            else {
+              cell_end = pos++;
+              closed = true;
+            }
+          }
+        }
+        // anything between the closing quote and the next delimiter is ignored
+        pos = CsvCellStop(in, end, pos, delimiter);
+      }
+      else {
+        cell_start = pos;
+        pos = CsvCellStop(in, end, pos, delimiter);
+        cell_end = pos;
+        while(cell_end > cell_start && CsvIsBlank(in[cell_end - 1])) {
+          --cell_end;
+        }
+        blank = count == row_first && cell_end == cell_start;
+      }
+
+      if(pos == end) {
+        if(!last) {
+          count = row_first;
+          goto done;
+        }
+        row_end = true;
+      }
+      else {
+        row_end = in[pos++] == '\n';
+      }
+
+      if(count == capacity) {
+        if(rows == 0) {
+          return -1;
+        }
+        count = row_first;
+        goto done;
+      }
+
+      if(row_end) {
+        flags |= CSV_CELL_ROW_END;
+      }
+      out[count * 2] = ((INT64_VALUE)cell_start << 2) | flags;
+      out[count * 2 + 1] = (INT64_VALUE)cell_end;
+      ++count;
+
+      if(!row_end) {
+        blank = false;
+      }
+    }
+
+    // skip blank lines
+    if(blank) {
+      count = row_first;
+    }
+    else {
+      ++rows;
+    }
+    consumed = pos;
+  }
+
+done:
+  cells[0] = (INT64_VALUE)count;
+  cells[1] = rows;
+  cells[2] = (INT64_VALUE)consumed;
+
+  return rows;
+}
+
+static INT64_VALUE CsvToInt(const unsigned char* in, size_t start, size_t end) {
+  bool negative = false;
+  if(start < end && (in[start] == '-' || in[start] == '+')) {
+    negative = in[start++] == '-';
+  }
+
+  INT64_VALUE value = 0;
+  for(; start < end && in[start] >= '0' && in[start] <= '9'; ++start) {
+    value = value * 10 + (in[start] - '0');
+  }
+
+  return negative ? -value : value;
+}
+
+static FLOAT_VALUE CsvToFloat(const unsigned char* in, size_t start, size_t end) {
+  char buffer[64];
+  const size_t length = end - start;
+  if(length < sizeof(buffer)) {
+    memcpy(buffer, in + start, length);
+    buffer[length] = '\0';
+    return strtod(buffer, nullptr);
+  }
+
+  const std::string value((const char*)in + start, length);
+  return strtod(value.c_str(), nullptr);
+}
+
+/**
+ * Calls 'convert' with the byte range of 'column' in each indexed row, up to 'capacity' rows; rows without the
+ * column are passed an empty range. Returns the number of rows visited.
+ */
+template<typename Convert>
+static INT64_VALUE CsvColumn(const INT64_VALUE* cells, INT64_VALUE column, INT64_VALUE capacity, Convert convert)
+{
+  const INT64_VALUE count = cells[0];
+  const INT64_VALUE* in = cells + CSV_INDEX_HEADER;
+
+  INT64_VALUE row = 0;
+  INT64_VALUE index = 0;
+  bool found = false;
+  for(INT64_VALUE i = 0; i < count && row < capacity; ++i) {
+    const INT64_VALUE word = in[i * 2];
+    if(index == column) {
+      convert(row, (size_t)(word >> 2), (size_t)in[i * 2 + 1]);
+      found = true;
+    }
+
+    if(word & CSV_CELL_ROW_END) {
+      if(!found) {
+        convert(row, 0, 0);
+      }
+      found = false;
+      index = 0;
+      ++row;
+    }
+    else {
+      ++index;
+    }
+  }
+
+  return row;
+}
+
+bool TrapProcessor::CsvIndex(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  size_t* cells_array = (size_t*)PopInt(op_stack, stack_pos);
+  const bool last = PopInt(op_stack, stack_pos) != 0;
+  const unsigned char delimiter = (unsigned char)PopInt(op_stack, stack_pos);
+  const INT64_VALUE end = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  const INT64_VALUE start = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  const size_t* array = (size_t*)PopInt(op_stack, stack_pos);
+  if(!array || !cells_array) {
+    std::wcerr << L">>> Attempting to dereference a 'Nil' memory instance <<<" << std::endl;
+    return false;
+  }
+
+  const INT64_VALUE size = (INT64_VALUE)array[0];
+  const INT64_VALUE cells_size = (INT64_VALUE)cells_array[0];
+  if(start < 0 || start > end || end > size || cells_size < CSV_INDEX_HEADER) {
+    std::wcerr << L">>> Index out of bounds: " << end << L"," << size << L" <<<" << std::endl;
+    return false;
+  }
+
+  const INT64_VALUE rows = CsvIndexRows((const unsigned char*)(array + 3), (size_t)start, (size_t)end, delimiter, last,
+                                          (INT64_VALUE*)(cells_array + 3), (size_t)(cells_size - CSV_INDEX_HEADER) / 2);
+  PushInt((size_t)rows, op_stack, stack_pos);
+
+  return true;
+}
+
+bool TrapProcessor::CsvInts(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  const INT64_VALUE offset = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  size_t* values_array = (size_t*)PopInt(op_stack, stack_pos);
+  const INT64_VALUE column = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  const size_t* cells_array = (size_t*)PopInt(op_stack, stack_pos);
+  const size_t* array = (size_t*)PopInt(op_stack, stack_pos);
+  if(!array || !cells_array || !values_array) {
+    std::wcerr << L">>> Attempting to dereference a 'Nil' memory instance <<<" << std::endl;
+    return false;
+  }
+
+  const INT64_VALUE capacity = (INT64_VALUE)values_array[0] - offset;
+  if(offset < 0 || capacity < 0) {
+    std::wcerr << L">>> Index out of bounds: " << offset << L"," << values_array[0] << L" <<<" << std::endl;
+    return false;
+  }
+
+  const unsigned char* in = (const unsigned char*)(array + 3);
+  INT64_VALUE* values = (INT64_VALUE*)(values_array + 3) + offset;
+  const INT64_VALUE rows = CsvColumn((const INT64_VALUE*)(cells_array + 3), column, capacity,
+                                     [&](INT64_VALUE row, size_t start, size_t end) { values[row] = CsvToInt(in, start, end); });
+  PushInt((size_t)rows, op_stack, stack_pos);
+
+  return true;
+}
+
+bool TrapProcessor::CsvFloats(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  const INT64_VALUE offset = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  size_t* values_array = (size_t*)PopInt(op_stack, stack_pos);
+  const INT64_VALUE column = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  const size_t* cells_array = (size_t*)PopInt(op_stack, stack_pos);
+  const size_t* array = (size_t*)PopInt(op_stack, stack_pos);
+  if(!array || !cells_array || !values_array) {
+    std::wcerr << L">>> Attempting to dereference a 'Nil' memory instance <<<" << std::endl;
+    return false;
+  }
+
+  const INT64_VALUE capacity = (INT64_VALUE)values_array[0] - offset;
+  if(offset < 0 || capacity < 0) {
+    std::wcerr << L">>> Index out of bounds: " << offset << L"," << values_array[0] << L" <<<" << std::endl;
+    return false;
+  }
+
+  const unsigned char* in = (const unsigned char*)(array + 3);
+  FLOAT_VALUE* values = (FLOAT_VALUE*)(values_array + 3) + offset;
+  const INT64_VALUE rows = CsvColumn((const INT64_VALUE*)(cells_array + 3), column, capacity,
+                                     [&](INT64_VALUE row, size_t start, size_t end) { values[row] = CsvToFloat(in, start, end); });
+  PushInt((size_t)rows, op_stack, stack_pos);
+
+  return true;
+}
+
+/********************************
+ * XML tokenizer
+ ********************************/
+// token types and flags, in 'Data.XML.XmlReader' order
+enum XmlTokenType {
+  XML_TOKEN_START = 1,
+  XML_TOKEN_END,
+  XML_TOKEN_ATTRIBUTE,
+  XML_TOKEN_VALUE,
+  XML_TOKEN_TEXT,
+  XML_TOKEN_CDATA,
+  XML_TOKEN_COMMENT,
+  XML_TOKEN_DECLARATION
+};
+
+enum XmlTokenFlag {
+  XML_TOKEN_ENTITY = 1,
+  XML_TOKEN_EMPTY = 2
+};
+
+// words ahead of the first token: token count and offset after the last token
+#define XML_INDEX_HEADER 2
+#define XML_TOKEN_SIZE 3
+
+// token scan results, errors are returned as 'XML_SCAN_ERROR - offset'
+#define XML_SCAN_DONE 1
+#define XML_SCAN_MORE 0
+#define XML_SCAN_FULL -1
+#define XML_SCAN_ERROR -2
+
+struct XmlTokens {
+  INT64_VALUE* out;
+  size_t capacity;
+  size_t count;
+
+  bool Add(XmlTokenType type, INT64_VALUE flags, size_t start, size_t end, INT64_VALUE hash) {
+    if(count == capacity) {
+      return false;
+    }
+
+    INT64_VALUE* token = out + count * XML_TOKEN_SIZE;
+    token[0] = ((INT64_VALUE)start << 8) | (flags << 4) | type;
+    token[1] = (INT64_VALUE)end;
+    token[2] = hash;
+    ++count;
+
+    return true;
+  }
+};
+
+static inline bool XmlIsSpace(unsigned char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static inline bool XmlIsNameStart(unsigned char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == ':' || c >= 0x80;
+}
+
+static inline bool XmlIsName(unsigned char c) {
+  return XmlIsNameStart(c) || (c >= '0' && c <= '9') || c == '-' || c == '.';
+}
+
+/**
+ * 32-bit FNV-1a hash of a name, compared by 'Data.XML.XmlReader' to match end tags without creating strings
+ */
+static INT64_VALUE XmlHash(const unsigned char* in, size_t start, size_t end) {
+  uint32_t hash = 2166136261u;
+  for(size_t i = start; i < end; ++i) {
+    hash = (hash ^ in[i]) * 16777619u;
+  }
+
+  return (INT64_VALUE)hash;
+}
+
+/**
+ * Offset of the next '<' or '&'
+ */
+static size_t XmlTextStop(const unsigned char* in, size_t size, size_t pos) {
+#if defined(UTF8_AVX2)
+  const __m256i open = _mm256_set1_epi8('<');
+  const __m256i amp = _mm256_set1_epi8('&');
+  for(; pos + 32 <= size; pos += 32) {
+    const __m256i block = _mm256_loadu_si256((const __m256i*)(in + pos));
+    const uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(block, open), _mm256_cmpeq_epi8(block, amp)));
+    if(mask) {
+      return pos + JsonLowestBit(mask);
+    }
+  }
+#elif defined(UTF8_SSE2)
+  const __m128i open = _mm_set1_epi8('<');
+  const __m128i amp = _mm_set1_epi8('&');
+  for(; pos + 16 <= size; pos += 16) {
+    const __m128i block = _mm_loadu_si128((const __m128i*)(in + pos));
+    const uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, open), _mm_cmpeq_epi8(block, amp)));
+    if(mask) {
+      return pos + JsonLowestBit(mask);
+    }
+  }
+#elif defined(UTF8_NEON)
+  const uint8x16_t open = vdupq_n_u8('<');
+  const uint8x16_t amp = vdupq_n_u8('&');
+  for(; pos + 16 <= size; pos += 16) {
+    const uint8x16_t block = vld1q_u8(in + pos);
+    if(vmaxvq_u8(vorrq_u8(vceqq_u8(block, open), vceqq_u8(block, amp)))) {
+      break;
+    }
+  }
+#endif
+  for(; pos < size && in[pos] != '<' && in[pos] != '&'; ++pos);
+  return pos;
+}
+
+/**
+ * Offset of 'pattern' at or after 'pos', 'size' if not found
+ */
+static size_t XmlFind(const unsigned char* in, size_t size, size_t pos, const char* pattern, size_t length) {
+  while(pos + length <= size) {
+    const unsigned char* first = (const unsigned char*)memchr(in + pos, pattern[0], size - pos - length + 1);
+    if(!first) {
+      return size;
+    }
+
+    pos = first - in;
+    if(!memcmp(in + pos, pattern, length)) {
+      return pos;
+    }
+    ++pos;
+  }
+
+  return size;
+}
+
+static size_t XmlSkipSpace(const unsigned char* in, size_t size, size_t pos) {
+  for(; pos < size && XmlIsSpace(in[pos]); ++pos);
+  return pos;
+}
+
+static size_t XmlSkipName(const unsigned char* in, size_t size, size_t pos) {
+  if(pos < size && XmlIsNameStart(in[pos])) {
+    for(++pos; pos < size && XmlIsName(in[pos]); ++pos);
+  }
+
+  return pos;
+}
+
+/**
+ * Scans text up to the next tag, whitespace between tags is skipped
+ */
+static INT64_VALUE XmlScanText(const unsigned char* in, size_t size, size_t& pos, bool last, XmlTokens& tokens)
+{
+  INT64_VALUE flags = 0;
+  size_t stop = XmlTextStop(in, size, pos);
+  while(stop < size && in[stop] == '&') {
+    flags = XML_TOKEN_ENTITY;
+    stop = XmlTextStop(in, size, stop + 1);
+  }
+
+  if(stop == size && !last) {
+    return XML_SCAN_MORE;
+  }
+
+  if(XmlSkipSpace(in, stop, pos) < stop && !tokens.Add(XML_TOKEN_TEXT, flags, pos, stop, 0)) {
+    return XML_SCAN_FULL;
+  }
+  pos = stop;
+
+  return XML_SCAN_DONE;
+}
+
+/**
+ * Scans attributes up to the end of a tag, the closing '>' or '/>' or '?>' is left at 'pos'
+ */
+static INT64_VALUE XmlScanAttributes(const unsigned char* in, size_t size, size_t& pos, bool last, XmlTokens& tokens)
+{
+  while(true) {
+    const size_t name = XmlSkipSpace(in, size, pos);
+    if(name == size) {
+      return last ? XML_SCAN_ERROR - (INT64_VALUE)name : XML_SCAN_MORE;
+    }
+
+    if(in[name] == '>' || in[name] == '/' || in[name] == '?') {
+      pos = name;
+      return XML_SCAN_DONE;
+    }
+
+    const size_t name_end = XmlSkipName(in, size, name);
+    if(name_end == name) {
+      return XML_SCAN_ERROR - (INT64_VALUE)name;
+    }
+
+    size_t value = XmlSkipSpace(in, size, name_end);
+    if(value < size && in[value] != '=') {
+      return XML_SCAN_ERROR - (INT64_VALUE)value;
+    }
+    value = XmlSkipSpace(in, size, value + 1);
+    if(value >= size) {
+      return last ? XML_SCAN_ERROR - (INT64_VALUE)name : XML_SCAN_MORE;
+    }
+
+    const unsigned char quote = in[value];
+    if(quote != '"' && quote != '\'') {
+      return XML_SCAN_ERROR - (INT64_VALUE)value;
+    }
+
+    const unsigned char* close = (const unsigned char*)memchr(in + value + 1, quote, size - value - 1);
+    if(!close) {
+      return last ? XML_SCAN_ERROR - (INT64_VALUE)value : XML_SCAN_MORE;
+    }
+
+    const size_t value_end = close - in;
+    const INT64_VALUE flags = memchr(in + value + 1, '&', value_end - value - 1) ? XML_TOKEN_ENTITY : 0;
+    if(!tokens.Add(XML_TOKEN_ATTRIBUTE, 0, name, name_end, XmlHash(in, name, name_end)) ||
+       !tokens.Add(XML_TOKEN_VALUE, flags, value + 1, value_end, 0)) {
+      return XML_SCAN_FULL;
+    }
+    pos = value_end + 1;
+  }
+}
+
+/**
+ * Scans the markup starting at the '<' at 'pos'
+ */
+static INT64_VALUE XmlScanTag(const unsigned char* in, size_t size, size_t& pos, bool last, XmlTokens& tokens)
+{
+  const INT64_VALUE more = last ? XML_SCAN_ERROR - (INT64_VALUE)pos : XML_SCAN_MORE;
+  size_t next = pos + 1;
+  if(next == size) {
+    return more;
+  }
+
+  // comments, CDATA and doctypes
+  if(in[next] == '!') {
+    if(size - next < 3) {
+      return more;
+    }
+
+    if(in[next + 1] == '-' && in[next + 2] == '-') {
+      const size_t end = XmlFind(in, size, next + 3, "-->", 3);
+      if(end == size) {
+        return more;
+      }
+
+      if(!tokens.Add(XML_TOKEN_COMMENT, 0, next + 3, end, 0)) {
+        return XML_SCAN_FULL;
+      }
+      pos = end + 3;
+      return XML_SCAN_DONE;
+    }
+
+    if(in[next + 1] == '[') {
+      if(size - next < 8) {
+        return more;
+      }
+
+      if(memcmp(in + next, "![CDATA[", 8)) {
+        return XML_SCAN_ERROR - (INT64_VALUE)pos;
+      }
+
+      const size_t end = XmlFind(in, size, next + 8, "]]>", 3);
+      if(end == size) {
+        return more;
+      }
+
+      if(!tokens.Add(XML_TOKEN_CDATA, 0, next + 8, end, 0)) {
+        return XML_SCAN_FULL;
+      }
+      pos = end + 3;
+      return XML_SCAN_DONE;
+    }
+
+    // doctype and other declarations are skipped along with any internal subset
+    int depth = 0;
+    unsigned char quote = 0;
+    for(++next; next < size; ++next) {
+      const unsigned char c = in[next];
+      if(quote) {
+        if(c == quote) {
+          quote = 0;
+        }
+      }
+      else if(c == '"' || c == '\'') {
+        quote = c;
+      }
+      else if(c == '[') {
+        ++depth;
+      }
+      else if(c == ']') {
+        --depth;
+      }
+      else if(c == '>' && depth <= 0) {
+        pos = next + 1;
+        return XML_SCAN_DONE;
+      }
+    }
+
+    return more;
+  }
+
+  // processing instructions, pseudo-attributes are indexed when well formed
+  if(in[next] == '?') {
+    const size_t name = next + 1;
+    const size_t name_end = XmlSkipName(in, size, name);
+    if(name_end == size) {
+      return more;
+    }
+
+    if(name_end == name) {
+      return XML_SCAN_ERROR - (INT64_VALUE)name;
+    }
+
+    const size_t end = XmlFind(in, size, name_end, "?>", 2);
+    if(end == size) {
+      return more;
+    }
+
+    const size_t mark = tokens.count;
+    if(!tokens.Add(XML_TOKEN_DECLARATION, 0, name, name_end, XmlHash(in, name, name_end))) {
+      return XML_SCAN_FULL;
+    }
+
+    size_t attributes = name_end;
+    const INT64_VALUE status = XmlScanAttributes(in, end + 2, attributes, true, tokens);
+    if(status == XML_SCAN_FULL) {
+      return XML_SCAN_FULL;
+    }
+
+    if(status != XML_SCAN_DONE || attributes != end) {
+      tokens.count = mark + 1;
+    }
+    pos = end + 2;
+
+    return XML_SCAN_DONE;
+  }
+
+  // end tags
+  if(in[next] == '/') {
+    const size_t name = XmlSkipSpace(in, size, next + 1);
+    const size_t name_end = XmlSkipName(in, size, name);
+    const size_t close = XmlSkipSpace(in, size, name_end);
+    if(close == size) {
+      return more;
+    }
+
+    if(name_end == name || in[close] != '>') {
+      return XML_SCAN_ERROR - (INT64_VALUE)(name_end == name ? name : close);
+    }
+
+    if(!tokens.Add(XML_TOKEN_END, 0, name, name_end, XmlHash(in, name, name_end))) {
+      return XML_SCAN_FULL;
+    }
+    pos = close + 1;
+
+    return XML_SCAN_DONE;
+  }
+
+  // start tags
+  const size_t name = next;
+  const size_t name_end = XmlSkipName(in, size, name);
+  if(name_end == size) {
+    return more;
+  }
+
+  if(name_end == name) {
+    return XML_SCAN_ERROR - (INT64_VALUE)name;
+  }
+
+  const size_t start = tokens.count;
+  const INT64_VALUE hash = XmlHash(in, name, name_end);
+  if(!tokens.Add(XML_TOKEN_START, 0, name, name_end, hash)) {
+    return XML_SCAN_FULL;
+  }
+
+  size_t close = name_end;
+  const INT64_VALUE status = XmlScanAttributes(in, size, close, last, tokens);
+  if(status != XML_SCAN_DONE) {
+    return status;
+  }
+
+  if(in[close] == '/') {
+    if(close + 1 == size) {
+      return more;
+    }
+
+    if(in[close + 1] != '>') {
+      return XML_SCAN_ERROR - (INT64_VALUE)close;
+    }
+
+    tokens.out[start * XML_TOKEN_SIZE] |= XML_TOKEN_EMPTY << 4;
+    if(!tokens.Add(XML_TOKEN_END, 0, name, name_end, hash)) {
+      return XML_SCAN_FULL;
+    }
+    pos = close + 2;
+
+    return XML_SCAN_DONE;
+  }
+
+  if(in[close] != '>') {
+    return XML_SCAN_ERROR - (INT64_VALUE)close;
+  }
+  pos = close + 1;
+
+  return XML_SCAN_DONE;
+}
+
+/**
+ * Indexes the complete tokens in [start, end), stopping early when 'tokens' is full. When 'last' is set an
+ * unfinished token is an error. Returns the token count, -1 if the first token doesn't fit or 'XML_SCAN_ERROR'
+ * less the offset of the first error.
+ */
+static INT64_VALUE XmlIndexTokens(const unsigned char* in, size_t start, size_t end, bool last, INT64_VALUE* header, size_t capacity)
+{
+  XmlTokens tokens = { header + XML_INDEX_HEADER, capacity, 0 };
+  size_t pos = start;
+  INT64_VALUE status = XML_SCAN_DONE;
+  while(pos < end && status == XML_SCAN_DONE) {
+    const size_t mark = tokens.count;
+    status = in[pos] == '<' ? XmlScanTag(in, end, pos, last, tokens) : XmlScanText(in, end, pos, last, tokens);
+    if(status != XML_SCAN_DONE) {
+      tokens.count = mark;
+    }
+  }
+
+  header[0] = (INT64_VALUE)tokens.count;
+  header[1] = (INT64_VALUE)pos;
+
+  // tokens ahead of a problem are returned first
+  if(tokens.count == 0 && status < XML_SCAN_MORE) {
+    return status;
+  }
+
+  return (INT64_VALUE)tokens.count;
+}
+
+static void XmlAppendUtf8(std::string& out, uint32_t code) {
+  if(code < 0x80) {
+    out += (char)code;
+  }
+  else if(code < 0x800) {
+    out += (char)(0xc0 | (code >> 6));
+    out += (char)(0x80 | (code & 0x3f));
+  }
+  else if(code < 0x10000) {
+    out += (char)(0xe0 | (code >> 12));
+    out += (char)(0x80 | ((code >> 6) & 0x3f));
+    out += (char)(0x80 | (code & 0x3f));
+  }
+  else {
+    out += (char)(0xf0 | (code >> 18));
+    out += (char)(0x80 | ((code >> 12) & 0x3f));
+    out += (char)(0x80 | ((code >> 6) & 0x3f));
+    out += (char)(0x80 | (code & 0x3f));
+  }
+}
+
+/**
+ * Decodes the predefined and numeric character references, others are copied as is
+ */
+static std::string XmlDecodeReferences(const unsigned char* in, size_t start, size_t end) {
+  std::string out;
+  out.reserve(end - start);
+
+  size_t pos = start;
+  while(pos < end) {
+    const unsigned char* amp = (const unsigned char*)memchr(in + pos, '&', end - pos);
+    const size_t stop = amp ? amp - in : end;
+    out.append((const char*)in + pos, stop - pos);
+    pos = stop;
+    if(pos == end) {
+      return out;
+    }
+
+    const unsigned char* semi = (const unsigned char*)memchr(in + pos, ';', std::min(end - pos, (size_t)12));
+    const size_t length = semi ? semi - in - pos - 1 : 0;
+    const char* name = (const char*)in + pos + 1;
+    bool decoded = true;
+    if(length == 2 && !memcmp(name, "lt", 2)) {
+      out += '<';
+    }
+    else if(length == 2 && !memcmp(name, "gt", 2)) {
+      out += '>';
+    }
+    else if(length == 3 && !memcmp(name, "amp", 3)) {
+      out += '&';
+    }
+    else if(length == 4 && !memcmp(name, "quot", 4)) {
+      out += '"';
+    }
+    else if(length == 4 && !memcmp(name, "apos", 4)) {
+      out += '\'';
+    }
+    else if(length > 1 && name[0] == '#') {
+      const bool hex = name[1] == 'x' || name[1] == 'X';
+      uint32_t code = 0;
+      size_t i = hex ? 2 : 1;
+      for(; i < length && code <= 0x10ffff; ++i) {
+        const char c = name[i];
+        if(c >= '0' && c <= '9') {
+          code = code * (hex ? 16 : 10) + (c - '0');
+        }
+        else if(hex && c >= 'a' && c <= 'f') {
+          code = code * 16 + (c - 'a' + 10);
+        }
+        else if(hex && c >= 'A' && c <= 'F') {
+          code = code * 16 + (c - 'A' + 10);
+        }
+        else {
+          break;
+        }
+      }
+
+      decoded = i == length && i > (hex ? 2u : 1u) && code <= 0x10ffff;
+      if(decoded) {
+        XmlAppendUtf8(out, code);
+      }
+    }
+    else {
+      decoded = false;
+    }
+
+    if(decoded) {
+      pos += length + 2;
+    }
+    else {
+      out += '&';
+      ++pos;
+    }
+  }
+
+  return out;
+}
+
+bool TrapProcessor::XmlIndex(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  size_t* tokens_array = (size_t*)PopInt(op_stack, stack_pos);
+  const bool last = PopInt(op_stack, stack_pos) != 0;
+  const INT64_VALUE end = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  const INT64_VALUE start = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  const size_t* array = (size_t*)PopInt(op_stack, stack_pos);
+  if(!array || !tokens_array) {
+    std::wcerr << L">>> Attempting to dereference a 'Nil' memory instance <<<" << std::endl;
+    return false;
+  }
+
+  const INT64_VALUE size = (INT64_VALUE)array[0];
+  const INT64_VALUE tokens_size = (INT64_VALUE)tokens_array[0];
+  if(start < 0 || start > end || end > size || tokens_size < XML_INDEX_HEADER) {
+    std::wcerr << L">>> Index out of bounds: " << end << L"," << size << L" <<<" << std::endl;
+    return false;
+  }
+
+  const INT64_VALUE count = XmlIndexTokens((const unsigned char*)(array + 3), (size_t)start, (size_t)end, last,
+                                           (INT64_VALUE*)(tokens_array + 3), (size_t)(tokens_size - XML_INDEX_HEADER) / XML_TOKEN_SIZE);
+  PushInt((size_t)count, op_stack, stack_pos);
+
+  return true;
+}
+
+bool TrapProcessor::XmlDecode(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  const INT64_VALUE length = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  const INT64_VALUE offset = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  const size_t* array = (size_t*)PopInt(op_stack, stack_pos);
+  if(!array) {
+    std::wcerr << L">>> Attempting to dereference a 'Nil' memory instance <<<" << std::endl;
+    return false;
+  }
+
+  const INT64_VALUE size = (INT64_VALUE)array[0];
+  if(offset < 0 || length < 0 || offset + length > size) {
+    std::wcerr << L">>> Index out of bounds: " << offset + length << L"," << size << L" <<<" << std::endl;
+    return false;
+  }
+
+  const std::string value = XmlDecodeReferences((const unsigned char*)(array + 3), (size_t)offset, (size_t)(offset + length));
+  PushInt((size_t)CreateStringObject(value.c_str(), value.size(), program, op_stack, stack_pos), op_stack, stack_pos);
+
+  return true;
+}
+
+/********************************
+ * Regular expressions, programs are compiled by 'Query.RegEx.RegEx'
+ ********************************/
+enum RegexOp {
+  REGEX_CHAR = 1,   // char
+  REGEX_SET,        // bits for 0-63, bits for 64-127, matches 128 and above
+  REGEX_SPLIT,      // preferred target, other target
+  REGEX_JMP,        // target
+  REGEX_BOL,
+  REGEX_EOL,
+  REGEX_SAVE,       // slot
+  REGEX_MATCH
+};
+
+enum RegexMode {
+  REGEX_MODE_MATCH = 0,
+  REGEX_MODE_EXACT,
+  REGEX_MODE_SEARCH,
+  REGEX_MODE_GROUPS
+};
+
+enum RegexDfaKind {
+  REGEX_DFA_ANCHORED = 0,
+  REGEX_DFA_UNANCHORED,
+  REGEX_DFA_LONGEST,
+  REGEX_DFA_REVERSE,
+  REGEX_DFA_COUNT
+};
+
+#define REGEX_DEAD -1
+#define REGEX_UNKNOWN -2
+#define REGEX_DFA_BUDGET (1 << 20)
+#define REGEX_ENGINE_CACHE 16
+#define REGEX_PREFILTER_CHARS 3
+
+struct RegexItemsHash {
+  size_t operator()(const std::vector<int> &items) const {
+    size_t hash = 14695981039346656037ULL;
+    for(const int item : items) {
+      hash = (hash ^ (size_t)(unsigned)item) * 1099511628211ULL;
+    }
+    return hash;
+  }
+};
+
+/**
+ * Lazily built DFA, a state is a list of program counters and is only
+ * created the first time it's reached. Transitions are cached per
+ * character class, the table is flushed once it outgrows its budget.
+ */
+struct RegexDfa {
+  std::vector<std::vector<int>> states;
+  std::vector<int> next;
+  std::vector<char> matches;
+  std::vector<signed char> ends;
+  std::unordered_map<std::vector<int>, int, RegexItemsHash> index;
+  int starts[2] = { REGEX_UNKNOWN, REGEX_UNKNOWN };
+  int flushes = 0;
+};
+
+/**
+ * Compiled regular expression. Searches run a forward DFA to find where the leftmost match ends
+ * and a reverse DFA to find where it starts. Groups are captured by a Pike VM once a match is known.
+ * Every path runs in time linear to the input.
+ */
+class RegexEngine {
+  std::vector<INT64_VALUE> code;
+  size_t hash;
+  int entry;
+  int match_pc;
+  int restart;
+  int slot_count;
+
+  // characters no instruction can tell apart share a class
+  int ascii_classes[128];
+  std::vector<std::pair<wchar_t, int>> wide_classes;
+  int other_class;
+  int class_count;
+  std::vector<int> consumers;
+  std::vector<char> accepts;
+
+  // edges walked backwards by the reverse DFA
+  std::vector<std::vector<int>> reverse_moves;
+  std::vector<std::vector<int>> reverse_consumers;
+
+  // characters that may start a match, empty if unknown or too many
+  std::vector<wchar_t> first_chars;
+
+  RegexDfa dfas[REGEX_DFA_COUNT];
+  std::vector<int> marks;
+  int mark;
+  std::vector<int> work;
+  std::vector<int> scratch;
+
+  inline INT64_VALUE Width(INT64_VALUE pc) const {
+    switch(code[pc]) {
+    case REGEX_CHAR:
+    case REGEX_JMP:
+    case REGEX_SAVE:
+      return 2;
+
+    case REGEX_SPLIT:
+      return 3;
+
+    case REGEX_SET:
+      return 4;
+
+    default:
+      return 1;
+    }
+  }
+
+  inline INT64_VALUE Next(int pc) const {
+    return pc + Width(pc);
+  }
+
+  bool Accepts(int pc, wchar_t c, bool other) const {
+    if(code[pc] == REGEX_CHAR) {
+      return !other && (wchar_t)code[pc + 1] == c;
+    }
+
+    if(other || (size_t)c >= 128) {
+      return code[pc + 3] != 0;
+    }
+
+    return ((code[pc + 1 + (c >> 6)] >> (c & 63)) & 1) != 0;
+  }
+
+  bool Validate() {
+    const INT64_VALUE size = (INT64_VALUE)code.size();
+    if(size < 2 || code[0] < 2 || code[0] > size) {
+      return false;
+    }
+    slot_count = (int)code[0];
+
+    std::vector<char> starts(size, 0);
+    INT64_VALUE pc = 1;
+    match_pc = -1;
+    while(pc < size) {
+      starts[pc] = 1;
+      switch(code[pc]) {
+      case REGEX_CHAR:
+      case REGEX_SET:
+      case REGEX_SPLIT:
+      case REGEX_JMP:
+      case REGEX_BOL:
+      case REGEX_EOL:
+      case REGEX_SAVE:
+        break;
+
+      case REGEX_MATCH:
+        if(match_pc >= 0) {
+          return false;
+        }
+        match_pc = (int)pc;
+        break;
+
+      default:
+        return false;
+      }
+
+      // everything but jumps and the match falls through to a next instruction
+      const INT64_VALUE width = Width(pc);
+      const bool falls = code[pc] != REGEX_SPLIT && code[pc] != REGEX_JMP && code[pc] != REGEX_MATCH;
+      if(pc + width > size || (falls && pc + width == size)) {
+        return false;
+      }
+      pc += width;
+    }
+
+    for(pc = 1; pc < size; pc += Width(pc)) {
+      if(code[pc] == REGEX_SPLIT || code[pc] == REGEX_JMP) {
+        for(INT64_VALUE i = 1; i < Width(pc); ++i) {
+          if(code[pc + i] < 1 || code[pc + i] >= size || !starts[code[pc + i]]) {
+            return false;
+          }
+        }
+      }
+    }
+
+    return match_pc >= 0;
+  }
+
+  void BuildClasses() {
+    std::vector<int> pcs;
+    for(INT64_VALUE pc = 1; pc < (INT64_VALUE)code.size(); pc += Width(pc)) {
+      if(code[pc] == REGEX_CHAR || code[pc] == REGEX_SET) {
+        pcs.push_back((int)pc);
+      }
+    }
+
+    consumers.assign(code.size(), -1);
+    for(size_t i = 0; i < pcs.size(); ++i) {
+      consumers[pcs[i]] = (int)i;
+    }
+
+    // characters with the same signature share a class
+    std::unordered_map<std::string, int> signatures;
+    std::vector<std::string> class_signatures;
+    auto classify = [&](wchar_t c, bool other) {
+      std::string signature(pcs.size(), '0');
+      for(size_t i = 0; i < pcs.size(); ++i) {
+        if(Accepts(pcs[i], c, other)) {
+          signature[i] = '1';
+        }
+      }
+
+      auto result = signatures.find(signature);
+      if(result != signatures.end()) {
+        return result->second;
+      }
+
+      const int id = (int)class_signatures.size();
+      signatures.insert(std::make_pair(signature, id));
+      class_signatures.push_back(signature);
+      return id;
+    };
+
+    for(int c = 0; c < 128; ++c) {
+      ascii_classes[c] = classify((wchar_t)c, false);
+    }
+
+    for(const int pc : pcs) {
+      const wchar_t c = (wchar_t)code[pc + 1];
+      if(code[pc] == REGEX_CHAR && (size_t)c >= 128) {
+        bool found = false;
+        for(const auto &wide : wide_classes) {
+          found = found || wide.first == c;
+        }
+
+        if(!found) {
+          wide_classes.push_back(std::make_pair(c, classify(c, false)));
+        }
+      }
+    }
+    other_class = classify(0, true);
+    class_count = (int)class_signatures.size();
+
+    accepts.assign(pcs.size() * class_count, 0);
+    for(size_t i = 0; i < pcs.size(); ++i) {
+      for(int j = 0; j < class_count; ++j) {
+        accepts[i * class_count + j] = class_signatures[j][i] == '1';
+      }
+    }
+  }
+
+  void BuildReverse() {
+    reverse_moves.assign(code.size(), std::vector<int>());
+    reverse_consumers.assign(code.size(), std::vector<int>());
+    for(INT64_VALUE pc = 1; pc < (INT64_VALUE)code.size(); pc += Width(pc)) {
+      switch(code[pc]) {
+      case REGEX_CHAR:
+      case REGEX_SET:
+        reverse_consumers[Next((int)pc)].push_back((int)pc);
+        break;
+
+      case REGEX_SPLIT:
+        reverse_moves[code[pc + 1]].push_back((int)pc);
+        reverse_moves[code[pc + 2]].push_back((int)pc);
+        break;
+
+      case REGEX_JMP:
+        reverse_moves[code[pc + 1]].push_back((int)pc);
+        break;
+
+      case REGEX_SAVE:
+      case REGEX_BOL:
+      case REGEX_EOL:
+        reverse_moves[Next((int)pc)].push_back((int)pc);
+        break;
+      }
+    }
+  }
+
+  void BuildPrefilter() {
+    RegexDfa &dfa = dfas[REGEX_DFA_UNANCHORED];
+    const int start = Start(dfa, REGEX_DFA_UNANCHORED, false);
+    if(start == REGEX_DEAD) {
+      return;
+    }
+
+    std::vector<char> firsts(class_count, 0);
+    for(const int pc : dfa.states[start]) {
+      if(pc == restart) {
+        continue;
+      }
+
+      const int consumer = consumers[pc];
+      if(consumer < 0) {
+        return;
+      }
+
+      for(int i = 0; i < class_count; ++i) {
+        firsts[i] |= accepts[consumer * class_count + i];
+      }
+    }
+
+    if(firsts[other_class]) {
+      return;
+    }
+
+    std::vector<wchar_t> chars;
+    for(int c = 0; c < 128; ++c) {
+      if(firsts[ascii_classes[c]]) {
+        chars.push_back((wchar_t)c);
+      }
+    }
+
+    for(const auto &wide : wide_classes) {
+      if(firsts[wide.second]) {
+        chars.push_back(wide.first);
+      }
+    }
+
+    if(!chars.empty() && chars.size() <= REGEX_PREFILTER_CHARS) {
+      first_chars = chars;
+    }
+  }
+
+  /**
+   * Follows the empty moves from 'pc' in priority order. Leftmost first closures
+   * stop at the first match since lower priority threads can't win.
+   */
+  void Closure(int pc, bool at_begin, bool leftmost, std::vector<int> &items, bool &matched) {
+    work.clear();
+    work.push_back(pc);
+    while(!work.empty() && !matched) {
+      const int top = work.back();
+      work.pop_back();
+      if(marks[top] == mark) {
+        continue;
+      }
+      marks[top] = mark;
+
+      switch(code[top]) {
+      case REGEX_CHAR:
+      case REGEX_SET:
+      case REGEX_EOL:
+        items.push_back(top);
+        break;
+
+      case REGEX_MATCH:
+        items.push_back(top);
+        matched = leftmost;
+        break;
+
+      case REGEX_SPLIT:
+        work.push_back((int)code[top + 2]);
+        work.push_back((int)code[top + 1]);
+        break;
+
+      case REGEX_JMP:
+        work.push_back((int)code[top + 1]);
+        break;
+
+      case REGEX_SAVE:
+        work.push_back(top + 2);
+        break;
+
+      case REGEX_BOL:
+        if(at_begin) {
+          work.push_back(top + 1);
+        }
+        break;
+      }
+    }
+  }
+
+  /**
+   * Follows the empty moves into 'pc' backwards. Start of input checks can only
+   * pass once the scan is done and are kept as negative pending items.
+   */
+  void ReverseClosure(int pc, bool at_end, std::vector<int> &items) {
+    work.clear();
+    work.push_back(pc);
+    while(!work.empty()) {
+      const int top = work.back();
+      work.pop_back();
+      if(marks[top] == mark) {
+        continue;
+      }
+      marks[top] = mark;
+
+      if(top == entry || !reverse_consumers[top].empty()) {
+        items.push_back(top);
+      }
+
+      for(const int from : reverse_moves[top]) {
+        if(code[from] == REGEX_BOL) {
+          items.push_back(-1 - from);
+        }
+        else if(code[from] != REGEX_EOL || at_end) {
+          work.push_back(from);
+        }
+      }
+    }
+  }
+
+  int Intern(RegexDfa &dfa, RegexDfaKind kind, std::vector<int> &items) {
+    if(items.empty()) {
+      return REGEX_DEAD;
+    }
+
+    if(kind >= REGEX_DFA_LONGEST) {
+      std::sort(items.begin(), items.end());
+      items.erase(std::unique(items.begin(), items.end()), items.end());
+    }
+
+    auto result = dfa.index.find(items);
+    if(result != dfa.index.end()) {
+      return result->second;
+    }
+
+    // start over rather than grow without bound
+    if((dfa.states.size() + 1) * class_count > REGEX_DFA_BUDGET) {
+      dfa.states.clear();
+      dfa.next.clear();
+      dfa.matches.clear();
+      dfa.ends.clear();
+      dfa.index.clear();
+      dfa.starts[0] = dfa.starts[1] = REGEX_UNKNOWN;
+      ++dfa.flushes;
+    }
+
+    const int id = (int)dfa.states.size();
+    bool is_match = false;
+    for(const int pc : items) {
+      if(kind == REGEX_DFA_REVERSE) {
+        is_match = is_match || pc == entry;
+      }
+      else {
+        is_match = is_match || (pc != restart && code[pc] == REGEX_MATCH);
+      }
+    }
+
+    dfa.states.push_back(items);
+    dfa.next.insert(dfa.next.end(), class_count, REGEX_UNKNOWN);
+    dfa.matches.push_back(is_match);
+    dfa.ends.push_back(-1);
+    dfa.index.insert(std::make_pair(items, id));
+
+    return id;
+  }
+
+  int Start(RegexDfa &dfa, RegexDfaKind kind, bool edge) {
+    if(dfa.starts[edge] != REGEX_UNKNOWN) {
+      return dfa.starts[edge];
+    }
+
+    ++mark;
+    scratch.clear();
+    bool matched = false;
+    if(kind == REGEX_DFA_REVERSE) {
+      ReverseClosure(match_pc, edge, scratch);
+    }
+    else {
+      Closure(entry, edge, kind != REGEX_DFA_LONGEST, scratch, matched);
+      if(kind == REGEX_DFA_UNANCHORED && !matched) {
+        scratch.push_back(restart);
+      }
+    }
+
+    const int start = Intern(dfa, kind, scratch);
+    dfa.starts[edge] = start;
+    return start;
+  }
+
+  int Step(RegexDfa &dfa, RegexDfaKind kind, int state, int char_class) {
+    const int cached = dfa.next[state * class_count + char_class];
+    if(cached != REGEX_UNKNOWN) {
+      return cached;
+    }
+
+    ++mark;
+    scratch.clear();
+    bool matched = false;
+    const std::vector<int> &items = dfa.states[state];
+    if(kind == REGEX_DFA_REVERSE) {
+      for(const int pc : items) {
+        if(pc >= 0) {
+          for(const int from : reverse_consumers[pc]) {
+            if(accepts[consumers[from] * class_count + char_class]) {
+              ReverseClosure(from, false, scratch);
+            }
+          }
+        }
+      }
+    }
+    else {
+      const bool leftmost = kind != REGEX_DFA_LONGEST;
+      for(size_t i = 0; i < items.size() && !matched; ++i) {
+        const int pc = items[i];
+        if(pc == restart) {
+          Closure(entry, false, leftmost, scratch, matched);
+          if(!matched) {
+            scratch.push_back(restart);
+          }
+        }
+        else if(consumers[pc] >= 0 && accepts[consumers[pc] * class_count + char_class]) {
+          Closure((int)Next(pc), false, leftmost, scratch, matched);
+        }
+      }
+    }
+
+    const int flushes = dfa.flushes;
+    const int next = Intern(dfa, kind, scratch);
+    if(dfa.flushes == flushes) {
+      dfa.next[state * class_count + char_class] = next;
+    }
+
+    return next;
+  }
+
+  /**
+   * Checks if a state matches once the input runs out, resolving the end of
+   * input checks for forward scans and start of input checks for reverse ones
+   */
+  bool MatchesAtEdge(RegexDfa &dfa, RegexDfaKind kind, int state, bool other_edge) {
+    if(dfa.matches[state]) {
+      return true;
+    }
+
+    if(!other_edge && dfa.ends[state] >= 0) {
+      return dfa.ends[state] != 0;
+    }
+
+    ++mark;
+    scratch.assign(dfa.states[state].begin(), dfa.states[state].end());
+    bool matched = false;
+    // edge checks can follow each other, so closures keep feeding the list
+    for(size_t i = 0; i < scratch.size() && !matched; ++i) {
+      const int pc = scratch[i];
+      if(kind == REGEX_DFA_REVERSE) {
+        if(pc < 0) {
+          ReverseClosure(-1 - pc, other_edge, scratch);
+        }
+        else {
+          matched = pc == entry;
+        }
+      }
+      else if(pc != restart && code[pc] == REGEX_EOL) {
+        Closure(pc + 1, other_edge, true, scratch, matched);
+      }
+      else {
+        matched = pc != restart && code[pc] == REGEX_MATCH;
+      }
+    }
+
+    if(!other_edge) {
+      dfa.ends[state] = matched;
+    }
+
+    return matched;
+  }
+
+  size_t SkipToFirst(const wchar_t* in, size_t size, size_t pos) const {
+    if(first_chars.size() == 1) {
+      const wchar_t* found = wmemchr(in + pos, first_chars[0], size - pos);
+      return found ? (size_t)(found - in) : size;
+    }
+
+#if (defined(UTF8_AVX2) || defined(UTF8_SSE2)) && WCHAR_MAX > 0xffff
+    const __m128i first = _mm_set1_epi32((int)first_chars[0]);
+    const __m128i second = _mm_set1_epi32((int)first_chars[1]);
+    const __m128i third = _mm_set1_epi32((int)first_chars[first_chars.size() - 1]);
+    for(; pos + 4 <= size; pos += 4) {
+      const __m128i block = _mm_loadu_si128((const __m128i*)(in + pos));
+      const __m128i hits = _mm_or_si128(_mm_cmpeq_epi32(block, first), _mm_or_si128(_mm_cmpeq_epi32(block, second), _mm_cmpeq_epi32(block, third)));
+      const uint32_t mask = (uint32_t)_mm_movemask_epi8(hits);
+      if(mask) {
+        return pos + JsonLowestBit(mask) / 4;
+      }
+    }
+#endif
+    for(; pos < size; ++pos) {
+      for(const wchar_t c : first_chars) {
+        if(in[pos] == c) {
+          return pos;
+        }
+      }
+    }
+
+    return size;
+  }
+
+  /**
+   * Runs a forward DFA from 'offset', returns the end of the leftmost first
+   * match or the end of the longest match, -1 if none
+   */
+  INT64_VALUE Forward(RegexDfaKind kind, const wchar_t* in, size_t size, size_t offset) {
+    RegexDfa &dfa = dfas[kind];
+    int state = Start(dfa, kind, offset == 0);
+    if(state == REGEX_DEAD) {
+      return -1;
+    }
+    INT64_VALUE last = dfa.matches[state] ? (INT64_VALUE)offset : -1;
+
+    const bool skip = kind == REGEX_DFA_UNANCHORED && !first_chars.empty();
+    size_t pos = offset;
+    while(pos < size) {
+      if(skip && state == dfa.starts[0]) {
+        pos = SkipToFirst(in, size, pos);
+        if(pos == size) {
+          break;
+        }
+      }
+
+      state = Step(dfa, kind, state, Class(in[pos]));
+      ++pos;
+      if(state == REGEX_DEAD) {
+        return last;
+      }
+      else if(dfa.matches[state]) {
+        last = pos;
+      }
+    }
+
+    if(MatchesAtEdge(dfa, kind, state, size == 0)) {
+      last = size;
+    }
+
+    return last;
+  }
+
+  /**
+   * Walks back from the end of a match to its leftmost start, not before 'lower'
+   */
+  INT64_VALUE Reverse(const wchar_t* in, size_t size, size_t lower, size_t end) {
+    RegexDfa &dfa = dfas[REGEX_DFA_REVERSE];
+    int state = Start(dfa, REGEX_DFA_REVERSE, end == size);
+    if(state == REGEX_DEAD) {
+      return -1;
+    }
+    INT64_VALUE first = dfa.matches[state] ? (INT64_VALUE)end : -1;
+
+    size_t pos = end;
+    while(pos > lower) {
+      state = Step(dfa, REGEX_DFA_REVERSE, state, Class(in[pos - 1]));
+      if(state == REGEX_DEAD) {
+        return first;
+      }
+
+      --pos;
+      if(dfa.matches[state]) {
+        first = pos;
+      }
+    }
+
+    if(pos == 0 && MatchesAtEdge(dfa, REGEX_DFA_REVERSE, state, size == 0)) {
+      first = 0;
+    }
+
+    return first;
+  }
+
+  void AddThread(std::vector<std::pair<int, std::vector<INT64_VALUE>>> &threads, int pc, const std::vector<INT64_VALUE> &slots, size_t pos, size_t size) {
+    std::vector<std::pair<int, std::vector<INT64_VALUE>>> pending;
+    pending.push_back(std::make_pair(pc, slots));
+    while(!pending.empty()) {
+      std::pair<int, std::vector<INT64_VALUE>> top = std::move(pending.back());
+      pending.pop_back();
+      if(marks[top.first] == mark) {
+        continue;
+      }
+      marks[top.first] = mark;
+
+      switch(code[top.first]) {
+      case REGEX_CHAR:
+      case REGEX_SET:
+      case REGEX_MATCH:
+        threads.push_back(std::move(top));
+        break;
+
+      case REGEX_SPLIT:
+        pending.push_back(std::make_pair((int)code[top.first + 2], top.second));
+        pending.push_back(std::make_pair((int)code[top.first + 1], top.second));
+        break;
+
+      case REGEX_JMP:
+        pending.push_back(std::make_pair((int)code[top.first + 1], top.second));
+        break;
+
+      case REGEX_SAVE:
+        if(code[top.first + 1] >= 0 && code[top.first + 1] < slot_count) {
+          top.second[code[top.first + 1]] = pos;
+        }
+        pending.push_back(std::make_pair(top.first + 2, top.second));
+        break;
+
+      case REGEX_BOL:
+        if(pos == 0) {
+          pending.push_back(std::make_pair(top.first + 1, top.second));
+        }
+        break;
+
+      case REGEX_EOL:
+        if(pos == size) {
+          pending.push_back(std::make_pair(top.first + 1, top.second));
+        }
+        break;
+      }
+    }
+  }
+
+public:
+  RegexEngine(const INT64_VALUE* program, size_t size, size_t h) : code(program, program + size), hash(h) {
+    entry = 1;
+    restart = (int)size;
+    mark = 0;
+    class_count = 0;
+    other_class = 0;
+    marks.assign(size + 1, 0);
+  }
+
+  bool Initialize() {
+    if(!Validate()) {
+      return false;
+    }
+
+    BuildClasses();
+    BuildReverse();
+    BuildPrefilter();
+
+    return true;
+  }
+
+  bool Is(const INT64_VALUE* program, size_t size, size_t h) const {
+    return hash == h && code.size() == size && !memcmp(code.data(), program, size * sizeof(INT64_VALUE));
+  }
+
+  int GetSlotCount() const {
+    return slot_count;
+  }
+
+  inline int Class(wchar_t c) const {
+    if((size_t)c < 128) {
+      return ascii_classes[c];
+    }
+
+    for(const auto &wide : wide_classes) {
+      if(wide.first == c) {
+        return wide.second;
+      }
+    }
+
+    return other_class;
+  }
+
+  INT64_VALUE Match(const wchar_t* in, size_t size, size_t offset) {
+    return Forward(REGEX_DFA_ANCHORED, in, size, offset);
+  }
+
+  bool Exact(const wchar_t* in, size_t size, size_t offset) {
+    RegexDfa &dfa = dfas[REGEX_DFA_LONGEST];
+    int state = Start(dfa, REGEX_DFA_LONGEST, offset == 0);
+    if(state == REGEX_DEAD) {
+      return false;
+    }
+
+    for(size_t pos = offset; pos < size; ++pos) {
+      state = Step(dfa, REGEX_DFA_LONGEST, state, Class(in[pos]));
+      if(state == REGEX_DEAD) {
+        return false;
+      }
+    }
+
+    return MatchesAtEdge(dfa, REGEX_DFA_LONGEST, state, size == 0);
+  }
+
+  INT64_VALUE Search(const wchar_t* in, size_t size, size_t offset, INT64_VALUE &end) {
+    end = Forward(REGEX_DFA_UNANCHORED, in, size, offset);
+    if(end < 0) {
+      return -1;
+    }
+
+    return Reverse(in, size, offset, (size_t)end);
+  }
+
+  /**
+   * Captures groups for the leftmost first match at 'start'
+   */
+  bool Groups(const wchar_t* in, size_t size, size_t start, std::vector<INT64_VALUE> &slots) {
+    std::vector<std::pair<int, std::vector<INT64_VALUE>>> threads;
+    std::vector<std::pair<int, std::vector<INT64_VALUE>>> next_threads;
+
+    ++mark;
+    AddThread(threads, entry, std::vector<INT64_VALUE>(slot_count, -1), start, size);
+
+    bool found = false;
+    for(size_t pos = start; !threads.empty(); ++pos) {
+      ++mark;
+      next_threads.clear();
+      for(size_t i = 0; i < threads.size(); ++i) {
+        const int pc = threads[i].first;
+        if(code[pc] == REGEX_MATCH) {
+          slots = threads[i].second;
+          found = true;
+          break;
+        }
+        else if(pos < size && accepts[consumers[pc] * class_count + Class(in[pos])]) {
+          AddThread(next_threads, (int)Next(pc), threads[i].second, pos + 1, size);
+        }
+      }
+      threads.swap(next_threads);
+    }
+
+    return found;
+  }
+};
+
+static RegexEngine* RegexEngineFor(const INT64_VALUE* program, size_t size) {
+  static thread_local std::vector<std::unique_ptr<RegexEngine>> engines;
+
+  size_t hash = 14695981039346656037ULL;
+  for(size_t i = 0; i < size; ++i) {
+    hash = (hash ^ (size_t)program[i]) * 1099511628211ULL;
+  }
+
+  for(size_t i = 0; i < engines.size(); ++i) {
+    if(engines[i]->Is(program, size, hash)) {
+      std::rotate(engines.begin(), engines.begin() + i, engines.begin() + i + 1);
+      return engines[0].get();
+    }
+  }
+
+  std::unique_ptr<RegexEngine> engine(new RegexEngine(program, size, hash));
+  if(!engine->Initialize()) {
+    return nullptr;
+  }
+
+  if(engines.size() >= REGEX_ENGINE_CACHE) {
+    engines.pop_back();
+  }
+  engines.insert(engines.begin(), std::move(engine));
+
+  return engines[0].get();
+}
+
+bool TrapProcessor::RegexExecute(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame)
+{
+  size_t* slots_array = (size_t*)PopInt(op_stack, stack_pos);
+  const INT64_VALUE mode = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  const INT64_VALUE offset = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  const size_t* str_obj = (size_t*)PopInt(op_stack, stack_pos);
+  const size_t* code_array = (size_t*)PopInt(op_stack, stack_pos);
+  if(!code_array || !str_obj) {
+    std::wcerr << L">>> Attempting to dereference a 'Nil' memory instance <<<" << std::endl;
+    return false;
+  }
+
+  RegexEngine* engine = RegexEngineFor((const INT64_VALUE*)(code_array + 3), code_array[0]);
+  if(!engine) {
+    std::wcerr << L">>> Invalid regular expression program <<<" << std::endl;
+    return false;
+  }
+
+  const wchar_t* in = (const wchar_t*)((size_t*)str_obj[0] + 3);
+  const size_t size = str_obj[2];
+  if(offset < 0 || offset > (INT64_VALUE)size) {
+    PushInt((size_t)-1, op_stack, stack_pos);
+    return true;
+  }
+
+  INT64_VALUE result = -1;
+  switch(mode) {
+  case REGEX_MODE_MATCH:
+    result = engine->Match(in, size, (size_t)offset);
+    break;
+
+  case REGEX_MODE_EXACT:
+    result = engine->Exact(in, size, (size_t)offset) ? 1 : 0;
+    break;
+
+  case REGEX_MODE_SEARCH:
+  case REGEX_MODE_GROUPS: {
+    const INT64_VALUE slot_count = mode == REGEX_MODE_SEARCH ? 2 : engine->GetSlotCount();
+    if(!slots_array || (INT64_VALUE)slots_array[0] < slot_count) {
+      std::wcerr << L">>> Index out of bounds: " << slot_count << L"," << (slots_array ? (INT64_VALUE)slots_array[0] : 0) << L" <<<" << std::endl;
+      return false;
+    }
+
+    INT64_VALUE end = -1;
+    result = engine->Search(in, size, (size_t)offset, end);
+
+    INT64_VALUE* slots = (INT64_VALUE*)(slots_array + 3);
+    for(INT64_VALUE i = 0; i < slot_count; ++i) {
+      slots[i] = -1;
+    }
+
+    if(result >= 0) {
+      std::vector<INT64_VALUE> groups;
+      if(mode == REGEX_MODE_GROUPS && engine->Groups(in, size, (size_t)result, groups)) {
+        memcpy(slots, groups.data(), slot_count * sizeof(INT64_VALUE));
+      }
+      slots[0] = result;
+      slots[1] = end;
+    }
+  }
+    break;
+
+  default:
+    std::wcerr << L">>> Invalid regular expression mode: " << mode << L" <<<" << std::endl;
+    return false;
+  }
+  PushInt((size_t)result, op_stack, stack_pos);
+
+  return true;
+}
+
+bool TrapProcessor::FileInByte(StackProgram* program, size_t* inst, size_t* &op_stack, long* &stack_pos, StackFrame* frame)
+{
+  const size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  if((FILE*)instance[0]) {
+    FILE* file = (FILE*)instance[0];
+    const int value = fgetc(file);
+    PushInt(value < 0 ? 0 : value, op_stack, stack_pos);
+  }
+  else {
+    PushInt(0, op_stack, stack_pos);
+  }
+
+  return true;
+}
+
+bool TrapProcessor::FileInCharAry(StackProgram* program, size_t* inst, size_t* &op_stack, long* &stack_pos, StackFrame* frame)
+{
+  const size_t* array = (size_t*)PopInt(op_stack, stack_pos);
+  const INT64_VALUE num = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  const INT64_VALUE offset = (INT64_VALUE)PopInt(op_stack, stack_pos);
+  const size_t* instance = (size_t*)PopInt(op_stack, stack_pos);
+  
+  if(array && instance && (FILE*)instance[0] && offset > -1 && offset + num <= (long)array[0]) {
+    FILE* file = (FILE*)instance[0];
+
+    // read from file
+    char* byte_buffer = new char[num + 1];
+    Runtime::ThreadScheduler::BlockingStart();
+    const size_t read = fread(byte_buffer, 1, num, file);
+    Runtime::ThreadScheduler::BlockingEnd();
+
+    // copy and remove file BOM
+    PushInt(DecodeCharArray(byte_buffer, read, array, offset, true), op_stack, stack_pos);
+
+    // clean up
+    delete[] byte_buffer;
+    byte_buffer = nullptr;
   }
   else {
     PushInt(-1, op_stack, stack_pos);
@@ -5616,7 +9316,9 @@ bool TrapProcessor::FileInByteAry(StackProgram* program, size_t* inst, size_t* &
   if(array && instance && (FILE*)instance[0] && offset > -1 && offset + num <= (long)array[0]) {
     FILE* file = (FILE*)instance[0];
     char* buffer = (char*)(array + 3);
+    Runtime::ThreadScheduler::BlockingStart();
     const size_t read = fread(buffer + offset, 1, num, file);
+    Runtime::ThreadScheduler::BlockingEnd();
     PushInt(read, op_stack, stack_pos);
   }
   else {
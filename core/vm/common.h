@@ -39,10 +39,13 @@
 #include <fstream>
 #include <stack>
 #include <vector>
+#include <memory>
 #include <list>
 #include <set>
+#include <atomic>
 #include <string>
 #include <ctime>
+#include <chrono>
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
@@ -899,6 +902,180 @@ class StackClass {
   }
 };
 
+/********************************
+ * SocketBuffer class, per-socket 
+ * receive and send buffers that 
+ * replace per-byte system calls
+ ********************************/
+#define SOCKET_BUFFER_MAX 16384
+
+// socket poller events, must match 'SocketPoller->Event'
+#define SOCKET_POLL_READ 1
+#define SOCKET_POLL_WRITE 2
+#define SOCKET_POLL_CLOSED 4
+#define SOCKET_POLL_MAX 256
+
+class SocketBuffer {
+  size_t sock;
+  SSL_CTX* ctx;
+  BIO* bio;
+  bool is_secure;
+  // input is guarded by 'read_lock' and output by 'write_lock', so one thread
+  // can read while another writes. Readers take 'write_lock' to flush before
+  // blocking, writers never take 'read_lock'.
+  char* in_buffer;
+  int in_pos;
+  int in_end;
+  char* out_buffer;
+  int out_end;
+  // reads of plain sockets fail once the deadline passes, guarded by 'read_lock'
+  bool has_deadline;
+  std::chrono::steady_clock::time_point deadline;
+#ifdef _WIN32
+  CRITICAL_SECTION read_lock;
+  CRITICAL_SECTION write_lock;
+#else
+  pthread_mutex_t read_lock;
+  pthread_mutex_t write_lock;
+#endif
+  // references held by the buffer map and by calls in progress, guarded by
+  // the map's lock. Buffers are deleted once released and no call uses them.
+  int refs;
+  // set while the socket is listed in its pollers' pending sets
+  std::atomic<bool> is_pending;
+
+  static std::unordered_map<size_t, SocketBuffer*> socket_buffers;
+  // pollers watching a plain socket and, per poller, its sockets that may have
+  // buffered input or output the kernel can't report. Guarded by the map's lock.
+  static std::unordered_map<size_t, std::vector<const void*>> socket_pollers;
+  static std::unordered_map<const void*, std::unordered_set<size_t>> poller_pending;
+#ifdef _WIN32
+  static CRITICAL_SECTION buffer_cs;
+#else
+  static pthread_mutex_t buffer_mutex;
+#endif
+
+  SocketBuffer(size_t s, SSL_CTX* c, BIO* b, bool i) {
+    sock = s;
+    ctx = c;
+    bio = b;
+    is_secure = i;
+    in_buffer = new char[SOCKET_BUFFER_MAX];
+    out_buffer = new char[SOCKET_BUFFER_MAX];
+    in_pos = in_end = out_end = 0;
+    has_deadline = false;
+    refs = 1;
+    is_pending = false;
+#ifdef _WIN32
+    InitializeCriticalSection(&read_lock);
+    InitializeCriticalSection(&write_lock);
+#else
+    pthread_mutex_init(&read_lock, nullptr);
+    pthread_mutex_init(&write_lock, nullptr);
+#endif
+  }
+
+  ~SocketBuffer() {
+    delete[] in_buffer;
+    in_buffer = nullptr;
+
+    delete[] out_buffer;
+    out_buffer = nullptr;
+
+#ifdef _WIN32
+    DeleteCriticalSection(&read_lock);
+    DeleteCriticalSection(&write_lock);
+#else
+    pthread_mutex_destroy(&read_lock);
+    pthread_mutex_destroy(&write_lock);
+#endif
+  }
+
+  int Receive(char* buffer, int len);
+  bool WaitReadable();
+  int Send(const char* buffer, int len);
+  int Fill(bool is_waiting);
+  bool FlushOutput();
+  void MarkPending();
+  bool FlushPending();
+  char NextByte(int &status);
+  int NextBytes(char* buffer, int len);
+
+#ifdef _WIN32
+  static void Lock(CRITICAL_SECTION* lock);
+#else
+  static void Lock(pthread_mutex_t* lock);
+#endif
+
+  static SocketBuffer* GetBuffer(size_t key, size_t s, SSL_CTX* c, BIO* b, bool i);
+  static void ReleaseBuffer(size_t key);
+  static void Unreference(SocketBuffer* buffer);
+
+ public:
+  // keeps a buffer alive for the length of a call, even if the socket is closed meanwhile
+  class Reference {
+    SocketBuffer* buffer;
+
+  public:
+    Reference(SocketBuffer* b) {
+      buffer = b;
+    }
+
+    Reference(const Reference &) = delete;
+    Reference& operator=(const Reference &) = delete;
+
+    ~Reference() {
+      SocketBuffer::Unreference(buffer);
+    }
+
+    SocketBuffer* operator->() const {
+      return buffer;
+    }
+  };
+
+#ifdef _WIN32
+  static void Initialize() {
+    InitializeCriticalSection(&buffer_cs);
+  }
+#endif
+
+  static Reference GetSocketBuffer(size_t sock) {
+    return Reference(GetBuffer(sock, sock, nullptr, nullptr, false));
+  }
+
+  static Reference GetSecureBuffer(SSL_CTX* ctx, BIO* bio) {
+    return Reference(GetBuffer((size_t)bio, 0, ctx, bio, true));
+  }
+
+  // flushes pending output and frees the buffer, called before a socket is closed
+  static void ReleaseSocketBuffer(size_t sock) {
+    ReleaseBuffer(sock);
+  }
+
+  static void ReleaseSecureBuffer(BIO* bio) {
+    ReleaseBuffer((size_t)bio);
+  }
+
+  // reports a plain socket's buffered input and output to a poller
+  static void Watch(const void* poller, size_t sock);
+  static void Unwatch(const void* poller, size_t sock);
+
+  // sends a poller's pending output, returns its sockets with unread input
+  static void GetPending(const void* poller, std::vector<size_t> &socks);
+
+  // reads fail after 'timeout' milliseconds from now, -1 clears the deadline
+  void SetReadDeadline(long timeout);
+
+  char ReadByte(int &status);
+  int ReadBytes(char* buffer, int len);
+  int ReadFully(char* buffer, int len);
+  std::string ReadLine(size_t max);
+
+  bool WriteByte(char value);
+  int WriteBytes(const char* buffer, int len);
+  bool Flush();
+};
+
 /********************************
  * StackProgram class
  ********************************/
@@ -952,6 +1129,7 @@ class StackProgram {
 #ifdef _WIN32
     InitializeCriticalSection(&program_cs);
     InitializeCriticalSection(&prop_cs);
+    SocketBuffer::Initialize();
 #endif
   }
 
@@ -1632,6 +1810,7 @@ class TrapProcessor {
   // main trap functions
   static bool LoadClsInstId(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
   static bool HashStringId(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool CompareString(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
   static bool LoadNewObjInst(StackProgram* program, size_t* inst, size_t* &op_stack, long* &stack_pos, StackFrame* frame);
   static bool LoadClsByInst(StackProgram* program, size_t* inst, size_t* &op_stack, long* &stack_pos, StackFrame* frame);
   static bool ConvertBytesToUnicode(StackProgram* program, size_t* inst, size_t* &op_stack, long* &stack_pos, StackFrame* frame);
@@ -1688,6 +1867,7 @@ class TrapProcessor {
   static bool TimerStart(StackProgram* program, size_t* inst, size_t* &op_stack, long* &stack_pos, StackFrame* frame);
   static bool TimerEnd(StackProgram* program, size_t* inst, size_t* &op_stack, long* &stack_pos, StackFrame* frame);
   static bool TimerElapsed(StackProgram* program, size_t* inst, size_t* &op_stack, long* &stack_pos, StackFrame* frame);
+  static bool TimerTicks(StackProgram* program, size_t* inst, size_t* &op_stack, long* &stack_pos, StackFrame* frame);
   static bool GetPltfrm(StackProgram* program, size_t* inst, size_t* &op_stack, long* &stack_pos, StackFrame* frame);
   static bool GetVersion(StackProgram* program, size_t* inst, size_t* &op_stack, long* &stack_pos, StackFrame* frame);
   static bool GetSysProp(StackProgram* program, size_t* inst, size_t* &op_stack, long* &stack_pos, StackFrame* frame);
@@ -1715,6 +1895,62 @@ class TrapProcessor {
   static bool SockTcpSslListen(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
   static bool SockTcpSslAccept(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
   static bool SockTcpSslCloseSrv(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool SockTcpFlush(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool SockTcpSslFlush(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool SockTcpSetBlocking(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool SockTcpSetDeadline(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool SockPollCreate(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool SockPollAdd(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool SockPollRemove(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool SockPollWait(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool SockPollClose(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool ExecutorSubmit(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool ExecutorSize(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool ExecutorWait(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool ExecutorNotify(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool AtomicLoad(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool AtomicStore(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool AtomicAdd(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool AtomicSwap(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool AtomicCas(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool AtomicAryLoad(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool AtomicAryStore(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool AtomicAryAdd(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool AtomicArySwap(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool AtomicAryCas(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool ConditionInit(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool ConditionWait(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool ConditionSignal(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool ConditionBroadcast(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool SemaphoreInit(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool SemaphoreAcquire(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool SemaphoreTryAcquire(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool SemaphoreRelease(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool ReadWriteInit(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool ReadLock(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool ReadUnlock(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool WriteLock(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool WriteUnlock(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool ParallelSortInt(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool ParallelSortFloat(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool ParallelScanInt(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool ParallelScanFloat(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool MappedFileOpen(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool MappedFileClose(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool MappedFileInByte(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool MappedFileInByteAry(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool MappedFileFindByte(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool MappedFileInLine(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool MappedFileInString(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool JsonTapeIndex(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool BytesToString(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool CsvIndex(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool CsvInts(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool CsvFloats(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool XmlIndex(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool XmlDecode(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool StringUtf8Encode(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
+  static bool RegexExecute(StackProgram* program, size_t* inst, size_t*& op_stack, long*& stack_pos, StackFrame* frame);
   static bool SerlChar(StackProgram* program, size_t* inst, size_t* &op_stack, long* &stack_pos, StackFrame* frame);
   static bool SerlInt(StackProgram* program, size_t* inst, size_t* &op_stack, long* &stack_pos, StackFrame* frame);
   static bool SerlFloat(StackProgram* program, size_t* inst, size_t* &op_stack, long* &stack_pos, StackFrame* frame);
@@ -1936,6 +2172,12 @@ class TrapProcessor {
   // creates a string object instance
   //
   static inline size_t* CreateStringObject(const std::wstring &value_str, StackProgram* program, size_t* &op_stack, long* &stack_pos);
+  static inline size_t* CreateStringObject(const char* value, size_t size, StackProgram* program, size_t* &op_stack, long* &stack_pos);
+
+  //
+  // decodes UTF-8 bytes into a character array
+  //
+  static inline size_t DecodeCharArray(const char* bytes, size_t size, const size_t* array, size_t offset, bool skip_bom);
 
  public:
 
@@ -72,6 +72,18 @@ pthread_mutex_t StackInterpreter::cached_frames_mutex = PTHREAD_MUTEX_INITIALIZE
 pthread_mutex_t StackInterpreter::intpr_threads_mutex = PTHREAD_MUTEX_INITIALIZER;
 #endif
 
+#ifdef _PROFILE
+std::vector<std::unordered_map<uint64_t, size_t>*> StackInterpreter::profile_ngrams;
+thread_local std::unordered_map<uint64_t, size_t>* StackInterpreter::thread_ngrams = nullptr;
+thread_local uint64_t StackInterpreter::profile_window = 0;
+thread_local int StackInterpreter::profile_window_size = 0;
+#ifdef _WIN32
+CRITICAL_SECTION StackInterpreter::profile_cs;
+#else
+pthread_mutex_t StackInterpreter::profile_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+#endif
+
 /********************************
  * VM initialization
  ********************************/
@@ -82,6 +94,9 @@ void StackInterpreter::Initialize(StackProgram* p, size_t m)
 #ifdef _WIN32
   InitializeCriticalSection(&cached_frames_cs);
   InitializeCriticalSection(&intpr_threads_cs);
+#ifdef _PROFILE
+  InitializeCriticalSection(&profile_cs);
+#endif
 #endif
 
 #ifndef _SANITIZE
@@ -101,6 +116,7 @@ void StackInterpreter::Initialize(StackProgram* p, size_t m)
 #endif
 #endif
   MemoryManager::Initialize(program, m);
+  TaskExecutor::Initialize();
 
 #ifdef _MODULE
   TrapProcessor::Initialize(program);
@@ -123,6 +139,7 @@ void StackInterpreter::Execute(size_t* op_stack, long* stack_pos, long i, StackM
   // initial setup
   if(monitor) {
     (*call_stack_pos) = 0;
+    SetOperandStack(op_stack, stack_pos);
   }
   (*frame) = GetStackFrame(method, instance);
   
@@ -152,6 +169,10 @@ void StackInterpreter::Execute(size_t* op_stack, long* stack_pos, long i, StackM
 #ifdef _DEBUGGER
     debugger->ProcessInstruction(instr, ip, call_stack, (*call_stack_pos), (*frame));
 #endif
+
+#ifdef _PROFILE
+    ProfileInstruction(instr->GetType());
+#endif
     
     switch(instr->GetType()) {
     case STOR_LOCL_INT_VAR:
@@ -218,6 +239,14 @@ void StackInterpreter::Execute(size_t* op_stack, long* stack_pos, long i, StackM
     case LOAD_CLS_INST_INT_VAR:
       LoadClsInstIntVar(instr, op_stack, stack_pos);
       break;
+
+    case INC_LOCL_INT_VAR:
+      IncLoclIntVar(instr);
+      break;
+
+    case LOAD_LOCL_INT_VARS:
+      LoadLoclIntVars(instr, op_stack, stack_pos);
+      break;
       
     case LOAD_FUNC_VAR:
       ProcessLoadFunctionVar(instr, op_stack, stack_pos);
@@ -551,6 +580,10 @@ void StackInterpreter::Execute(size_t* op_stack, long* stack_pos, long i, StackM
       SwapInt(op_stack, stack_pos);
       break;
 
+    case CHK_OBJ_INST:
+      ChkObjInst(op_stack, stack_pos);
+      break;
+
     case POP_INT:
 #ifdef _DEBUG
       std::wcout << L"stack oper: PopInt; call_pos=" << (*call_stack_pos) << std::endl;
@@ -599,12 +632,13 @@ void StackInterpreter::Execute(size_t* op_stack, long* stack_pos, long i, StackM
 #ifdef _DEBUG
       std::wcout << L"stack oper: JMP; call_pos=" << (*call_stack_pos) << std::endl;
 #endif
-      if(instr->GetOperand2() < 0) {
+      if(instr->GetOperand2() < 0 || (INT64_VALUE)PopInt(op_stack, stack_pos) == instr->GetOperand2()) {
+        // loops are safepoints
+        if(instr->GetOperand() < ip) {
+          Safepoint();
+        }
         ip = instr->GetOperand();
       }
-      else if((INT64_VALUE)PopInt(op_stack, stack_pos) == instr->GetOperand2()) {
-        ip = instr->GetOperand();
-      }      
       break;
 
     case OBJ_TYPE_OF:
@@ -696,7 +730,7 @@ void StackInterpreter::Execute(size_t* op_stack, long* stack_pos, long i, StackM
       std::wcout << L"stack oper: THREAD_SLEEP; call_pos=" << (*call_stack_pos) << std::endl;
 #endif
       left = (INT64_VALUE)PopInt(op_stack, stack_pos);
-      std::this_thread::sleep_for(std::chrono::milliseconds(left));
+      ThreadScheduler::Sleep(left);
       break;
 
     case LOAD_CLS_MEM:
@@ -759,6 +793,133 @@ void StackInterpreter::Execute(size_t* op_stack, long* stack_pos, long i, StackM
 #endif
 }
 
+#ifdef _PROFILE
+/********************************
+ * Counts opcode sequences (n-grams)
+ * used to select superinstructions
+ ********************************/
+void StackInterpreter::ProfileInstruction(const InstructionType type)
+{
+  if(!thread_ngrams) {
+    thread_ngrams = new std::unordered_map<uint64_t, size_t>;
+#ifdef _WIN32
+    EnterCriticalSection(&profile_cs);
+#else
+    pthread_mutex_lock(&profile_mutex);
+#endif
+    profile_ngrams.push_back(thread_ngrams);
+#ifdef _WIN32
+    LeaveCriticalSection(&profile_cs);
+#else
+    pthread_mutex_unlock(&profile_mutex);
+#endif
+  }
+
+  // sequences never span a jump target
+  if(type == LBL) {
+    profile_window_size = 0;
+    return;
+  }
+
+  profile_window = (profile_window << 8) | (type & 0xff);
+  if(profile_window_size < PROFILE_NGRAM_MAX) {
+    profile_window_size++;
+  }
+
+  for(int i = 2; i <= profile_window_size; ++i) {
+    const uint64_t mask = (1ULL << (i * 8)) - 1;
+    (*thread_ngrams)[((uint64_t)i << 32) | (profile_window & mask)]++;
+  }
+
+  // ...or a transfer of control
+  switch(type) {
+  case JMP:
+  case RTRN:
+  case MTHD_CALL:
+  case DYN_MTHD_CALL:
+  case ASYNC_MTHD_CALL:
+    profile_window_size = 0;
+    break;
+
+  default:
+    break;
+  }
+}
+
+void StackInterpreter::DumpProfile()
+{
+  static const wchar_t* instr_names[] = {
+    L"LOAD_INT_LIT", L"LOAD_CHAR_LIT", L"LOAD_FLOAT_LIT", L"LOAD_INT_VAR", L"LOAD_LOCL_INT_VAR",
+    L"LOAD_CLS_INST_INT_VAR", L"LOAD_FLOAT_VAR", L"LOAD_FUNC_VAR", L"LOAD_CLS_MEM", L"LOAD_INST_MEM",
+    L"STOR_INT_VAR", L"STOR_LOCL_INT_VAR", L"STOR_CLS_INST_INT_VAR", L"STOR_FLOAT_VAR", L"STOR_FUNC_VAR",
+    L"COPY_INT_VAR", L"COPY_LOCL_INT_VAR", L"COPY_CLS_INST_INT_VAR", L"COPY_FLOAT_VAR", L"COPY_FUNC_VAR",
+    L"LOAD_BYTE_ARY_ELM", L"LOAD_CHAR_ARY_ELM", L"LOAD_INT_ARY_ELM", L"LOAD_FLOAT_ARY_ELM",
+    L"STOR_BYTE_ARY_ELM", L"STOR_CHAR_ARY_ELM", L"STOR_INT_ARY_ELM", L"STOR_FLOAT_ARY_ELM", L"LOAD_ARY_SIZE",
+    L"NAN_INT", L"INF_INT", L"NEG_INF_INT", L"NAN_FLOAT", L"INF_FLOAT", L"NEG_INF_FLOAT", L"EQL_INT",
+    L"NEQL_INT", L"LES_INT", L"GTR_INT", L"LES_EQL_INT", L"GTR_EQL_INT", L"EQL_FLOAT", L"NEQL_FLOAT",
+    L"LES_FLOAT", L"GTR_FLOAT", L"LES_EQL_FLOAT", L"GTR_EQL_FLOAT", L"AND_INT", L"OR_INT", L"ADD_INT",
+    L"SUB_INT", L"MUL_INT", L"DIV_INT", L"MOD_INT", L"BIT_AND_INT", L"BIT_OR_INT", L"BIT_XOR_INT",
+    L"BIT_NOT_INT", L"SHL_INT", L"SHR_INT", L"ADD_FLOAT", L"SUB_FLOAT", L"MUL_FLOAT", L"DIV_FLOAT",
+    L"FLOR_FLOAT", L"CEIL_FLOAT", L"TRUNC_FLOAT", L"SIN_FLOAT", L"COS_FLOAT", L"TAN_FLOAT", L"ASIN_FLOAT",
+    L"ACOS_FLOAT", L"ATAN_FLOAT", L"LOG2_FLOAT", L"CBRT_FLOAT", L"COSH_FLOAT", L"SINH_FLOAT", L"TANH_FLOAT",
+    L"ATAN2_FLOAT", L"ACOSH_FLOAT", L"ASINH_FLOAT", L"ATANH_FLOAT", L"MOD_FLOAT", L"LOG_FLOAT",
+    L"ROUND_FLOAT", L"EXP_FLOAT", L"LOG10_FLOAT", L"POW_FLOAT", L"SQRT_FLOAT", L"GAMMA_FLOAT", L"RAND_FLOAT",
+    L"I2F", L"F2I", L"S2I", L"S2F", L"I2S", L"F2S", L"MTHD_CALL", L"DYN_MTHD_CALL", L"JMP", L"LBL", L"RTRN",
+    L"NEW_BYTE_ARY", L"NEW_CHAR_ARY", L"NEW_INT_ARY", L"NEW_FLOAT_ARY", L"NEW_OBJ_INST", L"NEW_FUNC_INST",
+    L"CPY_BYTE_ARY", L"CPY_CHAR_ARY", L"CPY_INT_ARY", L"CPY_FLOAT_ARY", L"ZERO_BYTE_ARY", L"ZERO_CHAR_ARY",
+    L"ZERO_INT_ARY", L"ZERO_FLOAT_ARY", L"OBJ_INST_CAST", L"OBJ_TYPE_OF", L"TRAP", L"TRAP_RTRN",
+    L"SET_SIGNAL", L"RAISE_SIGNAL", L"EXT_LIB_LOAD", L"EXT_LIB_UNLOAD", L"EXT_LIB_FUNC_CALL", L"SWAP_INT",
+    L"POP_INT", L"POP_FLOAT", L"ASYNC_MTHD_CALL", L"THREAD_JOIN", L"THREAD_SLEEP", L"THREAD_MUTEX",
+    L"CRITICAL_START", L"CRITICAL_END", L"LIB_OBJ_TYPE_OF", L"LIB_NEW_OBJ_INST", L"LIB_MTHD_CALL",
+    L"LIB_OBJ_INST_CAST", L"LIB_FUNC_DEF", L"END_STMTS", L"INC_LOCL_INT_VAR", L"LOAD_LOCL_INT_VARS",
+    L"CHK_OBJ_INST"
+  };
+  const size_t instr_names_size = sizeof(instr_names) / sizeof(instr_names[0]);
+  static_assert(sizeof(instr_names) / sizeof(instr_names[0]) == CHK_OBJ_INST + 1, "opcode names out of sync with 'InstructionType'");
+
+  // merge thread counts
+  std::unordered_map<uint64_t, size_t> totals;
+#ifdef _WIN32
+  EnterCriticalSection(&profile_cs);
+#else
+  pthread_mutex_lock(&profile_mutex);
+#endif
+  for(size_t i = 0; i < profile_ngrams.size(); ++i) {
+    std::unordered_map<uint64_t, size_t>::iterator iter;
+    for(iter = profile_ngrams[i]->begin(); iter != profile_ngrams[i]->end(); ++iter) {
+      totals[iter->first] += iter->second;
+    }
+  }
+#ifdef _WIN32
+  LeaveCriticalSection(&profile_cs);
+#else
+  pthread_mutex_unlock(&profile_mutex);
+#endif
+
+  for(int i = 2; i <= PROFILE_NGRAM_MAX; ++i) {
+    std::vector<std::pair<size_t, uint64_t> > ngrams;
+    std::unordered_map<uint64_t, size_t>::iterator iter;
+    for(iter = totals.begin(); iter != totals.end(); ++iter) {
+      if((int)(iter->first >> 32) == i) {
+        ngrams.push_back(std::pair<size_t, uint64_t>(iter->second, iter->first));
+      }
+    }
+    std::sort(ngrams.begin(), ngrams.end(), std::greater<std::pair<size_t, uint64_t> >());
+
+    std::wcout << L"---------------------------" << std::endl;
+    std::wcout << L"Opcode " << i << L"-grams:" << std::endl;
+    for(size_t j = 0; j < ngrams.size() && j < PROFILE_TOP_COUNT; ++j) {
+      std::wcout << L"  " << ngrams[j].first << L":";
+      for(int k = i - 1; k > -1; --k) {
+        const size_t type = (ngrams[j].second >> (k * 8)) & 0xff;
+        std::wcout << L" " << (type < instr_names_size ? instr_names[type] : L"?");
+      }
+      std::wcout << std::endl;
+    }
+  }
+}
+#endif
+
 void StackInterpreter::StorLoclIntVar(StackInstr* instr, size_t* &op_stack, long* &stack_pos)
 {
 #ifdef _DEBUG
@@ -1109,6 +1270,25 @@ void StackInterpreter::LoadLoclIntVar(StackInstr* instr, size_t* &op_stack, long
   PushInt(mem[instr->GetOperand() + 1], op_stack, stack_pos);
 }
 
+void StackInterpreter::IncLoclIntVar(StackInstr* instr)
+{
+#ifdef _DEBUG
+  std::wcout << L"stack oper: INC_LOCL_INT_VAR; index=" << instr->GetOperand() << L"; value=" << instr->GetOperand2() << std::endl;
+#endif
+  size_t* mem = (*frame)->mem;
+  mem[instr->GetOperand() + 1] += instr->GetOperand2();
+}
+
+void StackInterpreter::LoadLoclIntVars(StackInstr* instr, size_t* &op_stack, long* &stack_pos)
+{
+#ifdef _DEBUG
+  std::wcout << L"stack oper: LOAD_LOCL_INT_VARS; index=" << instr->GetOperand() << L"; index2=" << instr->GetOperand2() << std::endl;
+#endif
+  size_t* mem = (*frame)->mem;
+  PushInt(mem[instr->GetOperand() + 1], op_stack, stack_pos);
+  PushInt(mem[instr->GetOperand2() + 1], op_stack, stack_pos);
+}
+
 void StackInterpreter::LoadClsInstIntVar(StackInstr* instr, size_t* &op_stack, long* &stack_pos)
 {
 #ifdef _DEBUG
@@ -1462,6 +1642,23 @@ void StackInterpreter::LoadArySize(size_t* &op_stack, long* &stack_pos)
   PushInt(array[2], op_stack, stack_pos);
 }
 
+void StackInterpreter::ChkObjInst(size_t* &op_stack, long* &stack_pos)
+{
+#ifdef _DEBUG
+  std::wcout << L"stack oper: CHK_OBJ_INST; call_pos=" << (*call_stack_pos) << std::endl;
+#endif
+  // devirtualized call, fails the same way as the virtual call
+  if(!TopInt(op_stack, stack_pos)) {
+    std::wcerr << L">>> Unable to resolve virtual method call <<<" << std::endl;
+#ifdef _NO_HALT
+    halt = true;
+    return;
+#else
+    exit(1);
+#endif
+  }
+}
+
 void StackInterpreter::CpyByteAry(size_t* &op_stack, long* &stack_pos)
 {
 #ifdef _DEBUG
@@ -1754,20 +1951,7 @@ void StackInterpreter::ThreadJoin(size_t* &op_stack, long* &stack_pos)
 #endif
   }
 
-#ifdef _WIN32
-  HANDLE vm_thread = (HANDLE)instance[0];
-  if(WaitForSingleObject(vm_thread, INFINITE) != WAIT_OBJECT_0) {
-    std::wcerr << L">>> Unable to join thread! <<<" << std::endl;
-#ifdef _NO_HALT
-    return;
-#else
-    exit(1);
-#endif
-  }
-#else
-  void* status;
-  pthread_t vm_thread = (pthread_t)instance[0];
-  if(pthread_join(vm_thread, &status)) {
+  if(!ThreadScheduler::Join(instance)) {
     std::wcerr << L">>> Unable to join thread! <<<" << std::endl;
 #ifdef _NO_HALT
     return;
@@ -1775,7 +1959,6 @@ void StackInterpreter::ThreadJoin(size_t* &op_stack, long* &stack_pos)
     exit(1);
 #endif
   }
-#endif
 }
 
 void StackInterpreter::ThreadMutex(size_t* &op_stack, long* &stack_pos)
@@ -1794,11 +1977,7 @@ void StackInterpreter::ThreadMutex(size_t* &op_stack, long* &stack_pos)
     exit(1);
 #endif
   }
-#ifdef _WIN32
-  InitializeCriticalSection((CRITICAL_SECTION*)&instance[1]);
-#else
-  pthread_mutex_init((pthread_mutex_t*)&instance[1], nullptr);
-#endif
+  ThreadScheduler::InitializeLock(instance);
 }
 
 void StackInterpreter::CriticalStart(size_t* &op_stack, long* &stack_pos)
@@ -1817,11 +1996,7 @@ void StackInterpreter::CriticalStart(size_t* &op_stack, long* &stack_pos)
     exit(1);
 #endif        
   }
-#ifdef _WIN32
-  EnterCriticalSection((CRITICAL_SECTION*)&instance[1]);
-#else
-  pthread_mutex_lock((pthread_mutex_t*)&instance[1]);
-#endif
+  ThreadScheduler::Lock(instance);
 }
 
 void StackInterpreter::CriticalEnd(size_t* &op_stack, long* &stack_pos)
@@ -1840,11 +2015,17 @@ void StackInterpreter::CriticalEnd(size_t* &op_stack, long* &stack_pos)
     exit(1);
 #endif
   }
-#ifdef _WIN32
-  LeaveCriticalSection((CRITICAL_SECTION*)&instance[1]);
+
+  if(!ThreadScheduler::Unlock(instance)) {
+    std::wcerr << L">>> Releasing a mutex not held by the current thread <<<" << std::endl;
+    StackErrorUnwind();
+#ifdef _NO_HALT
+    halt = true;
+    return;
 #else
-  pthread_mutex_unlock((pthread_mutex_t*)&instance[1]);
+    exit(1);
 #endif
+  }
 }
 
 /********************************
@@ -2152,11 +2333,35 @@ void StackInterpreter::ProcessReturn(StackInstr** &instrs, long &ip)
 void StackInterpreter::ProcessAsyncMethodCall(StackMethod* called, size_t* param)
 {
   size_t* instance = (size_t*)(*frame)->mem[0];
+  if(!instance) {
+    std::wcerr << L">>> Internal error: Unable to create runtime thread! <<<" << std::endl;
+    exit(-1);
+  }
+
   ThreadHolder* holder = new ThreadHolder;
   holder->called = called;
   holder->param = param;
   holder->self = instance;
 
+  // the new thread's stack roots 'self' and 'param' until it runs
+  holder->op_stack = new size_t[OP_STACK_SIZE];
+  holder->stack_pos = new long;
+  (*holder->stack_pos) = 0;
+  holder->op_stack[(*holder->stack_pos)++] = (size_t)instance;
+  holder->op_stack[(*holder->stack_pos)++] = (size_t)param;
+
+  holder->intpr = new Runtime::StackInterpreter;
+  holder->intpr->SetOperandStack(holder->op_stack, holder->stack_pos);
+  AddThread(holder->intpr);
+
+  if(ThreadScheduler::IsGreen()) {
+    instance[0] = ThreadScheduler::Spawn(holder);
+#ifdef _DEBUG
+    std::wcout << L"*** New Green Thread ID: " << instance[0] << L": " << instance << L" ***" << std::endl;
+#endif
+    return;
+  }
+
 #ifdef _WIN32
   HANDLE vm_thread = (HANDLE)_beginthreadex(nullptr, 0, AsyncMethodCall, holder, 0, nullptr);
   if(!vm_thread) {
@@ -2177,11 +2382,6 @@ void StackInterpreter::ProcessAsyncMethodCall(StackMethod* called, size_t* param
 #endif  
   
   // assign thread ID
-  if(!instance) {
-    std::wcerr << L">>> Internal error: Unable to create runtime thread! <<<" << std::endl;
-    exit(-1);
-  }
-
   instance[0] = (size_t)vm_thread;
 #ifdef _DEBUG
   std::wcout << L"*** New Thread ID: " << vm_thread  << L": " << instance << L" ***" << std::endl;
@@ -2195,14 +2395,7 @@ void StackInterpreter::ProcessAsyncMethodCall(StackMethod* called, size_t* param
 unsigned int WINAPI StackInterpreter::AsyncMethodCall(LPVOID arg)
 {
   ThreadHolder* holder = (ThreadHolder*)arg;
-
-  // execute
-  size_t* thread_op_stack = new size_t[OP_STACK_SIZE];
-  long* thread_stack_pos = new long;
-  (*thread_stack_pos) = 0;
-  
-  // set parameter
-  thread_op_stack[(*thread_stack_pos)++] = (size_t)holder->param;
+  MemoryManager::AddMutator();
 
 #ifdef _DEBUG
   HANDLE vm_thread;
@@ -2210,27 +2403,27 @@ unsigned int WINAPI StackInterpreter::AsyncMethodCall(LPVOID arg)
   std::wcout << L"# Starting thread=" << vm_thread << L" #" << std::endl;
 #endif  
 
-  Runtime::StackInterpreter* intpr = new Runtime::StackInterpreter;
-  AddThread(intpr);
-  intpr->Execute(thread_op_stack, thread_stack_pos, 0, holder->called, holder->self, false);
+  holder->intpr->Execute(holder->op_stack, holder->stack_pos, 0, holder->called, holder->self, false);
   
 #ifdef _DEBUG
-  std::wcout << L"# final std::stack: pos=" << (*thread_stack_pos) << L", thread=" << vm_thread << L" #" << std::endl;
+  std::wcout << L"# final std::stack: pos=" << (*holder->stack_pos) << L", thread=" << vm_thread << L" #" << std::endl;
 #endif
 
-  // clean up
-  delete[] thread_op_stack;
-  thread_op_stack = nullptr;
+  // clean up, unregister roots before releasing the stack
+  RemoveThread(holder->intpr);
+  delete holder->intpr;
+  holder->intpr = nullptr;
 
-  delete thread_stack_pos;
-  thread_stack_pos = nullptr;
-  
-  RemoveThread(intpr);
-  delete intpr;
-  intpr = nullptr;
+  delete[] holder->op_stack;
+  holder->op_stack = nullptr;
+
+  delete holder->stack_pos;
+  holder->stack_pos = nullptr;
 
   delete holder;
   holder = nullptr;
+
+  MemoryManager::RemoveMutator();
   
   return 0;
 }
@@ -2241,40 +2434,33 @@ unsigned int WINAPI StackInterpreter::AsyncMethodCall(LPVOID arg)
 void* StackInterpreter::AsyncMethodCall(void* arg)
 {
   ThreadHolder* holder = (ThreadHolder*)arg;
-
-  // execute
-  size_t* thread_op_stack = new size_t[OP_STACK_SIZE];
-  long* thread_stack_pos = new long;
-  (*thread_stack_pos) = 0;
-
-  // set parameter
-  thread_op_stack[(*thread_stack_pos)++] = (size_t)holder->param;
+  MemoryManager::AddMutator();
 
 #ifdef _DEBUG
   std::wcout << L"# Starting thread=" << pthread_self() << L" #" << std::endl;
 #endif  
 
-  Runtime::StackInterpreter* intpr = new Runtime::StackInterpreter;
-  AddThread(intpr);
-  intpr->Execute(thread_op_stack, thread_stack_pos, 0, holder->called, holder->self, false);
+  holder->intpr->Execute(holder->op_stack, holder->stack_pos, 0, holder->called, holder->self, false);
 
 #ifdef _DEBUG
-  std::wcout << L"# final std::stack: pos=" << (*thread_stack_pos) << L", thread=" << pthread_self() << L" #" << std::endl;
+  std::wcout << L"# final std::stack: pos=" << (*holder->stack_pos) << L", thread=" << pthread_self() << L" #" << std::endl;
 #endif
   
-  // clean up
-  delete[] thread_op_stack;
-  thread_op_stack = nullptr;
+  // clean up, unregister roots before releasing the stack
+  RemoveThread(holder->intpr);
+  delete holder->intpr;
+  holder->intpr = nullptr;
 
-  delete thread_stack_pos;
-  thread_stack_pos = nullptr;
+  delete[] holder->op_stack;
+  holder->op_stack = nullptr;
 
-  RemoveThread(intpr);
-  delete intpr;
-  intpr = nullptr;
+  delete holder->stack_pos;
+  holder->stack_pos = nullptr;
   
   delete holder;
   holder = nullptr;
+
+  MemoryManager::RemoveMutator();
   
   return nullptr;
 }
@@ -3179,3 +3365,1355 @@ void Runtime::StackInterpreter::StackErrorUnwind(StackMethod* method)
   }
   std::wcerr << L"  ..." << std::endl;
 }
+
+/********************************
+ * Green thread scheduler
+ ********************************/
+namespace Runtime {
+  enum GreenState {
+    GREEN_RUNNABLE = 0,
+    GREEN_SLEEPING,
+    GREEN_JOINING,
+    GREEN_WAITING,
+    GREEN_DONE
+  };
+
+  // VM thread multiplexed over carriers, its interpreter, operand and call
+  // stacks live in 'holder' and its native stack in 'fiber'
+  struct GreenThread {
+    size_t id;
+    ThreadHolder* holder;
+    Fiber fiber;
+    CarrierThread* carrier;
+    GreenState state;
+    size_t join_id;
+    std::chrono::steady_clock::time_point wake_time;
+    std::vector<GreenThread*> joiners;
+    WaitQueue* wait_queue;
+    GreenThread* next_waiter;
+  };
+
+  // threads waiting on a condition, semaphore or reader-writer lock, laid
+  // over the object's fields. Green threads are linked from 'head' and
+  // parked, other threads block on 'cond'.
+  struct WaitQueue {
+#ifdef _WIN32
+    CRITICAL_SECTION lock;
+    CONDITION_VARIABLE cond;
+#else
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+#endif
+    GreenThread* head;
+    GreenThread* tail;
+  };
+  static_assert(sizeof(WaitQueue) <= WAIT_QUEUE_SIZE * sizeof(size_t), "wait queue must fit its object fields");
+
+  // OS thread that runs green threads from its queue
+  struct CarrierThread {
+    Fiber fiber;
+    GreenThread* current;
+    std::deque<GreenThread*> queue;
+    size_t ticks;
+#ifdef _WIN32
+    CRITICAL_SECTION queue_lock;
+#else
+    pthread_mutex_t queue_lock;
+#endif
+  };
+}
+
+#ifdef _WIN32
+#define COND_WAIT(c, m) SleepConditionVariableCS(c, m, INFINITE)
+#define COND_SIGNAL(c) WakeConditionVariable(c)
+#define COND_BROADCAST(c) WakeAllConditionVariable(c)
+#define MUTEX_TRYLOCK(m) TryEnterCriticalSection(m)
+#else
+#define COND_WAIT(c, m) pthread_cond_wait(c, m)
+#define COND_SIGNAL(c) pthread_cond_signal(c)
+#define COND_BROADCAST(c) pthread_cond_broadcast(c)
+#define MUTEX_TRYLOCK(m) !pthread_mutex_trylock(m)
+#endif
+
+// threads are pulled from the shared queues at least this often
+#define SHARED_QUEUE_TICKS 61
+
+long ThreadScheduler::carrier_target = 0;
+CarrierThread** ThreadScheduler::carriers[CARRIER_SEGMENTS_MAX];
+std::atomic<long> ThreadScheduler::carrier_count(0);
+std::atomic<long> ThreadScheduler::running_count(0);
+std::atomic<long> ThreadScheduler::idle_count(0);
+std::atomic<long> ThreadScheduler::runnable_count(0);
+std::atomic<int64_t> ThreadScheduler::next_wake(INT64_MAX);
+size_t ThreadScheduler::next_id = 0;
+std::deque<GreenThread*> ThreadScheduler::global_queue;
+std::unordered_map<size_t, GreenThread*> ThreadScheduler::green_threads;
+std::multimap<std::chrono::steady_clock::time_point, GreenThread*> ThreadScheduler::sleepers;
+std::vector<GreenThread*> ThreadScheduler::thread_cache;
+thread_local CarrierThread* ThreadScheduler::carrier = nullptr;
+thread_local long ThreadScheduler::blocking_depth = 0;
+WaitQueue ThreadScheduler::done_queue;
+
+#ifdef _WIN32
+CRITICAL_SECTION ThreadScheduler::scheduler_lock;
+CONDITION_VARIABLE ThreadScheduler::carrier_cond;
+CONDITION_VARIABLE ThreadScheduler::join_cond;
+#else
+pthread_mutex_t ThreadScheduler::scheduler_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t ThreadScheduler::carrier_cond = PTHREAD_COND_INITIALIZER;
+pthread_cond_t ThreadScheduler::join_cond = PTHREAD_COND_INITIALIZER;
+#endif
+
+void ThreadScheduler::Initialize(long carriers)
+{
+#ifdef _WIN32
+  InitializeCriticalSection(&scheduler_lock);
+  InitializeConditionVariable(&carrier_cond);
+  InitializeConditionVariable(&join_cond);
+#endif
+  InitializeWaitQueue((size_t*)&done_queue);
+
+  // default to a carrier per core
+  if(carriers < 0) {
+    carriers = (long)std::thread::hardware_concurrency();
+    if(carriers < 1) {
+      carriers = 1;
+    }
+  }
+  carrier_target = carriers < CARRIER_THREADS_MAX ? carriers : CARRIER_THREADS_MAX;
+}
+
+size_t ThreadScheduler::Spawn(ThreadHolder* holder)
+{
+  GreenThread* thread;
+  MUTEX_LOCK(&scheduler_lock);
+  if(thread_cache.empty()) {
+    thread = new GreenThread;
+  }
+  else {
+    thread = thread_cache.back();
+    thread_cache.pop_back();
+  }
+  const size_t id = ++next_id;
+  green_threads[id] = thread;
+  MUTEX_UNLOCK(&scheduler_lock);
+
+  thread->id = id;
+  thread->holder = holder;
+  thread->carrier = nullptr;
+  thread->state = GREEN_RUNNABLE;
+  thread->join_id = 0;
+  if(!thread->fiber.Create(GREEN_STACK_SIZE, FiberMain, thread)) {
+    std::wcerr << L">>> Internal error: Unable to create runtime thread! <<<" << std::endl;
+    exit(-1);
+  }
+
+  Enqueue(thread);
+
+  return id;
+}
+
+bool ThreadScheduler::Join(size_t* instance)
+{
+  if(IsGreen()) {
+    const size_t id = instance[0];
+
+    // green threads park until the thread is done, see 'Finish'
+    CarrierThread* current = carrier;
+    if(current && current->current) {
+      GreenThread* thread = current->current;
+      thread->join_id = id;
+      thread->state = GREEN_JOINING;
+      Park(thread);
+    }
+    else {
+      BlockingStart();
+      MUTEX_LOCK(&scheduler_lock);
+      while(green_threads.find(id) != green_threads.end()) {
+        COND_WAIT(&join_cond, &scheduler_lock);
+      }
+      MUTEX_UNLOCK(&scheduler_lock);
+      BlockingEnd();
+    }
+
+    return true;
+  }
+
+  BlockingStart();
+#ifdef _WIN32
+  const bool is_joined = WaitForSingleObject((HANDLE)instance[0], INFINITE) == WAIT_OBJECT_0;
+#else
+  void* status;
+  const bool is_joined = !pthread_join((pthread_t)instance[0], &status);
+#endif
+  BlockingEnd();
+
+  return is_joined;
+}
+
+void ThreadScheduler::Sleep(INT64_VALUE msec)
+{
+  CarrierThread* current = carrier;
+  if(current && current->current) {
+    GreenThread* thread = current->current;
+    if(msec > 0) {
+      thread->wake_time = std::chrono::steady_clock::now() + std::chrono::milliseconds(msec);
+      thread->state = GREEN_SLEEPING;
+    }
+    else {
+      thread->state = GREEN_RUNNABLE;
+    }
+    Park(thread);
+  }
+  else {
+    BlockingStart();
+    std::this_thread::sleep_for(std::chrono::milliseconds(msec));
+    BlockingEnd();
+  }
+}
+
+void ThreadScheduler::Reschedule()
+{
+  CarrierThread* current = carrier;
+  if(current && current->current) {
+    GreenThread* thread = current->current;
+    thread->state = GREEN_RUNNABLE;
+    Park(thread);
+  }
+}
+
+size_t ThreadScheduler::LockOwner()
+{
+  CarrierThread* current = carrier;
+  if(current && current->current) {
+    return current->current->id;
+  }
+
+  // native threads are told apart by address, green thread ids are small
+  static thread_local char native_owner;
+  return (size_t)&native_owner;
+}
+
+//
+// mutexes keep the owner's id in 'instance[1]' and the recursion depth in
+// 'instance[2]', green threads move between carriers and OS mutexes are owned
+// by threads. OS mutexes are laid over the fields from 'instance[4]', in green
+// mode those fields hold a 'WaitQueue' that contenders park on and
+// 'instance[3]' counts them. Green mutexes are reentrant and only released by
+// their owner. OS mutexes keep the platform's behavior, POSIX mutexes aren't
+// reentrant and critical sections are, the owner is only recorded for
+// condition waits.
+//
+void ThreadScheduler::InitializeLock(size_t* instance)
+{
+  instance[1] = instance[2] = instance[3] = 0;
+  if(IsGreen()) {
+    InitializeWaitQueue(instance + 4);
+  }
+  else {
+#ifdef _WIN32
+    InitializeCriticalSection((CRITICAL_SECTION*)&instance[4]);
+#else
+    pthread_mutex_init((pthread_mutex_t*)&instance[4], nullptr);
+#endif
+  }
+}
+
+void ThreadScheduler::Lock(size_t* instance)
+{
+  std::atomic<size_t>* owner = reinterpret_cast<std::atomic<size_t>*>(&instance[1]);
+  const size_t self = LockOwner();
+  if(IsGreen()) {
+    if(owner->load(std::memory_order_relaxed) == self) {
+      instance[2]++;
+      return;
+    }
+
+    size_t expected = 0;
+    if(!owner->compare_exchange_strong(expected, self)) {
+      // contended, park until the holder lets go. Waiters count themselves
+      // before trying again, so either they take the mutex or are notified.
+      std::atomic<size_t>* waiting = reinterpret_cast<std::atomic<size_t>*>(&instance[3]);
+      WaitQueue* queue = (WaitQueue*)(instance + 4);
+      MUTEX_LOCK(&queue->lock);
+      waiting->fetch_add(1);
+      expected = 0;
+      while(!owner->compare_exchange_strong(expected, self)) {
+        expected = 0;
+        Wait(queue);
+      }
+      waiting->fetch_sub(1);
+      MUTEX_UNLOCK(&queue->lock);
+    }
+    instance[2] = 1;
+  }
+  else {
+#ifdef _WIN32
+    CRITICAL_SECTION* mutex = (CRITICAL_SECTION*)&instance[4];
+    if(!TryEnterCriticalSection(mutex)) {
+      BlockingStart();
+      EnterCriticalSection(mutex);
+      BlockingEnd();
+    }
+#else
+    pthread_mutex_t* mutex = (pthread_mutex_t*)&instance[4];
+    if(pthread_mutex_trylock(mutex)) {
+      BlockingStart();
+      pthread_mutex_lock(mutex);
+      BlockingEnd();
+    }
+#endif
+    // only the holder writes these, the owner is already set when re-entering a critical section
+    if(owner->load(std::memory_order_relaxed) == self) {
+      instance[2]++;
+    }
+    else {
+      owner->store(self, std::memory_order_relaxed);
+      instance[2] = 1;
+    }
+  }
+}
+
+bool ThreadScheduler::Unlock(size_t* instance)
+{
+  std::atomic<size_t>* owner = reinterpret_cast<std::atomic<size_t>*>(&instance[1]);
+  const bool is_owner = owner->load(std::memory_order_relaxed) == LockOwner();
+  if(IsGreen()) {
+    if(!is_owner) {
+      return false;
+    }
+
+    if(--instance[2] > 0) {
+      return true;
+    }
+
+    owner->store(0);
+    if(reinterpret_cast<std::atomic<size_t>*>(&instance[3])->load() > 0) {
+      WaitQueue* queue = (WaitQueue*)(instance + 4);
+      MUTEX_LOCK(&queue->lock);
+      Notify(queue, false);
+      MUTEX_UNLOCK(&queue->lock);
+    }
+  }
+  else {
+    if(is_owner && --instance[2] == 0) {
+      owner->store(0, std::memory_order_relaxed);
+    }
+#ifdef _WIN32
+    LeaveCriticalSection((CRITICAL_SECTION*)&instance[4]);
+#else
+    pthread_mutex_unlock((pthread_mutex_t*)&instance[4]);
+#endif
+  }
+
+  return true;
+}
+
+//
+// condition variables, semaphores and reader-writer locks hold a 'WaitQueue'
+// in their fields. Counters are guarded by the queue's lock: semaphores keep
+// their permits in 'instance[0]', reader-writer locks keep the reader count,
+// writer flag and waiting writers in 'instance[0..2]'.
+//
+void ThreadScheduler::InitializeWaitQueue(size_t* instance)
+{
+  WaitQueue* queue = (WaitQueue*)instance;
+#ifdef _WIN32
+  InitializeCriticalSection(&queue->lock);
+  InitializeConditionVariable(&queue->cond);
+#else
+  pthread_mutex_init(&queue->lock, nullptr);
+  pthread_cond_init(&queue->cond, nullptr);
+#endif
+  queue->head = queue->tail = nullptr;
+}
+
+// note: called and returns with the queue's lock held, callers recheck their condition
+void ThreadScheduler::Wait(WaitQueue* queue)
+{
+  CarrierThread* current = carrier;
+  if(current && current->current) {
+    // the carrier links the thread and releases the lock once it's off its stack
+    GreenThread* thread = current->current;
+    thread->wait_queue = queue;
+    thread->state = GREEN_WAITING;
+    Park(thread);
+  }
+  else {
+    BlockingStart();
+    COND_WAIT(&queue->cond, &queue->lock);
+    // don't hold the lock while waiting out a collection
+    MUTEX_UNLOCK(&queue->lock);
+    BlockingEnd();
+  }
+  MUTEX_LOCK(&queue->lock);
+}
+
+// note: called with the queue's lock held
+void ThreadScheduler::Notify(WaitQueue* queue, bool is_all)
+{
+  GreenThread* waiter = queue->head;
+  if(waiter) {
+    if(is_all) {
+      queue->head = queue->tail = nullptr;
+    }
+    else {
+      queue->head = waiter->next_waiter;
+      if(!queue->head) {
+        queue->tail = nullptr;
+      }
+      waiter->next_waiter = nullptr;
+    }
+
+    while(waiter) {
+      GreenThread* next = waiter->next_waiter;
+      Enqueue(waiter);
+      waiter = next;
+    }
+
+    if(!is_all) {
+      return;
+    }
+  }
+
+  if(is_all) {
+    COND_BROADCAST(&queue->cond);
+  }
+  else {
+    COND_SIGNAL(&queue->cond);
+  }
+}
+
+// parks the current green thread until 'done' is set, false if called from an OS thread
+bool ThreadScheduler::WaitDone(std::atomic<size_t>* done)
+{
+  CarrierThread* current = carrier;
+  if(!current || !current->current) {
+    return false;
+  }
+
+  MUTEX_LOCK(&done_queue.lock);
+  while(!done->load(std::memory_order_acquire)) {
+    Wait(&done_queue);
+  }
+  MUTEX_UNLOCK(&done_queue.lock);
+
+  return true;
+}
+
+void ThreadScheduler::NotifyDone()
+{
+  MUTEX_LOCK(&done_queue.lock);
+  Notify(&done_queue, true);
+  MUTEX_UNLOCK(&done_queue.lock);
+}
+
+bool ThreadScheduler::ConditionWait(size_t* instance, size_t* mutex)
+{
+  // green and OS mutexes both track their owner
+  if(reinterpret_cast<std::atomic<size_t>*>(&mutex[1])->load(std::memory_order_relaxed) != LockOwner()) {
+    return false;
+  }
+
+  // release every level of a reentrant mutex and restore them once woken
+  const size_t depth = mutex[2];
+
+  // queued before the mutex is released, so a signal sent under the mutex isn't lost
+  WaitQueue* queue = (WaitQueue*)instance;
+  MUTEX_LOCK(&queue->lock);
+  for(size_t i = 0; i < depth; ++i) {
+    Unlock(mutex);
+  }
+  Wait(queue);
+  MUTEX_UNLOCK(&queue->lock);
+
+  for(size_t i = 0; i < depth; ++i) {
+    Lock(mutex);
+  }
+
+  return true;
+}
+
+void ThreadScheduler::ConditionNotify(size_t* instance, bool is_all)
+{
+  WaitQueue* queue = (WaitQueue*)instance;
+  MUTEX_LOCK(&queue->lock);
+  Notify(queue, is_all);
+  MUTEX_UNLOCK(&queue->lock);
+}
+
+void ThreadScheduler::SemaphoreAcquire(size_t* instance, INT64_VALUE permits)
+{
+  WaitQueue* queue = (WaitQueue*)(instance + 1);
+  MUTEX_LOCK(&queue->lock);
+  while((INT64_VALUE)instance[0] < permits) {
+    Wait(queue);
+  }
+  instance[0] -= permits;
+  MUTEX_UNLOCK(&queue->lock);
+}
+
+bool ThreadScheduler::SemaphoreTryAcquire(size_t* instance, INT64_VALUE permits)
+{
+  WaitQueue* queue = (WaitQueue*)(instance + 1);
+  MUTEX_LOCK(&queue->lock);
+  const bool is_acquired = (INT64_VALUE)instance[0] >= permits;
+  if(is_acquired) {
+    instance[0] -= permits;
+  }
+  MUTEX_UNLOCK(&queue->lock);
+
+  return is_acquired;
+}
+
+void ThreadScheduler::SemaphoreRelease(size_t* instance, INT64_VALUE permits)
+{
+  // waiters may ask for different counts, wake them all to recheck
+  WaitQueue* queue = (WaitQueue*)(instance + 1);
+  MUTEX_LOCK(&queue->lock);
+  instance[0] += permits;
+  Notify(queue, true);
+  MUTEX_UNLOCK(&queue->lock);
+}
+
+//
+// writers are preferred, readers wait while a writer holds or waits on the lock
+//
+void ThreadScheduler::ReadLock(size_t* instance)
+{
+  WaitQueue* queue = (WaitQueue*)(instance + 3);
+  MUTEX_LOCK(&queue->lock);
+  while(instance[1] || instance[2]) {
+    Wait(queue);
+  }
+  instance[0]++;
+  MUTEX_UNLOCK(&queue->lock);
+}
+
+void ThreadScheduler::ReadUnlock(size_t* instance)
+{
+  WaitQueue* queue = (WaitQueue*)(instance + 3);
+  MUTEX_LOCK(&queue->lock);
+  if(instance[0] > 0 && --instance[0] == 0 && instance[2]) {
+    Notify(queue, true);
+  }
+  MUTEX_UNLOCK(&queue->lock);
+}
+
+void ThreadScheduler::WriteLock(size_t* instance)
+{
+  WaitQueue* queue = (WaitQueue*)(instance + 3);
+  MUTEX_LOCK(&queue->lock);
+  instance[2]++;
+  while(instance[1] || instance[0]) {
+    Wait(queue);
+  }
+  instance[2]--;
+  instance[1] = 1;
+  MUTEX_UNLOCK(&queue->lock);
+}
+
+void ThreadScheduler::WriteUnlock(size_t* instance)
+{
+  WaitQueue* queue = (WaitQueue*)(instance + 3);
+  MUTEX_LOCK(&queue->lock);
+  if(instance[1]) {
+    instance[1] = 0;
+    Notify(queue, true);
+  }
+  MUTEX_UNLOCK(&queue->lock);
+}
+
+//
+// blocking calls leave the heap to the collector and give up the carrier's
+// slot, queued threads move to an idle or new carrier in the meantime
+//
+void ThreadScheduler::BlockingStart()
+{
+  if(blocking_depth++ == 0) {
+    MemoryManager::EnterSafeRegion();
+    if(carrier) {
+      running_count--;
+      if(runnable_count > 0) {
+        WakeCarrier();
+      }
+    }
+  }
+}
+
+void ThreadScheduler::BlockingEnd()
+{
+  if(--blocking_depth == 0) {
+    if(carrier) {
+      running_count++;
+    }
+    MemoryManager::LeaveSafeRegion();
+  }
+}
+
+void ThreadScheduler::Enqueue(GreenThread* thread)
+{
+  CarrierThread* current = carrier;
+  if(current) {
+    MUTEX_LOCK(&current->queue_lock);
+    current->queue.push_back(thread);
+    MUTEX_UNLOCK(&current->queue_lock);
+  }
+  else {
+    MUTEX_LOCK(&scheduler_lock);
+    global_queue.push_back(thread);
+    MUTEX_UNLOCK(&scheduler_lock);
+  }
+  runnable_count++;
+
+  WakeCarrier();
+}
+
+void ThreadScheduler::WakeCarrier()
+{
+  if(running_count >= carrier_target) {
+    return;
+  }
+
+  MUTEX_LOCK(&scheduler_lock);
+  if(idle_count > 0) {
+    COND_SIGNAL(&carrier_cond);
+  }
+  else if(carrier_count < CARRIER_SEGMENTS_MAX * CARRIER_THREADS_MAX) {
+    StartCarrier();
+  }
+  MUTEX_UNLOCK(&scheduler_lock);
+}
+
+// note: called with 'scheduler_lock' held
+void ThreadScheduler::StartCarrier()
+{
+  CarrierThread* current = new CarrierThread;
+  current->current = nullptr;
+  current->ticks = 0;
+#ifdef _WIN32
+  InitializeCriticalSection(&current->queue_lock);
+#else
+  pthread_mutex_init(&current->queue_lock, nullptr);
+#endif
+  const long index = carrier_count;
+  if(!carriers[index / CARRIER_THREADS_MAX]) {
+    carriers[index / CARRIER_THREADS_MAX] = new CarrierThread*[CARRIER_THREADS_MAX];
+  }
+  carriers[index / CARRIER_THREADS_MAX][index % CARRIER_THREADS_MAX] = current;
+  carrier_count++;
+  idle_count++;
+
+#ifdef _WIN32
+  HANDLE carrier_thread = (HANDLE)_beginthreadex(nullptr, 0, CarrierMain, current, 0, nullptr);
+  if(!carrier_thread) {
+    std::wcerr << L">>> Internal error: Unable to create carrier thread! <<<" << std::endl;
+    exit(-1);
+  }
+  CloseHandle(carrier_thread);
+#else
+  pthread_attr_t attrs;
+  pthread_attr_init(&attrs);
+  pthread_attr_setdetachstate(&attrs, PTHREAD_CREATE_DETACHED);
+
+  pthread_t carrier_thread;
+  if(pthread_create(&carrier_thread, &attrs, CarrierMain, (void*)current)) {
+    std::wcerr << L">>> Internal error: Unable to create carrier thread! <<<" << std::endl;
+    exit(-1);
+  }
+  pthread_attr_destroy(&attrs);
+#endif
+}
+
+#ifdef _WIN32
+unsigned int WINAPI ThreadScheduler::CarrierMain(LPVOID arg)
+#else
+void* ThreadScheduler::CarrierMain(void* arg)
+#endif
+{
+  CarrierThread* current = (CarrierThread*)arg;
+  carrier = current;
+  if(!current->fiber.Attach()) {
+    std::wcerr << L">>> Internal error: Unable to create carrier thread! <<<" << std::endl;
+    exit(-1);
+  }
+
+  // carriers only stop the collector while running a thread
+  MemoryManager::AddMutator();
+  MemoryManager::EnterSafeRegion();
+
+  while(true) {
+    GreenThread* thread = nullptr;
+    if(running_count < carrier_target) {
+      thread = NextThread(current);
+    }
+
+    if(thread) {
+      idle_count--;
+      running_count++;
+      if(runnable_count > 0) {
+        WakeCarrier();
+      }
+
+      MemoryManager::LeaveSafeRegion();
+      Resume(current, thread);
+      MemoryManager::EnterSafeRegion();
+
+      running_count--;
+      idle_count++;
+
+      // the thread is off its stack, act on why it parked
+      switch(thread->state) {
+      case GREEN_RUNNABLE:
+        MUTEX_LOCK(&current->queue_lock);
+        current->queue.push_back(thread);
+        MUTEX_UNLOCK(&current->queue_lock);
+        runnable_count++;
+        break;
+
+      case GREEN_SLEEPING: {
+        const int64_t wake = thread->wake_time.time_since_epoch().count();
+        MUTEX_LOCK(&scheduler_lock);
+        sleepers.insert(std::make_pair(thread->wake_time, thread));
+        if(wake < next_wake) {
+          next_wake = wake;
+          if(idle_count > 1) {
+            COND_SIGNAL(&carrier_cond);
+          }
+        }
+        MUTEX_UNLOCK(&scheduler_lock);
+      }
+        break;
+
+      case GREEN_JOINING: {
+        MUTEX_LOCK(&scheduler_lock);
+        std::unordered_map<size_t, GreenThread*>::iterator found = green_threads.find(thread->join_id);
+        const bool is_done = found == green_threads.end();
+        if(!is_done) {
+          found->second->joiners.push_back(thread);
+        }
+        MUTEX_UNLOCK(&scheduler_lock);
+
+        if(is_done) {
+          Enqueue(thread);
+        }
+      }
+        break;
+
+      case GREEN_WAITING: {
+        // parked holding the queue's lock so notifies aren't missed, see 'Wait'
+        WaitQueue* queue = thread->wait_queue;
+        thread->next_waiter = nullptr;
+        if(queue->tail) {
+          queue->tail->next_waiter = thread;
+        }
+        else {
+          queue->head = thread;
+        }
+        queue->tail = thread;
+        MUTEX_UNLOCK(&queue->lock);
+      }
+        break;
+
+      case GREEN_DONE:
+        Finish(thread);
+        break;
+      }
+    }
+    else {
+      // wait for work or the next sleeper
+      MUTEX_LOCK(&scheduler_lock);
+      if(runnable_count <= 0 || running_count >= carrier_target) {
+        if(sleepers.empty()) {
+          COND_WAIT(&carrier_cond, &scheduler_lock);
+        }
+        else {
+          const std::chrono::steady_clock::duration wait = sleepers.begin()->first - std::chrono::steady_clock::now();
+          if(wait.count() > 0) {
+#ifdef _WIN32
+            SleepConditionVariableCS(&carrier_cond, &scheduler_lock, (DWORD)std::chrono::duration_cast<std::chrono::milliseconds>(wait).count() + 1);
+#else
+            const int64_t nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(wait).count();
+            struct timespec until;
+            clock_gettime(CLOCK_REALTIME, &until);
+            until.tv_sec += (time_t)(nsec / 1000000000L + (until.tv_nsec + nsec % 1000000000L) / 1000000000L);
+            until.tv_nsec = (until.tv_nsec + nsec % 1000000000L) % 1000000000L;
+            pthread_cond_timedwait(&carrier_cond, &scheduler_lock, &until);
+#endif
+          }
+        }
+      }
+      MUTEX_UNLOCK(&scheduler_lock);
+    }
+  }
+
+  return 0;
+}
+
+//
+// local queue first, then woken sleepers and threads started outside the
+// carriers, then steal from the back of another carrier's queue
+//
+GreenThread* ThreadScheduler::NextThread(CarrierThread* current)
+{
+  GreenThread* thread = nullptr;
+
+  bool is_shared = ++current->ticks % SHARED_QUEUE_TICKS == 0;
+  if(!is_shared && next_wake != INT64_MAX) {
+    is_shared = std::chrono::steady_clock::now().time_since_epoch().count() >= next_wake;
+  }
+
+  if(!is_shared) {
+    MUTEX_LOCK(&current->queue_lock);
+    if(!current->queue.empty()) {
+      thread = current->queue.front();
+      current->queue.pop_front();
+    }
+    MUTEX_UNLOCK(&current->queue_lock);
+
+    if(thread) {
+      runnable_count--;
+      return thread;
+    }
+  }
+
+  MUTEX_LOCK(&scheduler_lock);
+  if(!sleepers.empty()) {
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    while(!sleepers.empty() && sleepers.begin()->first <= now) {
+      GreenThread* woken = sleepers.begin()->second;
+      sleepers.erase(sleepers.begin());
+      if(thread) {
+        MUTEX_LOCK(&current->queue_lock);
+        current->queue.push_back(woken);
+        MUTEX_UNLOCK(&current->queue_lock);
+        runnable_count++;
+      }
+      else {
+        thread = woken;
+      }
+    }
+    next_wake = sleepers.empty() ? INT64_MAX : sleepers.begin()->first.time_since_epoch().count();
+  }
+
+  if(!thread && !global_queue.empty()) {
+    thread = global_queue.front();
+    global_queue.pop_front();
+    runnable_count--;
+  }
+  MUTEX_UNLOCK(&scheduler_lock);
+
+  if(thread) {
+    return thread;
+  }
+
+  if(is_shared) {
+    MUTEX_LOCK(&current->queue_lock);
+    if(!current->queue.empty()) {
+      thread = current->queue.front();
+      current->queue.pop_front();
+    }
+    MUTEX_UNLOCK(&current->queue_lock);
+
+    if(thread) {
+      runnable_count--;
+      return thread;
+    }
+  }
+
+  // steal
+  const long count = carrier_count;
+  for(long i = 1; !thread && i < count; ++i) {
+    CarrierThread* victim = GetCarrier((long)((current->ticks + i) % count));
+    if(victim != current && MUTEX_TRYLOCK(&victim->queue_lock)) {
+      if(!victim->queue.empty()) {
+        thread = victim->queue.back();
+        victim->queue.pop_back();
+      }
+      MUTEX_UNLOCK(&victim->queue_lock);
+    }
+  }
+
+  if(thread) {
+    runnable_count--;
+  }
+
+  return thread;
+}
+
+void ThreadScheduler::Resume(CarrierThread* current, GreenThread* thread)
+{
+  current->current = thread;
+  thread->carrier = current;
+  current->fiber.Switch(&thread->fiber);
+  current->current = nullptr;
+}
+
+void ThreadScheduler::Park(GreenThread* thread)
+{
+  thread->fiber.Switch(&thread->carrier->fiber);
+}
+
+void ThreadScheduler::FiberMain(void* arg)
+{
+  GreenThread* thread = (GreenThread*)arg;
+  ThreadHolder* holder = thread->holder;
+  holder->intpr->Execute(holder->op_stack, holder->stack_pos, 0, holder->called, holder->self, false);
+
+  // never resumed, the fiber is recycled
+  thread->state = GREEN_DONE;
+  Park(thread);
+}
+
+void ThreadScheduler::Finish(GreenThread* thread)
+{
+  // clean up, unregister roots before releasing the stack
+  ThreadHolder* holder = thread->holder;
+  StackInterpreter::RemoveThread(holder->intpr);
+  delete holder->intpr;
+  holder->intpr = nullptr;
+
+  delete[] holder->op_stack;
+  holder->op_stack = nullptr;
+
+  delete holder->stack_pos;
+  holder->stack_pos = nullptr;
+
+  delete holder;
+  holder = nullptr;
+  thread->holder = nullptr;
+
+  // wake joiners
+  std::vector<GreenThread*> joiners;
+  MUTEX_LOCK(&scheduler_lock);
+  green_threads.erase(thread->id);
+  joiners.swap(thread->joiners);
+  if(thread_cache.size() < GREEN_THREAD_CACHE) {
+    thread_cache.push_back(thread);
+    thread = nullptr;
+  }
+  COND_BROADCAST(&join_cond);
+  MUTEX_UNLOCK(&scheduler_lock);
+
+  if(thread) {
+    delete thread;
+    thread = nullptr;
+  }
+
+  for(size_t i = 0; i < joiners.size(); ++i) {
+    Enqueue(joiners[i]);
+  }
+}
+
+/********************************
+ * Task executor
+ ********************************/
+namespace Runtime {
+  // interpreter and operand stack reused by a worker's tasks
+  struct TaskRunner {
+    StackInterpreter* intpr;
+    size_t* op_stack;
+    long* stack_pos;
+  };
+
+  // pool thread, tasks it submits go to the back of its own queue
+  struct TaskWorker {
+    std::deque<size_t*> queue;
+    std::vector<TaskRunner*> runners;
+    size_t depth;
+    size_t ticks;
+    std::unordered_map<StackClass*, StackMethod*> run_methods;
+#ifdef _WIN32
+    CRITICAL_SECTION queue_lock;
+#else
+    pthread_mutex_t queue_lock;
+#endif
+  };
+
+  // native jobs, indexes are handed out and counted under 'executor_lock'
+  struct NativeBatch {
+    const std::function<void(size_t)>* job;
+    size_t count;
+    size_t next;
+    size_t done;
+  };
+}
+
+long TaskExecutor::worker_target = 0;
+TaskWorker* TaskExecutor::workers[TASK_WORKERS_MAX];
+std::atomic<long> TaskExecutor::worker_count(0);
+std::atomic<long> TaskExecutor::idle_count(0);
+std::atomic<long> TaskExecutor::waiting_count(0);
+std::atomic<long> TaskExecutor::queued_count(0);
+std::atomic<long> TaskExecutor::running_count(0);
+std::atomic<bool> TaskExecutor::is_exiting(false);
+std::atomic<long> TaskExecutor::native_count(0);
+std::deque<size_t*> TaskExecutor::global_queue;
+std::atomic<long> TaskExecutor::global_count(0);
+std::deque<NativeBatch*> TaskExecutor::native_batches;
+thread_local TaskWorker* TaskExecutor::worker = nullptr;
+
+#ifdef _WIN32
+CRITICAL_SECTION TaskExecutor::executor_lock;
+CONDITION_VARIABLE TaskExecutor::work_cond;
+CONDITION_VARIABLE TaskExecutor::done_cond;
+#else
+pthread_mutex_t TaskExecutor::executor_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t TaskExecutor::work_cond = PTHREAD_COND_INITIALIZER;
+pthread_cond_t TaskExecutor::done_cond = PTHREAD_COND_INITIALIZER;
+#endif
+
+void TaskExecutor::Initialize()
+{
+#ifdef _WIN32
+  InitializeCriticalSection(&executor_lock);
+  InitializeConditionVariable(&work_cond);
+  InitializeConditionVariable(&done_cond);
+#endif
+
+  // a worker per core, started as tasks are queued
+  long workers = (long)std::thread::hardware_concurrency();
+  if(workers < 1) {
+    workers = 1;
+  }
+  worker_target = workers < TASK_WORKERS_MAX ? workers : TASK_WORKERS_MAX;
+}
+
+void TaskExecutor::Submit(size_t* task)
+{
+  MemoryManager::AddNativeRoot(task);
+
+  TaskWorker* current = worker;
+  if(current) {
+    MUTEX_LOCK(&current->queue_lock);
+    current->queue.push_back(task);
+    MUTEX_UNLOCK(&current->queue_lock);
+  }
+  else {
+    MUTEX_LOCK(&executor_lock);
+    global_queue.push_back(task);
+    global_count++;
+    MUTEX_UNLOCK(&executor_lock);
+  }
+  queued_count++;
+
+  // wake an idle worker or start another, waiting workers may also take it
+  if(idle_count > 0 || waiting_count > 0 || worker_count < worker_target) {
+    MUTEX_LOCK(&executor_lock);
+    if(idle_count > 0) {
+      COND_SIGNAL(&work_cond);
+    }
+    else if(worker_count < worker_target) {
+      StartWorker();
+    }
+    if(waiting_count > 0) {
+      COND_BROADCAST(&done_cond);
+    }
+    MUTEX_UNLOCK(&executor_lock);
+  }
+}
+
+void TaskExecutor::Wait(size_t* future)
+{
+  std::atomic<size_t>* done = reinterpret_cast<std::atomic<size_t>*>(&future[0]);
+  TaskWorker* current = worker;
+
+  while(!done->load(std::memory_order_acquire)) {
+    // workers run queued tasks rather than block, the future's task may be one of them
+    const bool is_helping = current && current->depth < TASK_NESTING_MAX;
+    if(is_helping) {
+      size_t* task = NextTask(current);
+      if(task) {
+        Run(current, task);
+        continue;
+      }
+    }
+    // green threads park rather than hold their carrier
+    else if(!current) {
+      waiting_count++;
+      const bool is_parked = ThreadScheduler::WaitDone(done);
+      waiting_count--;
+      if(is_parked) {
+        return;
+      }
+    }
+
+    ThreadScheduler::BlockingStart();
+    MUTEX_LOCK(&executor_lock);
+    waiting_count++;
+    while(!done->load(std::memory_order_acquire) && !(is_helping && queued_count > 0)) {
+      COND_WAIT(&done_cond, &executor_lock);
+    }
+    waiting_count--;
+    MUTEX_UNLOCK(&executor_lock);
+    ThreadScheduler::BlockingEnd();
+  }
+}
+
+void TaskExecutor::Notify()
+{
+  // pairs with the waiter's count, the future was completed before this call
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if(waiting_count > 0) {
+    MUTEX_LOCK(&executor_lock);
+    COND_BROADCAST(&done_cond);
+    MUTEX_UNLOCK(&executor_lock);
+    ThreadScheduler::NotifyDone();
+  }
+}
+
+void TaskExecutor::ParallelFor(size_t count, const std::function<void(size_t)>& job)
+{
+  if(count < 2) {
+    if(count) {
+      job(0);
+    }
+    return;
+  }
+
+  // the caller's arrays stay put while it's in a safe region, jobs leave the heap alone
+  ThreadScheduler::BlockingStart();
+
+  NativeBatch batch;
+  batch.job = &job;
+  batch.count = count;
+  batch.next = batch.done = 0;
+
+  MUTEX_LOCK(&executor_lock);
+  native_batches.push_back(&batch);
+  native_count += (long)count;
+  for(long i = 1; i < (long)count && worker_count < worker_target; ++i) {
+    StartWorker();
+  }
+  if(idle_count > 0) {
+    COND_BROADCAST(&work_cond);
+  }
+  MUTEX_UNLOCK(&executor_lock);
+
+  // run jobs until they're all taken, then wait for workers to finish theirs
+  while(RunNative(&batch)) {
+  }
+
+  MUTEX_LOCK(&executor_lock);
+  while(batch.done < batch.count) {
+    COND_WAIT(&done_cond, &executor_lock);
+  }
+  MUTEX_UNLOCK(&executor_lock);
+
+  ThreadScheduler::BlockingEnd();
+}
+
+// runs a job from 'batch', or from any queued batch if none given
+bool TaskExecutor::RunNative(NativeBatch* batch)
+{
+  MUTEX_LOCK(&executor_lock);
+  if(!batch && !native_batches.empty()) {
+    batch = native_batches.front();
+  }
+  if(!batch || batch->next == batch->count) {
+    MUTEX_UNLOCK(&executor_lock);
+    return false;
+  }
+
+  const size_t index = batch->next++;
+  if(batch->next == batch->count) {
+    native_batches.erase(std::find(native_batches.begin(), native_batches.end(), batch));
+  }
+  native_count--;
+  MUTEX_UNLOCK(&executor_lock);
+
+  (*batch->job)(index);
+
+  MUTEX_LOCK(&executor_lock);
+  if(++batch->done == batch->count) {
+    COND_BROADCAST(&done_cond);
+  }
+  MUTEX_UNLOCK(&executor_lock);
+
+  return true;
+}
+
+void TaskExecutor::Shutdown()
+{
+  // the program is released on exit, workers may not be left running its code
+  is_exiting = true;
+  MUTEX_LOCK(&executor_lock);
+  while(queued_count > 0 || running_count > 0) {
+    COND_WAIT(&done_cond, &executor_lock);
+  }
+  MUTEX_UNLOCK(&executor_lock);
+}
+
+// note: called with 'executor_lock' held
+void TaskExecutor::StartWorker()
+{
+  TaskWorker* current = new TaskWorker;
+  current->depth = 0;
+  current->ticks = 0;
+#ifdef _WIN32
+  InitializeCriticalSection(&current->queue_lock);
+#else
+  pthread_mutex_init(&current->queue_lock, nullptr);
+#endif
+  workers[worker_count] = current;
+  worker_count++;
+
+#ifdef _WIN32
+  HANDLE worker_thread = (HANDLE)_beginthreadex(nullptr, 0, WorkerMain, current, 0, nullptr);
+  if(!worker_thread) {
+    std::wcerr << L">>> Internal error: Unable to create executor thread! <<<" << std::endl;
+    exit(-1);
+  }
+  CloseHandle(worker_thread);
+#else
+  pthread_attr_t attrs;
+  pthread_attr_init(&attrs);
+  pthread_attr_setdetachstate(&attrs, PTHREAD_CREATE_DETACHED);
+
+  pthread_t worker_thread;
+  if(pthread_create(&worker_thread, &attrs, WorkerMain, (void*)current)) {
+    std::wcerr << L">>> Internal error: Unable to create executor thread! <<<" << std::endl;
+    exit(-1);
+  }
+  pthread_attr_destroy(&attrs);
+#endif
+}
+
+#ifdef _WIN32
+unsigned int WINAPI TaskExecutor::WorkerMain(LPVOID arg)
+#else
+void* TaskExecutor::WorkerMain(void* arg)
+#endif
+{
+  TaskWorker* current = (TaskWorker*)arg;
+  worker = current;
+  MemoryManager::AddMutator();
+
+  while(true) {
+    // native jobs first, their caller is waiting on them
+    if(native_count > 0) {
+      MemoryManager::EnterSafeRegion();
+      while(RunNative(nullptr)) {
+      }
+      MemoryManager::LeaveSafeRegion();
+    }
+
+    size_t* task = NextTask(current);
+    if(task) {
+      Run(current, task);
+    }
+    else {
+      // idle workers stay out of the collector's way
+      MemoryManager::EnterSafeRegion();
+      MUTEX_LOCK(&executor_lock);
+      idle_count++;
+      while(queued_count <= 0 && native_count <= 0) {
+        COND_WAIT(&work_cond, &executor_lock);
+      }
+      idle_count--;
+      MUTEX_UNLOCK(&executor_lock);
+      MemoryManager::LeaveSafeRegion();
+    }
+  }
+
+  return 0;
+}
+
+//
+// newest local task first, then tasks queued outside the pool, then steal
+// the oldest task from another worker
+//
+size_t* TaskExecutor::NextTask(TaskWorker* current)
+{
+  size_t* task = nullptr;
+
+  MUTEX_LOCK(&current->queue_lock);
+  if(!current->queue.empty()) {
+    task = current->queue.back();
+    current->queue.pop_back();
+  }
+  MUTEX_UNLOCK(&current->queue_lock);
+
+  if(!task && global_count > 0) {
+    MUTEX_LOCK(&executor_lock);
+    if(!global_queue.empty()) {
+      task = global_queue.front();
+      global_queue.pop_front();
+      global_count--;
+    }
+    MUTEX_UNLOCK(&executor_lock);
+  }
+
+  // steal
+  const long count = worker_count;
+  for(long i = 1; !task && i < count; ++i) {
+    TaskWorker* victim = workers[(++current->ticks + i) % count];
+    if(victim != current && MUTEX_TRYLOCK(&victim->queue_lock)) {
+      if(!victim->queue.empty()) {
+        task = victim->queue.front();
+        victim->queue.pop_front();
+      }
+      MUTEX_UNLOCK(&victim->queue_lock);
+    }
+  }
+
+  // counted as running before it's dequeued, the executor is never seen idle in between
+  if(task) {
+    running_count++;
+    queued_count--;
+  }
+
+  return task;
+}
+
+void TaskExecutor::Run(TaskWorker* current, size_t* task)
+{
+  // interpreters are reused, one for each level of tasks run while waiting
+  if(current->depth == current->runners.size()) {
+    TaskRunner* runner = new TaskRunner;
+    runner->op_stack = new size_t[OP_STACK_SIZE];
+    runner->stack_pos = new long;
+    (*runner->stack_pos) = 0;
+    runner->intpr = new StackInterpreter;
+    runner->intpr->SetOperandStack(runner->op_stack, runner->stack_pos);
+    StackInterpreter::AddThread(runner->intpr);
+    current->runners.push_back(runner);
+  }
+  TaskRunner* runner = current->runners[current->depth++];
+
+  StackMethod* method = GetRunMethod(current, task);
+  if(method) {
+    (*runner->stack_pos) = 0;
+    runner->intpr->Execute(runner->op_stack, runner->stack_pos, 0, method, task, false);
+  }
+
+  current->depth--;
+  MemoryManager::RemoveNativeRoot(task);
+
+  if(--running_count == 0 && is_exiting) {
+    MUTEX_LOCK(&executor_lock);
+    COND_BROADCAST(&done_cond);
+    MUTEX_UNLOCK(&executor_lock);
+  }
+}
+
+StackMethod* TaskExecutor::GetRunMethod(TaskWorker* current, size_t* task)
+{
+  StackClass* impl_class = MemoryManager::GetClass(task);
+  if(!impl_class) {
+    return nullptr;
+  }
+
+  std::unordered_map<StackClass*, StackMethod*>::iterator found = current->run_methods.find(impl_class);
+  if(found != current->run_methods.end()) {
+    return found->second;
+  }
+
+  StackMethod* called = nullptr;
+  for(StackClass* cls = impl_class; !called && cls; cls = cls->GetParent()) {
+    called = cls->GetMethod(cls->GetName() + L":Run:");
+  }
+  current->run_methods[impl_class] = called;
+
+  return called;
+}
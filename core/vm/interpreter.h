@@ -36,6 +36,11 @@
 #include <random>
 #include <string.h>
 #include <thread>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <functional>
 
 #ifdef _WIN32
 #include "arch/memory.h"
@@ -57,6 +62,27 @@ namespace Runtime {
 #define FRAME_CACHE_SIZE 1024
 #define CALL_STACK_SIZE 256
 #define OP_STACK_SIZE 64
+#define GREEN_STACK_SIZE 512 * 1024
+#define GREEN_THREAD_CACHE 64
+#define GREEN_YIELD_COUNT 1024
+#define CARRIER_THREADS_MAX 256
+#define CARRIER_SEGMENTS_MAX 256
+#define TASK_WORKERS_MAX 256
+#define TASK_NESTING_MAX 32
+#define WAIT_QUEUE_SIZE 16
+
+#ifdef _PROFILE
+#define PROFILE_NGRAM_MAX 4
+#define PROFILE_TOP_COUNT 16
+#include <unordered_map>
+#endif
+
+  class StackInterpreter;
+  struct GreenThread;
+  struct CarrierThread;
+  struct WaitQueue;
+  struct TaskWorker;
+  struct NativeBatch;
 
   // holds the calling context for async
   // method calls
@@ -64,6 +90,183 @@ namespace Runtime {
     StackMethod* called;
     size_t* self;
     size_t* param;
+    StackInterpreter* intpr;
+    size_t* op_stack;
+    long* stack_pos;
+  };
+
+  //
+  // ThreadScheduler, runs VM threads as green threads multiplexed over a
+  // fixed set of carrier OS threads. Each carrier runs threads from its own
+  // queue and steals from the others when empty. Blocking traps hand their
+  // carrier off, so a new one picks up the queued work.
+  //
+  class ThreadScheduler {
+    static long carrier_target;
+    // carriers in segments of 'CARRIER_THREADS_MAX', a segment never moves once
+    // published, so stealing reads them without a lock. Carriers blocked in traps
+    // don't count against 'carrier_target', their replacements add segments.
+    static CarrierThread** carriers[CARRIER_SEGMENTS_MAX];
+    static std::atomic<long> carrier_count;
+    static std::atomic<long> running_count;
+    static std::atomic<long> idle_count;
+    static std::atomic<long> runnable_count;
+    static std::atomic<int64_t> next_wake;
+    static size_t next_id;
+    static std::deque<GreenThread*> global_queue;
+    static std::unordered_map<size_t, GreenThread*> green_threads;
+    static std::multimap<std::chrono::steady_clock::time_point, GreenThread*> sleepers;
+    static std::vector<GreenThread*> thread_cache;
+    static thread_local CarrierThread* carrier;
+    static thread_local long blocking_depth;
+    static WaitQueue done_queue;
+
+#ifdef _WIN32
+    static CRITICAL_SECTION scheduler_lock;
+    static CONDITION_VARIABLE carrier_cond;
+    static CONDITION_VARIABLE join_cond;
+#else
+    static pthread_mutex_t scheduler_lock;
+    static pthread_cond_t carrier_cond;
+    static pthread_cond_t join_cond;
+#endif
+
+#ifdef _WIN32
+    static unsigned int WINAPI CarrierMain(LPVOID arg);
+#else
+    static void* CarrierMain(void* arg);
+#endif
+    static void FiberMain(void* arg);
+
+    static void StartCarrier();
+    static CarrierThread* GetCarrier(long index) {
+      return carriers[index / CARRIER_THREADS_MAX][index % CARRIER_THREADS_MAX];
+    }
+    static void WakeCarrier();
+    static void Enqueue(GreenThread* thread);
+    static GreenThread* NextThread(CarrierThread* current);
+    static void Resume(CarrierThread* current, GreenThread* thread);
+    static void Park(GreenThread* thread);
+    static void Finish(GreenThread* thread);
+    static size_t LockOwner();
+    static void Wait(WaitQueue* queue);
+    static void Notify(WaitQueue* queue, bool is_all);
+
+  public:
+    // number of carriers, 0 runs each VM thread on its own OS thread
+    static void Initialize(long carriers);
+
+    static inline bool IsGreen() {
+      return carrier_target > 0;
+    }
+
+    // queues a green thread, returns its id
+    static size_t Spawn(ThreadHolder* holder);
+    static bool Join(size_t* instance);
+    static void Sleep(INT64_VALUE msec);
+    static void Reschedule();
+
+    // thread mutexes
+    static void InitializeLock(size_t* instance);
+    static void Lock(size_t* instance);
+    static bool Unlock(size_t* instance);
+
+    // condition variables, semaphores and reader-writer locks
+    static void InitializeWaitQueue(size_t* instance);
+    static bool ConditionWait(size_t* instance, size_t* mutex);
+    static void ConditionNotify(size_t* instance, bool is_all);
+    static void SemaphoreAcquire(size_t* instance, INT64_VALUE permits);
+    static bool SemaphoreTryAcquire(size_t* instance, INT64_VALUE permits);
+    static void SemaphoreRelease(size_t* instance, INT64_VALUE permits);
+    static void ReadLock(size_t* instance);
+    static void ReadUnlock(size_t* instance);
+    static void WriteLock(size_t* instance);
+    static void WriteUnlock(size_t* instance);
+
+    // futures, a green thread parks until its future is done
+    static bool WaitDone(std::atomic<size_t>* done);
+    static void NotifyDone();
+
+    // yields the carrier if other threads are waiting to run
+    static inline void Preempt() {
+      if(carrier && (runnable_count.load(std::memory_order_relaxed) > 0 || 
+                     next_wake.load(std::memory_order_relaxed) <= std::chrono::steady_clock::now().time_since_epoch().count())) {
+        Reschedule();
+      }
+    }
+
+    // brackets native calls that may block
+    static void BlockingStart();
+    static void BlockingEnd();
+  };
+
+  //
+  // TaskExecutor, a work-stealing pool of OS threads, one per core, that
+  // runs 'System.Concurrency.Task' objects. Workers push and pop their own
+  // queue from the back and steal from the front of others. Interpreters are
+  // reused across tasks, threads waiting on a future run queued tasks.
+  //
+  class TaskExecutor {
+    static long worker_target;
+    static TaskWorker* workers[TASK_WORKERS_MAX];
+    static std::atomic<long> worker_count;
+    static std::atomic<long> idle_count;
+    static std::atomic<long> waiting_count;
+    static std::atomic<long> queued_count;
+    static std::atomic<long> running_count;
+    static std::atomic<bool> is_exiting;
+    static std::atomic<long> native_count;
+    static std::deque<size_t*> global_queue;
+    // size of 'global_queue', checked by workers without the lock
+    static std::atomic<long> global_count;
+    static std::deque<NativeBatch*> native_batches;
+    static thread_local TaskWorker* worker;
+
+#ifdef _WIN32
+    static CRITICAL_SECTION executor_lock;
+    static CONDITION_VARIABLE work_cond;
+    static CONDITION_VARIABLE done_cond;
+#else
+    static pthread_mutex_t executor_lock;
+    static pthread_cond_t work_cond;
+    static pthread_cond_t done_cond;
+#endif
+
+#ifdef _WIN32
+    static unsigned int WINAPI WorkerMain(LPVOID arg);
+#else
+    static void* WorkerMain(void* arg);
+#endif
+
+    static void StartWorker();
+    static size_t* NextTask(TaskWorker* current);
+    static void Run(TaskWorker* current, size_t* task);
+    static StackMethod* GetRunMethod(TaskWorker* current, size_t* task);
+    static bool RunNative(NativeBatch* batch);
+
+  public:
+    static void Initialize();
+
+    static inline long GetSize() {
+      return worker_target;
+    }
+
+    // queues a task, it's a root until it has run
+    static void Submit(size_t* task);
+
+    // waits until a future's first member is set, running queued tasks meanwhile
+    static void Wait(size_t* future);
+
+    // wakes threads waiting on futures
+    static void Notify();
+
+    // runs 'job(0..count - 1)' on the pool and the calling thread, then returns.
+    // Jobs run outside the collector's view, so they may read and write array
+    // elements but not allocate or update references.
+    static void ParallelFor(size_t count, const std::function<void(size_t)>& job);
+
+    // waits for queued and running tasks to finish before the VM exits
+    static void Shutdown();
   };
   
   //
@@ -76,6 +279,19 @@ namespace Runtime {
     static std::stack<StackFrame*> cached_frames;
     static std::random_device gen;
 
+#ifdef _PROFILE
+    // opcode n-gram counts, one table per thread
+    static std::vector<std::unordered_map<uint64_t, size_t>*> profile_ngrams;
+    static thread_local std::unordered_map<uint64_t, size_t>* thread_ngrams;
+    static thread_local uint64_t profile_window;
+    static thread_local int profile_window_size;
+#ifdef _WIN32
+    static CRITICAL_SECTION profile_cs;
+#else
+    static pthread_mutex_t profile_mutex;
+#endif
+#endif
+
 #ifdef _WIN32
     static bool is_stdio_binary;
 #endif
@@ -98,6 +314,9 @@ namespace Runtime {
     // halt
     bool halt;
 
+    // backward branches until the next preemption check
+    long yield_count;
+
 #ifdef _DEBUGGER
     Debugger* debugger;
 #endif
@@ -149,6 +368,14 @@ namespace Runtime {
     //
     // is call stack empty?
     //
+    inline void Safepoint() {
+      MemoryManager::Safepoint();
+      if(--yield_count < 0) {
+        yield_count = GREEN_YIELD_COUNT;
+        ThreadScheduler::Preempt();
+      }
+    }
+
     inline bool StackEmpty() {
       return (*call_stack_pos) == 0;
     }
@@ -267,6 +494,8 @@ namespace Runtime {
     void inline CopyClsInstIntVar(StackInstr* instr, size_t* &op_stack, long* &stack_pos);
     void inline LoadLoclIntVar(StackInstr* instr, size_t* &op_stack, long* &stack_pos);
     void inline LoadClsInstIntVar(StackInstr* instr, size_t* &op_stack, long* &stack_pos);
+    void inline IncLoclIntVar(StackInstr* instr);
+    void inline LoadLoclIntVars(StackInstr* instr, size_t* &op_stack, long* &stack_pos);
 
     void inline Str2Int(size_t* &op_stack, long* &stack_pos);
     void inline Str2Float(size_t* &op_stack, long* &stack_pos);
@@ -303,6 +532,7 @@ namespace Runtime {
     void inline LesFloat(size_t* &op_stack, long* &stack_pos);
     void inline GtrFloat(size_t* &op_stack, long* &stack_pos);
     void inline LoadArySize(size_t* &op_stack, long* &stack_pos);
+    void inline ChkObjInst(size_t* &op_stack, long* &stack_pos);
     void inline CpyByteAry(size_t* &op_stack, long* &stack_pos);
     void inline CpyCharAry(size_t* &op_stack, long* &stack_pos);
     void inline CpyIntAry(size_t* &op_stack, long* &stack_pos);
@@ -349,6 +579,10 @@ namespace Runtime {
     inline void SharedLibraryLoad(StackInstr* instr);
     inline void SharedLibraryUnload(StackInstr* instr);
     inline void SharedLibraryCall(StackInstr* instr, size_t* &op_stack, long* &stack_pos);
+
+#ifdef _PROFILE
+    inline void ProfileInstruction(const InstructionType type);
+#endif
     
   public:
 		// initialize the runtime system
@@ -424,6 +658,11 @@ namespace Runtime {
       halt = true;
     }
     
+#ifdef _PROFILE
+    // prints the most frequent opcode sequences
+    static void DumpProfile();
+#endif
+
     // free static resources
     static void Clear() {
       while(!cached_frames.empty()) {
@@ -445,7 +684,9 @@ namespace Runtime {
       call_stack = c;
       call_stack_pos = cp;
       frame = new StackFrame*;
+      *frame = nullptr;
       monitor = nullptr;
+      yield_count = GREEN_YIELD_COUNT;
       
       MemoryManager::AddPdaMethodRoot(frame);
     }
@@ -456,12 +697,16 @@ namespace Runtime {
       call_stack_pos = new long;
       *call_stack_pos = -1;
       frame = new StackFrame*;
+      *frame = nullptr;
+      yield_count = GREEN_YIELD_COUNT;
 
       // register monitor
       monitor = new StackFrameMonitor;
       monitor->call_stack = call_stack;
       monitor->call_stack_pos = call_stack_pos;
       monitor->cur_frame = frame;
+      monitor->op_stack = nullptr;
+      monitor->stack_pos = nullptr;
       MemoryManager::AddPdaMethodRoot(monitor);
     }
   
@@ -473,12 +718,16 @@ namespace Runtime {
       call_stack_pos = new long;
       *call_stack_pos = -1;
       frame = new StackFrame*;
+      *frame = nullptr;
+      yield_count = GREEN_YIELD_COUNT;
 
       // register monitor
       monitor = new StackFrameMonitor;
       monitor->call_stack = call_stack;
       monitor->call_stack_pos = call_stack_pos;
-      monitor->cur_frame = frame;      
+      monitor->cur_frame = frame;
+      monitor->op_stack = nullptr;
+      monitor->stack_pos = nullptr;
       MemoryManager::AddPdaMethodRoot(monitor);
     }
 
@@ -499,12 +748,16 @@ namespace Runtime {
       call_stack_pos = new long;
       *call_stack_pos = -1;
       frame = new StackFrame*;
+      *frame = nullptr;
+      yield_count = GREEN_YIELD_COUNT;
 
       // register monitor
       monitor = new StackFrameMonitor;
       monitor->call_stack = call_stack;
       monitor->call_stack_pos = call_stack_pos;
       monitor->cur_frame = frame;
+      monitor->op_stack = nullptr;
+      monitor->stack_pos = nullptr;
       MemoryManager::AddPdaMethodRoot(monitor);
     }
 #endif
@@ -530,6 +783,14 @@ namespace Runtime {
       frame = nullptr;
     }
 
+    // operand stack scanned for roots while this thread is stopped
+    inline void SetOperandStack(size_t* op_stack, long* stack_pos) {
+      if(monitor) {
+        monitor->op_stack = op_stack;
+        monitor->stack_pos = stack_pos;
+      }
+    }
+
     // execute method
     void Execute(size_t* op_stack, long* stack_pos, long i, StackMethod* method, size_t* instance, bool jit_called);
   };
@@ -622,6 +622,24 @@ void Loader::LoadStatements(StackMethod* method, bool is_debug)
     }
       break;
 
+    case INC_LOCL_INT_VAR: {
+      const long id = ReadInt();
+      const long value = ReadInt();
+      mthd_instrs[i] = new StackInstr(line_num, INC_LOCL_INT_VAR, id, value);
+    }
+      break;
+
+    case LOAD_LOCL_INT_VARS: {
+      const long id = ReadInt();
+      const long id2 = ReadInt();
+      mthd_instrs[i] = new StackInstr(line_num, LOAD_LOCL_INT_VARS, id, id2);
+    }
+      break;
+
+    case CHK_OBJ_INST:
+      mthd_instrs[i] = new StackInstr(line_num, CHK_OBJ_INST);
+      break;
+
     case COPY_FLOAT_VAR: {
       const long id = ReadInt();
       const MemoryContext mem_context = (MemoryContext)ReadInt();
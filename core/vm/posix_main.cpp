@@ -43,6 +43,7 @@ int main(const int argc, const char* argv[])
     // check for command line parameters
     //  
     size_t gc_threshold = 0;
+    long carrier_threads = -1;
     int vm_param_count = 0;
     
     // bool set_foo_bar_param = false; // TODO: add if needed
@@ -77,6 +78,15 @@ int main(const int argc, const char* argv[])
           }
         }
       }
+      // check for CARRIER_THREADS
+      else if(!name_value.rfind("--CARRIER_THREADS=", 0)) {
+        const size_t name_value_index = name_value.find_first_of(L'=');
+        if(name_value_index != std::string::npos) {
+          ++vm_param_count;
+          const std::string value(name_value.substr(name_value_index + 1));
+          carrier_threads = strtol(value.c_str(), nullptr, 10);
+        }
+      }
       /* TODO: add if needed
       // check for FOO_BAR
       else if(!name_value.rfind("--FOO_BAR=", 0)) {
@@ -104,9 +114,9 @@ int main(const int argc, const char* argv[])
     // Note: OBJECK_STDIO not needed for POSIX-like environments, ignore for MSYS2
     //
 #ifdef _WIN32
-    return Execute(argc - vm_param_count, argv + vm_param_count, false, gc_threshold);
+    return Execute(argc - vm_param_count, argv + vm_param_count, false, gc_threshold, carrier_threads);
 #else    
-    Execute(argc - vm_param_count, argv + vm_param_count, gc_threshold);
+    Execute(argc - vm_param_count, argv + vm_param_count, gc_threshold, carrier_threads);
 #endif    
   } 
   else {
@@ -115,6 +125,7 @@ int main(const int argc, const char* argv[])
 
     usage += L"Options:\n";
     usage += L"\t--GC_THRESHOLD:\t[prepend] inital garbage collection threshold <number>(k|m|g)\n";
+    usage += L"\t--CARRIER_THREADS:\t[prepend] OS threads that run VM threads, 0 for one per VM thread <number>\n";
     usage += L"\nExamples:\n\t\"obr hello.obe\"\n\t\"obr --GC_THRESHOLD=2m hello.obe\"\n \nVersion: ";
     usage += VERSION_STRING;
     
@@ -37,9 +37,9 @@
 
 // common execution point for all platforms
 #ifdef _WIN32
-int Execute(int argc, const char* argv[], bool is_stdio_binary, size_t gc_threshold)
+int Execute(int argc, const char* argv[], bool is_stdio_binary, size_t gc_threshold, long carrier_threads)
 #else
-int Execute(int argc, const char* argv[], size_t gc_threshold)
+int Execute(int argc, const char* argv[], size_t gc_threshold, long carrier_threads)
 #endif
 {
   if(argc > 1) {
@@ -59,9 +59,17 @@ int Execute(int argc, const char* argv[], size_t gc_threshold)
 #ifdef _WIN32
     Runtime::StackInterpreter::SetBinaryStdio(is_stdio_binary);
 #endif
+    Runtime::ThreadScheduler::Initialize(carrier_threads);
     Runtime::StackInterpreter* intpr = new Runtime::StackInterpreter(Loader::GetProgram(), gc_threshold);
     Runtime::StackInterpreter::AddThread(intpr);
+    MemoryManager::AddMutator();
     intpr->Execute(op_stack, stack_pos, 0, loader.GetProgram()->GetInitializationMethod(), nullptr, false);
+    MemoryManager::RemoveMutator();
+    Runtime::TaskExecutor::Shutdown();
+
+#ifdef _PROFILE
+    Runtime::StackInterpreter::DumpProfile();
+#endif
     
 #ifdef _DEBUG
     std::wcout << L"# final std::stack: pos=" << (*stack_pos) << L" #" << std::endl;
@@ -44,9 +44,9 @@
 extern "C"
 {
 #ifdef _WIN32
-  __declspec(dllexport) int Execute(int argc, const char* argv[], bool is_stdio_binary, size_t gc_threshold);
+  __declspec(dllexport) int Execute(int argc, const char* argv[], bool is_stdio_binary, size_t gc_threshold, long carrier_threads);
 #else
-  int Execute(int argc, const char* argv[], size_t gc_threshold);
+  int Execute(int argc, const char* argv[], size_t gc_threshold, long carrier_threads);
 #endif
 }
 